@@ -0,0 +1,155 @@
+/*
+ *	Batch Statistics
+ *
+ *	The Problem 2 report (open, close, mean, variance, min, max, median,
+ *	p95, p99 and the 5 highest prices) for many symbols at once
+ *
+ *	The symbols are sharded across the work-stealing pool: one task per
+ *	worker, each with its own scratch buffer for the order statistics, so
+ *	no allocation or sharing happens per symbol. The tasks take symbols
+ *	from a common counter a few at a time, which keeps the load balanced
+ *	when some symbols have many more ticks than others.
+ *
+ *	Each symbol's computation is timed, so the per-symbol latency
+ *	distribution (p50, p99, ...) can be reported next to the throughput.
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "Order_Statistics.h"
+#include "Running_Stats.h"
+#include "Thread_Pool.h"
+
+
+// One report per symbol, all 0 for an empty series
+struct symbol_stats {
+	std::size_t count = 0;
+	double open = 0, close = 0;
+	double mean = 0, variance = 0;
+	double min = 0, max = 0;
+	double median = 0, p95 = 0, p99 = 0;
+
+	// Highest prices first; fewer than 5 for short series
+	double peaks[5] = {};
+	std::size_t peak_count = 0;
+};
+
+
+// Wall time of a batch and the time spent on each symbol
+struct batch_timing {
+	double seconds = 0;
+	std::vector<double> latency_ns;	// in input order
+
+	// Nearest-rank percentile of the per-symbol latencies, q in [0, 1]
+	double latency_percentile(double q) const {
+		if (latency_ns.empty())
+			return 0;
+		std::vector<double> sorted(latency_ns);
+		const std::size_t rank = (std::size_t)std::ceil(std::min(1.0, std::max(0.0, q)) * double(sorted.size()));
+		const std::size_t index = rank > 0 ? rank - 1 : 0;
+		std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+		return sorted[index];
+	}
+
+	// Symbols per second
+	double throughput() const { return seconds > 0 ? double(latency_ns.size()) / seconds : 0; }
+};
+
+
+// The report of one series; 'scratch' is reused across calls
+// O(n) expected: one statistics pass, then selection on a copy of the prices
+inline symbol_stats compute_symbol_stats(const double * first, const double * last, std::vector<double> & scratch) {
+	symbol_stats report;
+	report.count = std::size_t(last - first);
+	if (report.count == 0)
+		return report;
+
+	running_stats<double> stats;
+	stats.push(first, last);
+	report.open = stats.open();
+	report.close = stats.close();
+	report.mean = stats.mean();
+	report.variance = stats.variance();
+	report.min = stats.min();
+	report.max = stats.max();
+
+	// Order statistics: both middle ranks, p95 and p99 in one multiselect on the copy
+	const std::size_t n = report.count;
+	scratch.assign(first, last);
+
+	// Nearest rank, as quantile_sketch: the first value with at least q * n values at or below it
+	auto nearest_rank = [n](double q) { return std::max<std::size_t>(1, (std::size_t)std::ceil(q * double(n))) - 1; };
+
+	const std::size_t ranks[4] = { (n - 1) / 2, n / 2, nearest_rank(0.95), nearest_rank(0.99) };	// ascending
+	multiselect(scratch.begin(), scratch.end(), ranks, ranks + 4);
+
+	report.median = (scratch[ranks[0]] + scratch[ranks[1]]) / 2;
+	report.p95 = scratch[ranks[2]];
+	report.p99 = scratch[ranks[3]];
+
+	report.peak_count = std::min<std::size_t>(5, n);
+	std::partial_sort_copy(first, last, report.peaks, report.peaks + report.peak_count, std::greater<double>());
+	return report;
+}
+
+
+// Reports for every series, in input order
+// Series is anything with price_begin() and price_end(): basic_price_series, price_series_view
+template <class Series>
+std::vector<symbol_stats> batch_stats(const std::vector<Series> & symbols,
+				      work_stealing_pool & pool = work_stealing_pool::shared(),
+				      batch_timing * timing = nullptr) {
+
+	typedef std::chrono::steady_clock clock;
+	const std::size_t batch = 8;	// symbols taken per visit of the counter
+
+	std::vector<symbol_stats> reports(symbols.size());
+	if (timing)
+		timing->latency_ns.assign(symbols.size(), 0);
+
+	std::atomic<std::size_t> next(0);
+
+	// One shard per worker, each with its own scratch buffer
+	auto shard = [&] {
+		std::vector<double> scratch;
+		for (;;) {
+			const std::size_t first = next.fetch_add(batch);
+			if (first >= symbols.size())
+				return;
+			const std::size_t last = std::min(symbols.size(), first + batch);
+
+			for (std::size_t i = first; i < last; ++i) {
+				const auto start = clock::now();
+				reports[i] = compute_symbol_stats(symbols[i].price_begin(), symbols[i].price_end(), scratch);
+				if (timing)
+					timing->latency_ns[i] = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+			}
+		}
+	};
+
+	const auto start = clock::now();
+
+	const std::size_t shards = std::min<std::size_t>(pool.size(), (symbols.size() + batch - 1) / batch);
+	if (shards <= 1)
+		shard();
+	else {
+		task_group group(pool);
+		for (std::size_t s = 0; s < shards; ++s)
+			group.run(shard);
+		group.wait();
+	}
+
+	if (timing)
+		timing->seconds = std::chrono::duration<double>(clock::now() - start).count();
+	return reports;
+}
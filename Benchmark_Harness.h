@@ -0,0 +1,261 @@
+/*
+ *	Benchmark Harness
+ *
+ *	Repeated timing of one benchmark case, summarized robustly: the median
+ *	time per element and its median absolute deviation (MAD), so one
+ *	preempted repetition does not move the result
+ *
+ *	On Linux, hardware counters (cycles, instructions, cache misses and
+ *	branch misses) are read around every repetition through perf_event_open.
+ *	They are reported as unavailable when the kernel refuses them, e.g.
+ *	inside containers or with a restrictive perf_event_paranoid setting.
+ *
+ *	Results are also appended to a CSV file, one row per case, so runs
+ *	can be compared by scripts for regression tracking.
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define BENCHMARK_PERF_EVENTS 1
+#else
+#define BENCHMARK_PERF_EVENTS 0
+#endif
+
+
+// Median of a sample, the mean of the two middle values for an even count
+inline double sample_median(std::vector<double> values) {
+	if (values.empty())
+		return 0;
+	const std::size_t middle = values.size() / 2;
+	std::nth_element(values.begin(), values.begin() + middle, values.end());
+	if (values.size() % 2 != 0)
+		return values[middle];
+	return (values[middle] + *std::max_element(values.begin(), values.begin() + middle)) / 2;
+}
+
+// Median absolute deviation from the median
+inline double sample_mad(const std::vector<double> & values) {
+	const double median = sample_median(values);
+	std::vector<double> deviations(values.size());
+	for (std::size_t i = 0; i < values.size(); ++i)
+		deviations[i] = std::abs(values[i] - median);
+	return sample_median(deviations);
+}
+
+
+// Hardware counters of the calling thread, user space only
+class hardware_counters {
+public:
+
+	enum event { cycles, instructions, cache_misses, branch_misses, event_count };
+
+	hardware_counters() {
+		for (int e = 0; e < event_count; ++e)
+			fds[e] = -1;
+#if BENCHMARK_PERF_EVENTS
+		const std::uint64_t configs[event_count] = {
+			PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+			PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+
+		for (int e = 0; e < event_count; ++e) {
+			perf_event_attr attr = perf_event_attr();
+			attr.size = sizeof(attr);
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = configs[e];
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			fds[e] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+		}
+#endif
+	}
+
+	~hardware_counters() {
+#if BENCHMARK_PERF_EVENTS
+		for (int e = 0; e < event_count; ++e)
+			if (fds[e] >= 0)
+				close(fds[e]);
+#endif
+	}
+
+	hardware_counters(const hardware_counters &) = delete;
+	hardware_counters & operator=(const hardware_counters &) = delete;
+
+	// False when no counter could be opened
+	bool available() const {
+		for (int e = 0; e < event_count; ++e)
+			if (fds[e] >= 0)
+				return true;
+		return false;
+	}
+
+	bool available(event e) const { return fds[e] >= 0; }
+
+	void start() {
+#if BENCHMARK_PERF_EVENTS
+		for (int e = 0; e < event_count; ++e)
+			if (fds[e] >= 0) {
+				ioctl(fds[e], PERF_EVENT_IOC_RESET, 0);
+				ioctl(fds[e], PERF_EVENT_IOC_ENABLE, 0);
+			}
+#endif
+	}
+
+	void stop() {
+#if BENCHMARK_PERF_EVENTS
+		for (int e = 0; e < event_count; ++e)
+			if (fds[e] >= 0)
+				ioctl(fds[e], PERF_EVENT_IOC_DISABLE, 0);
+#endif
+	}
+
+	// Count since the last start(), 0 if the counter is unavailable
+	std::uint64_t value(event e) const {
+		std::uint64_t count = 0;
+#if BENCHMARK_PERF_EVENTS
+		if (fds[e] >= 0 && read(fds[e], &count, sizeof(count)) != (ssize_t)sizeof(count))
+			count = 0;
+#endif
+		return count;
+	}
+
+	static const char * name(event e) {
+		static const char * names[event_count] = { "cycles", "instructions", "cache_misses", "branch_misses" };
+		return names[e];
+	}
+
+private:
+	int fds[event_count];
+};
+
+
+// Summary of the repetitions of one case
+struct benchmark_result {
+	std::size_t size = 0;		// elements per iteration
+	std::size_t repetitions = 0;
+	std::size_t iterations = 0;	// per repetition
+	double median_ns = 0;		// per element
+	double mad_ns = 0;
+
+	// Per element, median over the repetitions; negative when unavailable
+	double counters[hardware_counters::event_count] = { -1, -1, -1, -1 };
+};
+
+
+// The sizes 1000, 100000 and max_size, increasing, none above max_size
+inline std::vector<std::size_t> benchmark_sizes(std::size_t max_size) {
+	std::vector<std::size_t> sizes;
+	for (std::size_t size : { std::size_t(1000), std::size_t(100000) })
+		if (size < max_size)
+			sizes.push_back(size);
+	sizes.push_back(max_size);
+	return sizes;
+}
+
+// Time one call of 'run' in nanoseconds per element: one sample, no warm-up,
+// for cases timed once per size; measure() repeats a case and summarizes it
+template <class Function>
+double ns_per_element(std::size_t size, Function run) {
+	auto start = std::chrono::steady_clock::now();
+	run();
+	auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(stop - start).count() / (double)size;
+}
+
+
+// Run 'run' 'repetitions' times, each time 'iterations' times back to back
+// so very short cases are still timed above the clock resolution
+// The iterations are sized to about 'target_elements' per repetition
+template <class Function>
+benchmark_result measure(std::size_t size, std::size_t repetitions, Function run,
+			 hardware_counters * counters = nullptr, std::size_t target_elements = 100000) {
+
+	benchmark_result result;
+	result.size = size;
+	result.repetitions = std::max<std::size_t>(1, repetitions);
+	result.iterations = std::max<std::size_t>(1, target_elements / std::max<std::size_t>(1, size));
+
+	const double elements = double(result.iterations) * double(std::max<std::size_t>(1, size));
+
+	// One untimed warm-up: page faults, first-touch allocation, lazy initialization
+	// Skipped for large inputs, where it would double the run time
+	if (size <= target_elements)
+		run();
+
+	std::vector<double> times;
+	std::vector<double> counts[hardware_counters::event_count];
+
+	for (std::size_t r = 0; r < result.repetitions; ++r) {
+		if (counters)
+			counters->start();
+		const auto start = std::chrono::steady_clock::now();
+
+		for (std::size_t i = 0; i < result.iterations; ++i)
+			run();
+
+		const auto stop = std::chrono::steady_clock::now();
+		if (counters)
+			counters->stop();
+
+		times.push_back(std::chrono::duration<double, std::nano>(stop - start).count() / elements);
+		for (int e = 0; counters && e < hardware_counters::event_count; ++e)
+			if (counters->available(hardware_counters::event(e)))
+				counts[e].push_back(double(counters->value(hardware_counters::event(e))) / elements);
+	}
+
+	result.median_ns = sample_median(times);
+	result.mad_ns = sample_mad(times);
+	for (int e = 0; e < hardware_counters::event_count; ++e)
+		if (!counts[e].empty())
+			result.counters[e] = sample_median(counts[e]);
+	return result;
+}
+
+
+// One CSV row per case, for regression tracking:
+// problem,variant,distribution,size,repetitions,iterations,ns_per_element,mad_ns,cycles,instructions,cache_misses,branch_misses
+// The counter columns are per element and empty when unavailable
+class benchmark_report {
+public:
+
+	explicit benchmark_report(const std::string & path) : out(path) {
+		out << "problem,variant,distribution,size,repetitions,iterations,ns_per_element,mad_ns";
+		for (int e = 0; e < hardware_counters::event_count; ++e)
+			out << "," << hardware_counters::name(hardware_counters::event(e));
+		out << "\n";
+	}
+
+	bool is_open() const { return out.is_open(); }
+
+	void add(const std::string & problem, const std::string & variant, const std::string & distribution, const benchmark_result & result) {
+		out << problem << "," << variant << "," << distribution << "," << result.size << ","
+		    << result.repetitions << "," << result.iterations << "," << result.median_ns << "," << result.mad_ns;
+		for (int e = 0; e < hardware_counters::event_count; ++e) {
+			out << ",";
+			if (result.counters[e] >= 0)
+				out << result.counters[e];
+		}
+		out << "\n";
+		out.flush();
+	}
+
+private:
+	std::ofstream out;
+};
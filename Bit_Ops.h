@@ -0,0 +1,68 @@
+/*
+ *	Bit Operations
+ *
+ *	popcount and the index of the lowest and of the highest set bit of a
+ *	64-bit word, as one instruction where the compiler exposes it (GCC and
+ *	Clang builtins, MSVC intrinsics on x64), with portable loops otherwise
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <cstdint>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+
+namespace bit_ops {
+
+	// Number of 1 bits
+	inline unsigned popcount(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+		return unsigned(__builtin_popcountll(word));
+#elif defined(_MSC_VER) && defined(_M_X64)
+		return unsigned(__popcnt64(word));
+#else
+		word = word - ((word >> 1) & 0x5555555555555555ULL);
+		word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+		word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+		return unsigned((word * 0x0101010101010101ULL) >> 56);
+#endif
+	}
+
+	// Index of the lowest 1 bit (the number of trailing zeros); word != 0
+	inline unsigned lowest_bit(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+		return unsigned(__builtin_ctzll(word));
+#elif defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanForward64(&index, word);
+		return unsigned(index);
+#else
+		unsigned index = 0;
+		for (; !(word & 1); word >>= 1)
+			++index;
+		return index;
+#endif
+	}
+
+	// Index of the highest 1 bit (floor of log2); word != 0
+	inline unsigned highest_bit(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+		return 63 - unsigned(__builtin_clzll(word));
+#elif defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanReverse64(&index, word);
+		return unsigned(index);
+#else
+		unsigned index = 0;
+		while (word >>= 1)
+			++index;
+		return index;
+#endif
+	}
+
+}
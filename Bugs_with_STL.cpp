@@ -15,10 +15,12 @@
 #include <set>
 #include <unordered_map>
 #include <vector>
-#include <list>
 #include <algorithm>
 #include <numeric>
 
+#include "Simd_Compact.h"
+#include "Unrolled_List.h"
+
 // Policies (callable objects / functors)
 
 // Returns true if a numeric element is negative
@@ -53,7 +55,8 @@ int main() {
 
 	/** Dereferencing illegal iterators ***/
 
-	std::list<double> myList2 = { -1.1, 2.231, -3.23, 4.01, -9.1, -89.1, 12, 8.28 };
+	// std::list semantics with the elements in contiguous blocks (Unrolled_List.h)
+	unrolled_list<double> myList2 = { -1.1, 2.231, -3.23, 4.01, -9.1, -89.1, 12, 8.28 };
 
 	std::vector<double> negatives;
 
@@ -63,6 +66,18 @@ int main() {
 	// Correct version:
 	std::copy_if(myList2.begin(), myList2.end(), std::back_inserter(negatives), is_negative<double>());
 
+	// Also correct, and without reallocations: count the matches, size the output once, then fill it
+	// (simd_copy_if needs contiguous input, so the values are in a vector here)
+	std::vector<double> myVector2(myList2.begin(), myList2.end());
+	std::vector<double> negatives2;
+	simd_copy_if(myVector2.data(), myVector2.data() + myVector2.size(), negatives2, less_than(0.0));
+
+	// Both versions keep the negative values in input order
+	std::cout << "Negative values: ";
+	for (double value : negatives2)
+		std::cout << value << " ";
+	std::cout << (negatives2 == negatives ? "(same as std::copy_if)\n" : "(differs from std::copy_if)\n");
+
 
 
 	/** Poor container choices and const correctness ***/
@@ -0,0 +1,61 @@
+/*
+ *	Cache-Aligned Allocator
+ *
+ *	A std::allocator replacement whose blocks are placed so that element
+ *	'Offset' starts a 64-byte cache line. Implicit trees use it to line up
+ *	groups of nodes with cache lines: the Eytzinger index aligns element 0
+ *	(its levels are 1-based), and the d-ary heap aligns element 1, the
+ *	first child of the root.
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+
+namespace cache_aligned_detail {
+
+	const std::size_t cache_line = 64;
+
+}
+
+
+template <class T, std::size_t Offset = 0>
+struct cache_aligned_allocator {
+	typedef T value_type;
+
+	template <class U>
+	struct rebind { typedef cache_aligned_allocator<U, Offset> other; };
+
+	cache_aligned_allocator() {}
+	template <class U>
+	cache_aligned_allocator(const cache_aligned_allocator<U, Offset> &) {}
+
+	// The address returned by operator new is kept just before the block
+	T * allocate(std::size_t n) {
+		using cache_aligned_detail::cache_line;
+		const std::size_t offset = Offset * sizeof(T);
+		char * raw = static_cast<char *>(::operator new(n * sizeof(T) + cache_line + offset + sizeof(void *)));
+		const std::uintptr_t line = (reinterpret_cast<std::uintptr_t>(raw) + sizeof(void *) + offset + cache_line - 1)
+			& ~std::uintptr_t(cache_line - 1);
+		char * block = reinterpret_cast<char *>(line - offset);
+		std::memcpy(block - sizeof(void *), &raw, sizeof(void *));
+		return reinterpret_cast<T *>(block);
+	}
+
+	void deallocate(T * p, std::size_t) {
+		void * raw;
+		std::memcpy(&raw, reinterpret_cast<char *>(p) - sizeof(void *), sizeof(void *));
+		::operator delete(raw);
+	}
+};
+
+template <class T, class U, std::size_t Offset>
+bool operator==(const cache_aligned_allocator<T, Offset> &, const cache_aligned_allocator<U, Offset> &) { return true; }
+template <class T, class U, std::size_t Offset>
+bool operator!=(const cache_aligned_allocator<T, Offset> &, const cache_aligned_allocator<U, Offset> &) { return false; }
@@ -0,0 +1,649 @@
+/*
+ *	Elementary STL Algorithms benchmark
+ *
+ *	1. std::transform with the exponentiate functor (one std::exp call per
+ *	   element) against the vectorized transform_exp, per instruction set,
+ *	   for double and float, with the largest difference to std::exp
+ *	2. The std:: algorithms against their parallel:: versions on the thread
+ *	   pool; checks that both agree and that the parallel sums are the same
+ *	   with one worker and with every hardware thread
+ *	3. copy_if of the values below a threshold (1%, 50% and 99% selected):
+ *	   std::copy_if through a back_inserter against the SIMD compaction per
+ *	   instruction set (count, one allocation, compact), sized by an upper
+ *	   bound instead, and on the thread pool
+ *	4. Sum of the squares of the values below a threshold: copy_if, transform
+ *	   and accumulate through two temporary vectors, against the fused
+ *	   pipeline (one pass, no allocation), a hand-written loop, and the
+ *	   pipeline on the thread pool
+ *	5. std::list against unrolled_list and std::vector: walking (accumulate),
+ *	   find_if and copy_if on a list built by push_back, inserting each
+ *	   element before a random earlier one, and walking the result of that
+ *	6. Threshold queries on a sorted table (the first value greater than a
+ *	   random target): std::upper_bound against the Eytzinger index, one
+ *	   query at a time and batched
+ *
+ *	Usage: Elementary_Benchmark [max_size]
+ *
+ */
+
+// Include Standard Library headers
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <vector>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <list>
+
+#include "Benchmark_Harness.h"
+#include "Parallel_Algorithms.h"
+#include "Parallel_Compact.h"
+#include "Pipeline.h"
+#include "Eytzinger_Index.h"
+#include "Random_Fill.h"
+#include "Simd_Compact.h"
+#include "Simd_Exp.h"
+#include "Unrolled_List.h"
+
+
+// Distance between two finite values of the same sign in units in the last place
+template <class Real>
+double ulp_distance(Real a, Real b) {
+	if (a == b)
+		return 0;
+	const Real ulp = std::nextafter(std::abs(b), std::numeric_limits<Real>::infinity()) - std::abs(b);
+	return double(std::abs(a - b) / ulp);
+}
+
+
+// One row per size: std::transform and transform_exp for every instruction set
+template <class Real>
+void benchmark_exp(const char * type, std::size_t max_size, std::uint64_t seed) {
+
+	const simd_level levels[] = { simd_level::scalar, simd_level::sse2, simd_level::avx2, simd_level::avx512 };
+
+	std::cout << "\nexp over " << type << " [ns/element]\n"
+		  << std::setw(12) << "size" << std::setw(16) << "std::transform";
+	for (simd_level level : levels)
+		std::cout << std::setw(12) << simd_level_name(level);
+	std::cout << std::setw(14) << "max ulp diff" << "\n";
+
+	for (std::size_t size : benchmark_sizes(max_size)) {
+
+		// Feature-like values, well inside the range of finite results
+		std::vector<Real> input(size);
+		random_fill(input, Real(-20), Real(20), seed);
+		std::vector<Real> expected(size), output(size);
+
+		const std::size_t repeats = std::max<std::size_t>(1, 10000000 / size);
+
+		double reference = ns_per_element(size * repeats, [&] {
+			for (std::size_t r = 0; r < repeats; ++r)
+				std::transform(input.begin(), input.end(), expected.begin(), [](const Real & value) { return std::exp(value); });
+		});
+
+		std::cout << std::fixed << std::setprecision(3)
+			  << std::setw(12) << size << std::setw(16) << reference;
+
+		double max_ulp = 0;
+		for (simd_level level : levels) {
+			if (level > simd_reductions::best_level()) {
+				std::cout << std::setw(12) << "-";
+				continue;
+			}
+			const simd_exp_kernels kernels = simd_exp_kernels::for_level(level);
+			auto kernel = [&](const Real * in, Real * out, std::size_t n) {
+				if (sizeof(Real) == sizeof(double))
+					kernels.exp_double((const double *)in, (double *)out, n);
+				else
+					kernels.exp_float((const float *)in, (float *)out, n);
+			};
+
+			double time = ns_per_element(size * repeats, [&] {
+				for (std::size_t r = 0; r < repeats; ++r)
+					kernel(input.data(), output.data(), size);
+			});
+
+			for (std::size_t i = 0; i < size; ++i)
+				max_ulp = std::max(max_ulp, ulp_distance(output[i], expected[i]));
+			std::cout << std::setw(12) << time;
+		}
+		std::cout << std::setw(14) << std::setprecision(2) << max_ulp << "\n";
+	}
+}
+
+
+// One row per algorithm and size: sequential, parallel and the speedup
+// Returns false when a parallel result differs from the sequential one
+bool benchmark_parallel(std::size_t max_size, std::uint64_t seed) {
+
+	work_stealing_pool single(1);
+	bool agree = true;
+
+	std::cout << "\nparallel:: with " << work_stealing_pool::shared().size() << " workers [ns/element]\n"
+		  << std::setw(18) << "algorithm" << std::setw(12) << "size"
+		  << std::setw(12) << "std::" << std::setw(12) << "parallel::" << std::setw(10) << "speedup" << "\n";
+
+	for (std::size_t size : benchmark_sizes(max_size)) {
+
+		std::vector<double> input(size);
+		random_fill(input, -10.0, 10.0, seed);
+		std::vector<double> expected(size), output(size);
+
+		const std::size_t repeats = std::max<std::size_t>(1, 10000000 / size);
+
+		auto row = [&](const char * name, double sequential, double parallel_time, bool same) {
+			std::cout << std::fixed << std::setprecision(3)
+				  << std::setw(18) << name << std::setw(12) << size
+				  << std::setw(12) << sequential << std::setw(12) << parallel_time
+				  << std::setw(10) << std::setprecision(2) << sequential / parallel_time << "\n";
+			if (!same) {
+				std::cerr << name << ": parallel result differs at size " << size << "\n";
+				agree = false;
+			}
+		};
+
+		auto scale = [](double & value) { value = value * 1.0001 + 1.0; };
+		double sequential = ns_per_element(size * repeats, [&] {
+			for (std::size_t r = 0; r < repeats; ++r)
+				std::for_each(expected.begin(), expected.end(), scale);
+		});
+		double parallel_time = ns_per_element(size * repeats, [&] {
+			for (std::size_t r = 0; r < repeats; ++r)
+				parallel::for_each(parallel::par, output.begin(), output.end(), scale);
+		});
+		row("for_each", sequential, parallel_time, expected == output);
+
+		auto exponentiate = [](double value) { return std::exp(value); };
+		sequential = ns_per_element(size * repeats, [&] {
+			for (std::size_t r = 0; r < repeats; ++r)
+				std::transform(input.begin(), input.end(), expected.begin(), exponentiate);
+		});
+		parallel_time = ns_per_element(size * repeats, [&] {
+			for (std::size_t r = 0; r < repeats; ++r)
+				parallel::transform(parallel::par, input.begin(), input.end(), output.begin(), exponentiate);
+		});
+		row("transform (exp)", sequential, parallel_time, expected == output);
+
+		// Only the last element matches: a full scan either way
+		const double target = 100.0;
+		input.back() = 2 * target;
+		std::vector<double>::iterator found_sequential, found_parallel;
+		auto is_greater = [target](double value) { return value > target; };
+		sequential = ns_per_element(size * repeats, [&] {
+			for (std::size_t r = 0; r < repeats; ++r)
+				found_sequential = std::find_if(input.begin(), input.end(), is_greater);
+		});
+		parallel_time = ns_per_element(size * repeats, [&] {
+			for (std::size_t r = 0; r < repeats; ++r)
+				found_parallel = parallel::find_if(parallel::par, input.begin(), input.end(), is_greater);
+		});
+		row("find_if", sequential, parallel_time, found_sequential == found_parallel);
+		input.back() = 0;
+
+		auto is_negative = [](double value) { return value < 0; };
+		std::vector<double>::iterator end_sequential = expected.begin(), end_parallel = output.begin();
+		sequential = ns_per_element(size * repeats, [&] {
+			for (std::size_t r = 0; r < repeats; ++r)
+				end_sequential = std::copy_if(input.begin(), input.end(), expected.begin(), is_negative);
+		});
+		parallel_time = ns_per_element(size * repeats, [&] {
+			for (std::size_t r = 0; r < repeats; ++r)
+				end_parallel = parallel::copy_if(parallel::par, input.begin(), input.end(), output.begin(), is_negative);
+		});
+		row("copy_if", sequential, parallel_time,
+		    end_sequential - expected.begin() == end_parallel - output.begin() &&
+		    std::equal(expected.begin(), end_sequential, output.begin()));
+
+		// Floating-point sums: the parallel one groups differently, so compare to a tolerance,
+		// and bit for bit against the same call on a pool of one worker
+		// (volatile: otherwise GCC spills the running total, as the sum lives across the clock call)
+		double sum_sequential = 0, sum_parallel = 0;
+		sequential = ns_per_element(size * repeats, [&] {
+			volatile double sum = 0;
+			for (std::size_t r = 0; r < repeats; ++r)
+				sum = std::accumulate(input.begin(), input.end(), 0.0);
+			sum_sequential = sum;
+		});
+		parallel_time = ns_per_element(size * repeats, [&] {
+			volatile double sum = 0;
+			for (std::size_t r = 0; r < repeats; ++r)
+				sum = parallel::accumulate(parallel::par, input.begin(), input.end(), 0.0);
+			sum_parallel = sum;
+		});
+		row("accumulate", sequential, parallel_time,
+		    std::abs(sum_sequential - sum_parallel) <= 1e-9 * size &&
+		    sum_parallel == parallel::accumulate(parallel::par.on(single), input.begin(), input.end(), 0.0));
+
+		auto square = [](double value) { return value * value; };
+		sequential = ns_per_element(size * repeats, [&] {
+			volatile double sum = 0;
+			for (std::size_t r = 0; r < repeats; ++r)
+				sum = parallel::transform_reduce(parallel::seq, input.begin(), input.end(), 0.0, std::plus<double>(), square);
+			sum_sequential = sum;
+		});
+		parallel_time = ns_per_element(size * repeats, [&] {
+			volatile double sum = 0;
+			for (std::size_t r = 0; r < repeats; ++r)
+				sum = parallel::transform_reduce(parallel::par, input.begin(), input.end(), 0.0, std::plus<double>(), square);
+			sum_parallel = sum;
+		});
+		row("transform_reduce", sequential, parallel_time,
+		    std::abs(sum_sequential - sum_parallel) <= 1e-9 * sum_sequential &&
+		    sum_parallel == parallel::transform_reduce(parallel::par.on(single), input.begin(), input.end(), 0.0, std::plus<double>(), square));
+	}
+	return agree;
+}
+
+
+// One row per size and selectivity; every column builds a new vector of the selected values
+// Returns false when a result differs from std::copy_if
+bool benchmark_compaction(std::size_t max_size, std::uint64_t seed) {
+
+	const simd_level levels[] = { simd_level::scalar, simd_level::avx2, simd_level::avx512 };
+	bool agree = true;
+
+	std::cout << "\ncopy_if of the values below a threshold [ns/element]\n"
+		  << std::setw(12) << "size" << std::setw(10) << "selected" << std::setw(16) << "back_inserter";
+	for (simd_level level : levels)
+		std::cout << std::setw(12) << simd_level_name(level);
+	std::cout << std::setw(14) << "upper bound" << std::setw(12) << "parallel" << "\n";
+
+	for (std::size_t size : benchmark_sizes(max_size)) {
+
+		std::vector<double> input(size);
+		random_fill(input, -10.0, 10.0, seed);
+		const double * first = input.data(), * last = input.data() + size;
+
+		const std::size_t repeats = std::max<std::size_t>(1, 10000000 / size);
+
+		for (double threshold : { -9.8, 0.0, 9.8 }) {
+
+			const threshold_predicate<double> pred = less_than(threshold);
+			std::vector<double> expected, output;
+
+			double time = ns_per_element(size * repeats, [&] {
+				for (std::size_t r = 0; r < repeats; ++r) {
+					expected = std::vector<double>();
+					std::copy_if(first, last, std::back_inserter(expected), pred);
+				}
+			});
+			std::cout << std::fixed << std::setprecision(3)
+				  << std::setw(12) << size << std::setw(9) << std::setprecision(0) << 100.0 * (double)expected.size() / (double)size << "%"
+				  << std::setprecision(3) << std::setw(16) << time;
+
+			auto compare = [&](const char * name) {
+				if (output != expected) {
+					std::cerr << name << ": compaction differs at size " << size << ", threshold " << threshold << "\n";
+					agree = false;
+				}
+			};
+
+			for (simd_level level : levels) {
+				if (level > simd_reductions::best_level()) {
+					std::cout << std::setw(12) << "-";
+					continue;
+				}
+				const simd_compact_kernels kernels = simd_compact_kernels::for_level(level);
+				time = ns_per_element(size * repeats, [&] {
+					for (std::size_t r = 0; r < repeats; ++r) {
+						output = std::vector<double>(kernels.count_double(first, size, pred));
+						kernels.compact_double(first, size, output.data(), output.size(), pred);
+					}
+				});
+				std::cout << std::setw(12) << time;
+				compare(simd_level_name(level));
+			}
+
+			time = ns_per_element(size * repeats, [&] {
+				for (std::size_t r = 0; r < repeats; ++r) {
+					output = std::vector<double>();
+					simd_copy_if(first, last, output, pred, output_sizing::upper_bound);
+				}
+			});
+			std::cout << std::setw(14) << time;
+			compare("upper bound");
+
+			time = ns_per_element(size * repeats, [&] {
+				for (std::size_t r = 0; r < repeats; ++r) {
+					output = std::vector<double>();
+					simd_copy_if(parallel::par, first, last, output, pred);
+				}
+			});
+			std::cout << std::setw(12) << time << "\n";
+			compare("parallel");
+		}
+	}
+	return agree;
+}
+
+
+// filter | transform | reduce: three passes with temporaries, fused, by hand, fused in parallel
+// Returns false when the results differ
+bool benchmark_pipeline(std::size_t max_size, std::uint64_t seed) {
+
+	work_stealing_pool single(1);
+	bool agree = true;
+
+	std::cout << "\nsum of x*x over x < threshold [ns/element]\n"
+		  << std::setw(12) << "size" << std::setw(10) << "selected" << std::setw(14) << "temporaries"
+		  << std::setw(12) << "pipeline" << std::setw(12) << "by hand" << std::setw(12) << "parallel" << "\n";
+
+	for (std::size_t size : benchmark_sizes(max_size)) {
+
+		std::vector<double> input(size);
+		random_fill(input, -10.0, 10.0, seed);
+
+		const std::size_t repeats = std::max<std::size_t>(1, 10000000 / size);
+		auto square = [](double value) { return value * value; };
+
+		for (double threshold : { -9.8, 0.0, 9.8 }) {
+
+			const threshold_predicate<double> pred = less_than(threshold);
+
+			// volatile: otherwise GCC spills the running total, as the sum lives across the clock call
+			double expected = 0, result = 0;
+			std::size_t selected = 0;
+			double time = ns_per_element(size * repeats, [&] {
+				volatile double sum = 0;
+				for (std::size_t r = 0; r < repeats; ++r) {
+					std::vector<double> kept, squares;
+					std::copy_if(input.begin(), input.end(), std::back_inserter(kept), pred);
+					squares.resize(kept.size());
+					std::transform(kept.begin(), kept.end(), squares.begin(), square);
+					sum = std::accumulate(squares.begin(), squares.end(), 0.0);
+					selected = kept.size();
+				}
+				expected = sum;
+			});
+			std::cout << std::fixed << std::setprecision(3)
+				  << std::setw(12) << size << std::setw(9) << std::setprecision(0) << 100.0 * (double)selected / (double)size << "%"
+				  << std::setprecision(3) << std::setw(14) << time;
+
+			auto compare = [&](const char * name, bool same) {
+				if (!same) {
+					std::cerr << name << ": sum differs at size " << size << ", threshold " << threshold << "\n";
+					agree = false;
+				}
+			};
+
+			time = ns_per_element(size * repeats, [&] {
+				volatile double sum = 0;
+				for (std::size_t r = 0; r < repeats; ++r)
+					sum = pipeline::from(input) | pipeline::filter(pred) | pipeline::transform(square) | pipeline::reduce(0.0);
+				result = sum;
+			});
+			std::cout << std::setw(12) << time;
+			compare("pipeline", result == expected);
+
+			time = ns_per_element(size * repeats, [&] {
+				volatile double sum = 0;
+				for (std::size_t r = 0; r < repeats; ++r) {
+					double total = 0;
+					for (double value : input)
+						if (value < threshold)
+							total += value * value;
+					sum = total;
+				}
+				result = sum;
+			});
+			std::cout << std::setw(12) << time;
+			compare("by hand", result == expected);
+
+			// Grouped by chunks: a tolerance against the sequential sum, bit for bit against one worker
+			time = ns_per_element(size * repeats, [&] {
+				volatile double sum = 0;
+				for (std::size_t r = 0; r < repeats; ++r)
+					sum = pipeline::from(input) | pipeline::filter(pred) | pipeline::transform(square)
+					    | pipeline::reduce(0.0, std::plus<double>(), parallel::par);
+				result = sum;
+			});
+			std::cout << std::setw(12) << time << "\n";
+			compare("parallel", std::abs(result - expected) <= 1e-9 * expected &&
+				result == (pipeline::from(input) | pipeline::filter(pred) | pipeline::transform(square)
+					   | pipeline::reduce(0.0, std::plus<double>(), parallel::par.on(single))));
+		}
+	}
+	return agree;
+}
+
+
+// One row per workload and size: std::list, unrolled_list, std::vector
+// Returns false when the containers disagree
+bool benchmark_lists(std::size_t max_size, std::uint64_t seed) {
+
+	bool agree = true;
+
+	std::cout << "\nstd::list against unrolled_list [ns/element]\n"
+		  << std::setw(18) << "workload" << std::setw(12) << "size"
+		  << std::setw(12) << "std::list" << std::setw(12) << "unrolled" << std::setw(12) << "std::vector" << "\n";
+
+	for (std::size_t size : benchmark_sizes(max_size)) {
+
+		std::vector<double> input(size);
+		random_fill(input, -10.0, 10.0, seed);
+
+		const std::list<double> list(input.begin(), input.end());
+		const unrolled_list<double> unrolled(input.begin(), input.end());
+		const std::vector<double> & vector = input;
+
+		const std::size_t repeats = std::max<std::size_t>(1, 10000000 / size);
+
+		auto row = [&](const char * name, double list_time, double unrolled_time, double vector_time, bool same) {
+			std::cout << std::fixed << std::setprecision(3)
+				  << std::setw(18) << name << std::setw(12) << size
+				  << std::setw(12) << list_time << std::setw(12) << unrolled_time;
+			if (vector_time < 0)
+				std::cout << std::setw(12) << "-" << "\n";
+			else
+				std::cout << std::setw(12) << vector_time << "\n";
+			if (!same) {
+				std::cerr << name << ": the containers differ at size " << size << "\n";
+				agree = false;
+			}
+		};
+
+		// Same order, same sums: compared bit for bit
+		// (volatile: otherwise GCC spills the running total, as the sum lives across the clock call)
+		auto walk = [&](const char * name, const std::list<double> & list, const unrolled_list<double> & unrolled,
+				const std::vector<double> & vector) {
+			double sums[3];
+			double list_time = ns_per_element(size * repeats, [&] {
+				volatile double sum = 0;
+				for (std::size_t r = 0; r < repeats; ++r)
+					sum = std::accumulate(list.begin(), list.end(), 0.0);
+				sums[0] = sum;
+			});
+			double unrolled_time = ns_per_element(size * repeats, [&] {
+				volatile double sum = 0;
+				for (std::size_t r = 0; r < repeats; ++r)
+					sum = std::accumulate(unrolled.begin(), unrolled.end(), 0.0);
+				sums[1] = sum;
+			});
+			double vector_time = ns_per_element(size * repeats, [&] {
+				volatile double sum = 0;
+				for (std::size_t r = 0; r < repeats; ++r)
+					sum = std::accumulate(vector.begin(), vector.end(), 0.0);
+				sums[2] = sum;
+			});
+			row(name, list_time, unrolled_time, vector_time, sums[0] == sums[1] && sums[1] == sums[2]);
+		};
+
+		walk("walk", list, unrolled, vector);
+
+		// No element matches: a full scan
+		const double target = 100.0;
+		auto is_greater = [target](double value) { return value > target; };
+		bool found[3] = {};
+		double list_time = ns_per_element(size * repeats, [&] {
+			for (std::size_t r = 0; r < repeats; ++r)
+				found[0] = std::find_if(list.begin(), list.end(), is_greater) != list.end();
+		});
+		double unrolled_time = ns_per_element(size * repeats, [&] {
+			for (std::size_t r = 0; r < repeats; ++r)
+				found[1] = std::find_if(unrolled.begin(), unrolled.end(), is_greater) != unrolled.end();
+		});
+		double vector_time = ns_per_element(size * repeats, [&] {
+			for (std::size_t r = 0; r < repeats; ++r)
+				found[2] = std::find_if(vector.begin(), vector.end(), is_greater) != vector.end();
+		});
+		row("find_if", list_time, unrolled_time, vector_time, found[0] == found[1] && found[1] == found[2]);
+
+		auto is_negative = [](double value) { return value < 0; };
+		std::vector<double> negatives[3];
+		list_time = ns_per_element(size * repeats, [&] {
+			for (std::size_t r = 0; r < repeats; ++r) {
+				negatives[0].clear();
+				std::copy_if(list.begin(), list.end(), std::back_inserter(negatives[0]), is_negative);
+			}
+		});
+		unrolled_time = ns_per_element(size * repeats, [&] {
+			for (std::size_t r = 0; r < repeats; ++r) {
+				negatives[1].clear();
+				std::copy_if(unrolled.begin(), unrolled.end(), std::back_inserter(negatives[1]), is_negative);
+			}
+		});
+		vector_time = ns_per_element(size * repeats, [&] {
+			for (std::size_t r = 0; r < repeats; ++r) {
+				negatives[2].clear();
+				std::copy_if(vector.begin(), vector.end(), std::back_inserter(negatives[2]), is_negative);
+			}
+		});
+		row("copy_if", list_time, unrolled_time, vector_time, negatives[0] == negatives[1] && negatives[1] == negatives[2]);
+
+		// Each element before a random earlier one: O(1) per insert for the lists
+		// The vector inserts at a random index instead, O(n) per insert; left out above 100000 elements
+		std::vector<std::size_t> before(size);
+		std::uint64_t state = seed;
+		for (std::size_t i = 1; i < size; ++i)
+			before[i] = std::size_t(splitmix64(state) % i);
+
+		std::list<double> list_inserted;
+		unrolled_list<double> unrolled_inserted;
+		std::vector<double> vector_inserted;
+		vector_inserted.reserve(size);
+		list_time = ns_per_element(size, [&] {
+			std::vector<std::list<double>::iterator> at(size);
+			for (std::size_t i = 0; i < size; ++i)
+				at[i] = i ? list_inserted.insert(at[before[i]], input[i]) : list_inserted.insert(list_inserted.end(), input[i]);
+		});
+		unrolled_time = ns_per_element(size, [&] {
+			std::vector<unrolled_list<double>::iterator> at(size);
+			for (std::size_t i = 0; i < size; ++i)
+				at[i] = i ? unrolled_inserted.insert(at[before[i]], input[i]) : unrolled_inserted.insert(unrolled_inserted.end(), input[i]);
+		});
+		vector_time = -1;
+		if (size <= 100000)
+			vector_time = ns_per_element(size, [&] {
+				for (std::size_t i = 0; i < size; ++i)
+					vector_inserted.insert(vector_inserted.begin() + std::ptrdiff_t(before[i]), input[i]);
+			});
+		row("insert", list_time, unrolled_time, vector_time,
+		    std::equal(list_inserted.begin(), list_inserted.end(), unrolled_inserted.begin()));
+
+		vector_inserted.assign(list_inserted.begin(), list_inserted.end());
+		walk("walk after insert", list_inserted, unrolled_inserted, vector_inserted);
+	}
+	return agree;
+}
+
+
+// One row per table size: the same random queries through every method
+// Returns false when a rank differs from std::upper_bound
+bool benchmark_search(std::size_t max_size, std::uint64_t seed) {
+
+	bool agree = true;
+
+	std::cout << "\nupper_bound on a sorted table [ns/query]\n"
+		  << std::setw(12) << "size" << std::setw(18) << "std::upper_bound"
+		  << std::setw(12) << "eytzinger" << std::setw(12) << "batched" << "\n";
+
+	const std::size_t queries = 1000000;
+
+	for (std::size_t size : benchmark_sizes(max_size)) {
+
+		std::vector<double> table(size);
+		random_fill(table, -10.0, 10.0, seed);
+		std::sort(table.begin(), table.end());
+		const eytzinger_index<double> index(table);
+
+		std::vector<double> targets(queries);
+		random_fill(targets, -11.0, 11.0, seed + 1);
+
+		std::vector<std::size_t> ranks[3];
+		for (std::vector<std::size_t> & r : ranks)
+			r.resize(queries);
+
+		double std_time = ns_per_element(queries, [&] {
+			for (std::size_t i = 0; i < queries; ++i)
+				ranks[0][i] = std::size_t(std::upper_bound(table.begin(), table.end(), targets[i]) - table.begin());
+		});
+		double index_time = ns_per_element(queries, [&] {
+			for (std::size_t i = 0; i < queries; ++i)
+				ranks[1][i] = index.upper_bound(targets[i]);
+		});
+		double batched_time = ns_per_element(queries, [&] {
+			index.upper_bound(targets.begin(), targets.end(), ranks[2].begin());
+		});
+
+		std::cout << std::fixed << std::setprecision(3)
+			  << std::setw(12) << size << std::setw(18) << std_time
+			  << std::setw(12) << index_time << std::setw(12) << batched_time << "\n";
+		if (ranks[0] != ranks[1] || ranks[0] != ranks[2]) {
+			std::cerr << "eytzinger_index: the ranks differ from std::upper_bound at size " << size << "\n";
+			agree = false;
+		}
+	}
+	return agree;
+}
+
+
+int main(int argc, char * argv[]) {
+
+	std::size_t max_size = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+	const std::uint64_t seed = 42;
+
+
+	// 1. transform with exponentiate
+
+	std::cout << "transform_exp dispatches to " << simd_level_name(simd_exp_kernels::best().level)
+		  << " (L1-, L2- and memory-sized inputs)\n";
+
+	benchmark_exp<double>("double", max_size, seed);
+	benchmark_exp<float>("float", max_size, seed);
+
+
+	// 2. Parallel algorithms on the thread pool
+
+	if (!benchmark_parallel(max_size, seed))
+		return 1;
+
+
+	// 3. Stream compaction
+
+	if (!benchmark_compaction(max_size, seed))
+		return 1;
+
+
+	// 4. Fused filter, transform and reduce
+
+	if (!benchmark_pipeline(max_size, seed))
+		return 1;
+
+
+	// 5. Unrolled list
+
+	if (!benchmark_lists(max_size, seed))
+		return 1;
+
+
+	// 6. Static search index
+
+	if (!benchmark_search(max_size, seed))
+		return 1;
+
+	return 0;
+}
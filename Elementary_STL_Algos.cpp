@@ -7,15 +7,26 @@
  *		3) find_if
  *		4) copy_if
  *		5) accumulate
+ *		6) copy_if, transform and accumulate fused in one pass (Pipeline.h)
+ *
+ *	Each section also shows the parallel version from Parallel_Algorithms.h,
+ *	which takes an execution policy (parallel::seq or parallel::par) first
  */
 
 // Include Standard Library headers
 #include <iostream>
 #include <array>
 #include <vector>
-#include <list>
 #include <algorithm>
 #include <numeric>
+#include <iterator>
+
+#include "Eytzinger_Index.h"
+#include "Parallel_Algorithms.h"
+#include "Pipeline.h"
+#include "Simd_Compact.h"
+#include "Simd_Exp.h"
+#include "Unrolled_List.h"
 
 // Policies (callable objects / functors)
 
@@ -80,6 +91,15 @@ int main() {
 	// will the following line compile?
 	// int k = 100; printing_evens(k);
 
+	// With a policy first, the work is split across the thread pool
+	// (the calls may run in any order, so this one doubles a copy instead of printing)
+	std::vector<int> doubled(myVector);
+	parallel::for_each(parallel::par, std::begin(doubled), std::end(doubled), [](int & number) { number *= 2; });
+
+	std::cout << "\nDoubled in parallel: ";
+	for (int number : doubled)
+		std::cout << number << " ";
+
 	std::cout << "\n\n\n";
 
 
@@ -90,11 +110,13 @@ int main() {
 
 	// Task: find the smallest element after the value 8.9
 
-	std::list<double> myList = { -.01, 2.91, 5.9, 8.71, 8.91, 8.99, 10.45 };
+	// A list with the elements in contiguous blocks: find_if reads consecutive memory
+	// instead of following a pointer per node, and iterators stay valid as with std::list
+	unrolled_list<double> myList = { -.01, 2.91, 5.9, 8.71, 8.91, 8.99, 10.45 };
 	double target = 8.9;
 
 	// Find element, if it is there
-	std::list<double>::iterator found 
+	unrolled_list<double>::iterator found 
 		= std::find_if(std::begin(myList), std::end(myList), is_greater<double>(target));
 
 	// Print the element if it is found
@@ -103,6 +125,27 @@ int main() {
 	else
 		std::cout << "Element not found!\n";
 
+	// The parallel version needs random access and still returns the first match
+	std::vector<double> myVectorCopy(std::begin(myList), std::end(myList));
+	std::vector<double>::iterator found_parallel
+		= parallel::find_if(parallel::par, std::begin(myVectorCopy), std::end(myVectorCopy), is_greater<double>(target));
+	if (found_parallel != std::end(myVectorCopy))
+		std::cout << "First element greater than " << target << " (parallel): " << *found_parallel << "\n";
+
+	// myList is sorted: for many thresholds against the same table, build a search index once;
+	// each query is then O(lg n) with cache-friendly probes instead of a scan
+	const eytzinger_index<double> index(std::begin(myList), std::end(myList));
+	std::size_t rank = index.upper_bound(target);
+	if (rank < index.size())
+		std::cout << "First element greater than " << target << " (search index): " << *std::next(std::begin(myList), rank) << "\n";
+
+	// Several thresholds at once: the lookups are interleaved to overlap their cache misses
+	std::vector<double> targets = { 0.0, 8.9, 9.0, 11.0 };
+	std::vector<std::size_t> ranks(targets.size());
+	index.upper_bound(std::begin(targets), std::end(targets), std::begin(ranks));
+	for (std::size_t i = 0; i < targets.size(); ++i)
+		std::cout << "Elements not greater than " << targets[i] << ": " << ranks[i] << "\n";
+
 	std::cout << "\n\n";
 
 
@@ -114,14 +157,32 @@ int main() {
 	// Task: exponentiate all values of an array in place
 
 	std::array<double, 5> myArray = { 3.4, 2.5, 9,8, 12.01 };
+	std::array<double, 5> myArray2 = myArray;
+	std::array<double, 5> myArray3 = myArray;
 
+	// One std::exp call per element
 	std::transform(std::begin(myArray), std::end(myArray), std::begin(myArray), exponentiate<double>());
 
+	// Same call shape, but contiguous float and double ranges run a SIMD exp kernel
+	// (other iterators fall back to std::exp); agrees with std::exp to about 1 ulp
+	transform_exp(std::begin(myArray2), std::end(myArray2), std::begin(myArray2));
+
+	// std::exp per element again, with the array split across the thread pool
+	parallel::transform(parallel::par, std::begin(myArray3), std::end(myArray3), std::begin(myArray3), exponentiate<double>());
+
 	// Print results with C++11 range-based loop
 	std::cout << "Exponentiated values\n";
 	for (auto elem : myArray) {
 		std::cout << elem << " ";
 	}
+	std::cout << "\nVectorized\n";
+	for (auto elem : myArray2) {
+		std::cout << elem << " ";
+	}
+	std::cout << "\nParallel\n";
+	for (auto elem : myArray3) {
+		std::cout << elem << " ";
+	}
 	
 	std::cout << "\n\n\n";
 
@@ -132,7 +193,7 @@ int main() {
 	std::cout << "Testing copy_if algorithm...\n";
 
 	// Task: copy all negative numbers from a list to a vector
-	std::list<double> myList2 = { -1.1, 2.231, -3.23, 4.01, -9.1, -89.1, 12, 8.28 };
+	unrolled_list<double> myList2 = { -1.1, 2.231, -3.23, 4.01, -9.1, -89.1, 12, 8.28 };
 
 	// Print list by copying the elements in the ostream
 	std::cout << "List: ";
@@ -147,6 +208,25 @@ int main() {
 	std::cout << "\nNegatives: ";
 	for (auto elem : negatives)
 		std::cout << elem << " ";
+
+	// The parallel version writes into a buffer large enough for every element, in input order
+	std::vector<double> myVector2(std::begin(myList2), std::end(myList2));
+	std::vector<double> negatives2(myVector2.size());
+	negatives2.erase(parallel::copy_if(parallel::par, std::begin(myVector2), std::end(myVector2), std::begin(negatives2), is_negative<double>()),
+			 std::end(negatives2));
+
+	std::cout << "\nNegatives (parallel): ";
+	for (auto elem : negatives2)
+		std::cout << elem << " ";
+
+	// For contiguous floats and doubles and a comparison with a constant, the SIMD compaction
+	// counts first and allocates once, instead of branching and growing the vector per element
+	std::vector<double> negatives3;
+	simd_copy_if(myVector2.data(), myVector2.data() + myVector2.size(), negatives3, less_than(0.0));
+
+	std::cout << "\nNegatives (SIMD): ";
+	for (auto elem : negatives3)
+		std::cout << elem << " ";
 	std::cout << "\n\n\n";
 
 
@@ -166,6 +246,11 @@ int main() {
 	double new_earnings =
 		std::accumulate(std::begin(earnings), std::end(earnings), initial_earnings);
 
+	// Parallel sum: the same result on every run, whatever the number of threads
+	double new_earnings_parallel =
+		parallel::accumulate(parallel::par, std::begin(earnings), std::end(earnings), initial_earnings);
+	std::cout << "New earnings: " << new_earnings << " (parallel: " << new_earnings_parallel << ")\n";
+
 	// Check if we had profit
 	if (new_earnings > initial_earnings)
 		std::cout << "Good job!\n";
@@ -175,6 +260,31 @@ int main() {
 	// Update the earnings
 	initial_earnings = new_earnings;
 
+	std::cout << "\n\n\n";
+
+
+
+	/** pipeline ***/
+
+	std::cout << "Testing pipeline...\n";
+
+	// Task: sum e^{x} over the negative values of the list, without the vectors of copy_if and transform
+	double exp_sum = pipeline::from(myList2)
+		       | pipeline::filter(is_negative<double>())
+		       | pipeline::transform(exponentiate<double>())
+		       | pipeline::reduce(0.0);
+
+	// The same pipeline on the pool, for a random access source
+	double exp_sum_parallel = pipeline::from(myVector2)
+				| pipeline::filter(is_negative<double>())
+				| pipeline::transform(exponentiate<double>())
+				| pipeline::reduce(0.0, std::plus<double>(), parallel::par);
+	std::cout << "Sum of e^{x} over the negatives: " << exp_sum << " (parallel: " << exp_sum_parallel << ")\n";
+
+	// Task: count the values greater than the target
+	std::size_t greater = pipeline::from(myList2) | pipeline::filter(is_greater<double>(target)) | pipeline::count();
+	std::cout << "Values greater than " << target << ": " << greater << "\n";
+
 	std::cout << "\n\n";
 
 	return 0;
@@ -0,0 +1,213 @@
+/*
+ *	Eytzinger Search Index
+ *
+ *	A read-only index over a sorted table for lower_bound / upper_bound
+ *	queries, laid out for the cache instead of in sorted order
+ *
+ *	std::upper_bound halves a sorted array: its first probes are far apart
+ *	and each one is a cache miss that must complete before the next probe
+ *	is known. The Eytzinger layout stores the same keys as an implicit
+ *	binary search tree in breadth-first order: the root at 1, the children
+ *	of node k at 2k and 2k + 1. The top levels share a few cache lines that
+ *	stay cached, and the descendants of a node three or four levels down
+ *	are consecutive: one 64-byte line, fetched ahead while the levels in
+ *	between are compared. Each step is k = 2k + (comparison), no branch.
+ *
+ *	The batched queries go one level at a time through a group of keys,
+ *	so the misses of different keys overlap instead of queuing. On tables
+ *	much larger than the cache the deep levels also miss the TLB, where a
+ *	prefetch helps little: batch the queries there.
+ *
+ *	Queries return ranks in the sorted input, as std::upper_bound(...) -
+ *	begin would, and size() when no key qualifies. The rank follows from
+ *	the node index; the index stores nothing but the padded keys.
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <xmmintrin.h>
+#endif
+
+#include "Bit_Ops.h"
+#include "Cache_Aligned_Allocator.h"
+
+
+namespace eytzinger_detail {
+
+	const std::size_t cache_line = 64;
+
+	// Queries interleaved by the batched lookups
+	const std::size_t batch = 16;
+
+	inline void prefetch(const void * address) {
+#if defined(__GNUC__) || defined(__clang__)
+		__builtin_prefetch(address);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		_mm_prefetch(static_cast<const char *>(address), _MM_HINT_T0);
+#else
+		(void)address;
+#endif
+	}
+
+}
+
+
+template <class Key, class Compare = std::less<Key>>
+class eytzinger_index {
+public:
+
+	typedef Key key_type;
+
+	eytzinger_index() : count(0), levels(0) {}
+
+	// From a sorted range, in the order of 'comp'
+	// O(n), one pass over the input
+	template <class ForwardIterator>
+	eytzinger_index(ForwardIterator first, ForwardIterator last, Compare comp = Compare())
+		: count(std::size_t(std::distance(first, last))), levels(0), comp(comp) {
+		if (!count)
+			return;
+		while ((std::size_t(1) << levels) <= count)
+			++levels;
+
+		// An in-order walk of the tree visits the nodes in sorted order
+		keys.assign(std::size_t(1) << levels, *first);
+		fill(1, first);
+
+		// The padding past the last node is read, never chosen: see descend()
+		for (std::size_t k = count + 1; k < keys.size(); ++k)
+			keys[k] = keys[count];
+	}
+
+	explicit eytzinger_index(const std::vector<Key> & sorted, Compare comp = Compare())
+		: eytzinger_index(sorted.begin(), sorted.end(), comp) {}
+
+	std::size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+
+	// Rank of the first key not less than 'key', or greater than 'key'; size() if none
+	// O(lg n)
+	std::size_t lower_bound(const Key & key) const { return count ? rank(descend(key, goes_right_of_lower{ comp })) : 0; }
+	std::size_t upper_bound(const Key & key) const { return count ? rank(descend(key, goes_right_of_upper{ comp })) : 0; }
+
+	// The ranks of a sequence of keys, written to 'ranks'; faster than one at a time
+	// when the index does not fit in the cache
+	template <class InputIterator, class OutputIterator>
+	OutputIterator lower_bound(InputIterator first, InputIterator last, OutputIterator ranks) const {
+		return descend_batch(first, last, ranks, goes_right_of_lower{ comp });
+	}
+
+	template <class InputIterator, class OutputIterator>
+	OutputIterator upper_bound(InputIterator first, InputIterator last, OutputIterator ranks) const {
+		return descend_batch(first, last, ranks, goes_right_of_upper{ comp });
+	}
+
+private:
+
+	// Descend to the right child of a node holding 'node' when looking for 'key'
+	struct goes_right_of_lower {
+		Compare comp;
+		bool operator()(const Key & node, const Key & key) const { return comp(node, key); }
+	};
+
+	struct goes_right_of_upper {
+		Compare comp;
+		bool operator()(const Key & node, const Key & key) const { return !comp(key, node); }
+	};
+
+	template <class ForwardIterator>
+	void fill(std::size_t k, ForwardIterator & next) {
+		if (k > count)
+			return;
+		fill(2 * k, next);
+		keys[k] = *next;
+		++next;
+		fill(2 * k + 1, next);
+	}
+
+	// Levels above the last are complete, so the loop has a fixed trip count; the last level
+	// may stop early, without a branch: past the last node, k keeps its value
+	// The answer is the last node left by a step to its left child: strip the trailing right steps
+	template <class GoesRight>
+	std::size_t descend(const Key & key, GoesRight goes_right) const {
+		using namespace eytzinger_detail;
+		const Key * tree = keys.data();
+		const std::size_t ahead = cache_line / sizeof(Key) ? cache_line / sizeof(Key) : 1;
+		const std::size_t padded = keys.size();
+
+		std::size_t k = 1;
+		for (unsigned level = 1; level < levels; ++level) {
+			const std::size_t descendants = k * ahead;
+			prefetch(tree + (descendants < padded ? descendants : 0));
+			k = 2 * k + goes_right(tree[k], key);
+		}
+		const std::size_t next = 2 * k + goes_right(tree[k], key);
+		k = k <= count ? next : k;
+		return k >> (bit_ops::lowest_bit(~k) + 1);
+	}
+
+	template <class InputIterator, class OutputIterator, class GoesRight>
+	OutputIterator descend_batch(InputIterator first, InputIterator last, OutputIterator out, GoesRight goes_right) const {
+		using namespace eytzinger_detail;
+		const Key * tree = keys.data();
+		std::vector<Key> group;
+		group.reserve(batch);
+		std::size_t k[batch];
+
+		while (first != last) {
+			group.clear();
+			for (; group.size() < batch && first != last; ++first)
+				group.push_back(*first);
+			const std::size_t size = group.size();
+			if (!count) {
+				for (std::size_t i = 0; i < size; ++i)
+					*out++ = 0;
+				continue;
+			}
+
+			// One level for every key of the group; the next node of each key is fetched
+			// while the others are compared
+			for (std::size_t i = 0; i < size; ++i)
+				k[i] = 1;
+			for (unsigned level = 1; level < levels; ++level)
+				for (std::size_t i = 0; i < size; ++i) {
+					k[i] = 2 * k[i] + goes_right(tree[k[i]], group[i]);
+					prefetch(tree + k[i]);
+				}
+			for (std::size_t i = 0; i < size; ++i) {
+				const std::size_t next = 2 * k[i] + goes_right(tree[k[i]], group[i]);
+				std::size_t node = k[i] <= count ? next : k[i];
+				node >>= bit_ops::lowest_bit(~node) + 1;
+				*out++ = rank(node);
+			}
+		}
+		return out;
+	}
+
+	// In-order position of node k, computed instead of looked up: a table of ranks would cost
+	// another cache miss per query. In the perfect tree of 'levels' levels, node k at depth d
+	// has ((2 (k - 2^d) + 1) << (levels - 1 - d)) - 1 nodes before it; the leaves of the
+	// last level sit at the even positions, and only the first 'leaves' of them exist
+	std::size_t rank(std::size_t k) const {
+		if (!k)
+			return count;
+		const unsigned depth = bit_ops::highest_bit(k);
+		const std::size_t perfect = ((2 * (k - (std::size_t(1) << depth)) + 1) << (levels - 1 - depth)) - 1;
+		const std::size_t leaves = count - (std::size_t(1) << (levels - 1)) + 1;
+		const std::size_t leaves_before = (perfect + 1) / 2;
+		return leaves_before > leaves ? perfect - (leaves_before - leaves) : perfect;
+	}
+
+	std::vector<Key, cache_aligned_allocator<Key>> keys;	// 1-based; padded to a power of 2
+	std::size_t count;
+	unsigned levels;
+	Compare comp;
+};
@@ -0,0 +1,169 @@
+/*
+ *	Introsort
+ *
+ *	Generic in-place sort for random-access ranges, a drop-in for std::sort
+ *
+ *	- median-of-3 pivot, Tukey's ninther (median of 9) on large ranges
+ *	- Bentley-McIlroy three-way partitioning: runs of equal keys are
+ *	  gathered around the pivot and never visited again, so few-unique
+ *	  inputs such as 'A'..'Z' sort in close to linear time
+ *	- insertion sort below a small cutoff
+ *	- heapsort fallback after 2 lg n partitioning levels: O(n lg n) worst case
+ *	- recursion only into the smaller side: O(lg n) stack depth
+ *	- iterator arithmetic throughout, no int/unsigned index limits
+ *
+ *	Musser, "Introspective Sorting and Selection Algorithms", 1997
+ *	Bentley and McIlroy, "Engineering a Sort Function", 1993
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+
+namespace introsort_detail {
+
+	// Ranges up to this size are finished with insertion sort
+	const std::ptrdiff_t insertion_threshold = 16;
+
+	// Ranges above this size take the ninther as pivot
+	const std::ptrdiff_t ninther_threshold = 128;
+
+
+	// O(n^2), fast on short ranges
+	template <class RandomIt, class Compare>
+	void insertion_sort(RandomIt first, RandomIt last, Compare comp) {
+		if (first == last)
+			return;
+
+		for (RandomIt i = first + 1; i != last; ++i) {
+			auto value = std::move(*i);
+			RandomIt j = i;
+
+			if (comp(value, *first)) {
+				// New minimum: shift the whole prefix
+				std::move_backward(first, i, i + 1);
+				j = first;
+			}
+			else {
+				// *first bounds the scan, no range check needed
+				for (; comp(value, *(j - 1)); --j)
+					*j = std::move(*(j - 1));
+			}
+			*j = std::move(value);
+		}
+	}
+
+	// Order three elements so that *a <= *b <= *c
+	template <class RandomIt, class Compare>
+	void sort3(RandomIt a, RandomIt b, RandomIt c, Compare comp) {
+		if (comp(*b, *a)) std::iter_swap(a, b);
+		if (comp(*c, *b)) {
+			std::iter_swap(b, c);
+			if (comp(*b, *a)) std::iter_swap(a, b);
+		}
+	}
+
+	// Move the chosen pivot to *first
+	template <class RandomIt, class Compare>
+	void choose_pivot(RandomIt first, RandomIt last, Compare comp) {
+		const std::ptrdiff_t n = last - first;
+		RandomIt mid = first + n / 2;
+
+		if (n > ninther_threshold) {
+			sort3(first, mid, last - 1, comp);
+			sort3(first + 1, mid - 1, last - 2, comp);
+			sort3(first + 2, mid + 1, last - 3, comp);
+			sort3(mid - 1, mid, mid + 1, comp);
+			std::iter_swap(first, mid);
+		}
+		else {
+			sort3(mid, first, last - 1, comp);
+		}
+	}
+
+	// Three-way partition around the pivot in *first
+	// Returns [lt, gt) such that [first, lt) < pivot, [lt, gt) == pivot, [gt, last) > pivot
+	template <class RandomIt, class Compare>
+	std::pair<RandomIt, RandomIt> partition3(RandomIt first, RandomIt last, Compare comp) {
+
+		// Equal keys collect at both ends: [first, a) and (d, last)
+		RandomIt a = first + 1, b = first + 1;
+		RandomIt c = last - 1, d = last - 1;
+		const auto & pivot = *first;
+
+		for (;;) {
+			for (; b <= c && !comp(pivot, *b); ++b)
+				if (!comp(*b, pivot))
+					std::iter_swap(a++, b);
+			for (; b <= c && !comp(*c, pivot); --c)
+				if (!comp(pivot, *c))
+					std::iter_swap(c, d--);
+			if (b > c)
+				break;
+			std::iter_swap(b++, c--);
+		}
+
+		// Swap both equal blocks into the middle
+		const std::ptrdiff_t left = std::min(a - first, b - a);
+		std::swap_ranges(first, first + left, b - left);
+
+		const std::ptrdiff_t right = std::min(d - c, (last - 1) - d);
+		std::swap_ranges(b, b + right, last - right);
+
+		return std::make_pair(first + (b - a), last - (d - c));
+	}
+
+	template <class RandomIt, class Compare>
+	void introsort_loop(RandomIt first, RandomIt last, int depth_limit, Compare comp) {
+		while (last - first > insertion_threshold) {
+
+			// Too many unbalanced partitions: guarantee O(n lg n) with heapsort
+			if (depth_limit-- == 0) {
+				std::make_heap(first, last, comp);
+				std::sort_heap(first, last, comp);
+				return;
+			}
+
+			choose_pivot(first, last, comp);
+			std::pair<RandomIt, RandomIt> equal = partition3(first, last, comp);
+
+			// Recurse into the smaller side and loop on the larger one
+			if (equal.first - first < last - equal.second) {
+				introsort_loop(first, equal.first, depth_limit, comp);
+				first = equal.second;
+			}
+			else {
+				introsort_loop(equal.second, last, depth_limit, comp);
+				last = equal.first;
+			}
+		}
+		insertion_sort(first, last, comp);
+	}
+
+	inline int log2_floor(std::size_t n) {
+		int log = 0;
+		while (n >>= 1)
+			++log;
+		return log;
+	}
+}
+
+
+// O(n lg n) worst case, O(lg n) stack
+template <class RandomIt, class Compare>
+void introsort(RandomIt first, RandomIt last, Compare comp) {
+	if (last - first > 1)
+		introsort_detail::introsort_loop(first, last, 2 * introsort_detail::log2_floor(std::size_t(last - first)), comp);
+}
+
+template <class RandomIt>
+void introsort(RandomIt first, RandomIt last) {
+	introsort(first, last, std::less<typename std::iterator_traits<RandomIt>::value_type>());
+}
@@ -0,0 +1,643 @@
+/*
+ *	More STL Algorithms benchmark
+ *
+ *	1. std::set_intersection, set_union and set_difference through a
+ *	   back_inserter against the set kernels per instruction set (sized
+ *	   exactly by a counting pass) and sized by an upper bound instead,
+ *	   for 32- and 64-bit sets, over size ratios from 1 to 1000 and dense
+ *	   (half of the value range) and sparse (1%) sets; then the
+ *	   intersection of k sets, pairwise with std::set_intersection against
+ *	   the k-way kernel
+ *	2. The same operations on 32-bit sets as sorted vectors against
+ *	   roaring bitmaps, whole and sizes only, for dense (half of the value
+ *	   range), sparse (1%) and clustered (runs of consecutive ids) sets;
+ *	   with the memory of both, before and after run_optimize()
+ *	3. std::set_intersection, set_union and set_difference against their
+ *	   parallel:: merge-path versions, on sorted inputs with repeated values,
+ *	   for 1, 2, 4, ... threads up to the hardware
+ *	4. std::priority_queue and the std:: heap algorithms against 4- and
+ *	   8-ary heaps, as min-heaps of event times: building, pushing one at a
+ *	   time and in batches of 64, popping, the hold model of a scheduler
+ *	   (pop the next event, push a later one) and decrease-key, with
+ *	   handles against pushing duplicates and skipping the stale ones
+ *
+ *	Usage: More_Benchmark [max_size]
+ *
+ */
+
+// Include Standard Library headers
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <vector>
+#include <cstdlib>
+#include <cstdint>
+#include <iterator>
+#include <functional>
+#include <queue>
+#include <thread>
+
+#include "Benchmark_Harness.h"
+#include "Dary_Heap.h"
+#include "Parallel_Algorithms.h"
+#include "Random_Fill.h"
+#include "Simd_Set_Ops.h"
+#include "Roaring_Bitmap.h"
+
+
+// About 'size' distinct values drawn from [0, range), sorted
+template <class Int>
+std::vector<Int> random_set(std::size_t size, std::uint64_t range, std::uint64_t seed) {
+	std::vector<Int> set(size);
+	random_fill(set, Int(0), Int(range - 1), seed);
+	std::sort(set.begin(), set.end());
+	set.erase(std::unique(set.begin(), set.end()), set.end());
+	return set;
+}
+
+
+// One row per operation, size ratio and density; times per element of both inputs
+// Returns false when a result differs from the std:: algorithm
+template <class Int>
+bool benchmark_sets(const char * type, std::size_t max_size, std::uint64_t seed) {
+
+	const simd_level levels[] = { simd_level::scalar, simd_level::avx2, simd_level::avx512 };
+	bool agree = true;
+
+	std::cout << "\nset operations on " << type << " [ns/element]\n"
+		  << std::setw(14) << "operation" << std::setw(8) << "ratio" << std::setw(9) << "density"
+		  << std::setw(16) << "back_inserter";
+	for (simd_level level : levels)
+		std::cout << std::setw(12) << simd_level_name(level);
+	std::cout << std::setw(14) << "upper bound" << "\n";
+
+	enum class operation { intersection, set_union, difference };
+	const char * names[] = { "intersection", "union", "difference" };
+
+	for (operation op : { operation::intersection, operation::set_union, operation::difference })
+		for (std::size_t ratio : { std::size_t(1), std::size_t(10), std::size_t(100), std::size_t(1000) })
+			for (double density : { 0.5, 0.01 }) {
+
+				// The large set is the second one: a - b with a small keeps little of a
+				const std::uint64_t range = std::uint64_t(double(max_size) / density);
+				const std::vector<Int> a = random_set<Int>(std::max<std::size_t>(1, max_size / ratio), range, seed);
+				const std::vector<Int> b = random_set<Int>(max_size, range, seed + 1);
+				const Int * a_first = a.data(), * a_last = a.data() + a.size();
+				const Int * b_first = b.data(), * b_last = b.data() + b.size();
+
+				const std::size_t elements = a.size() + b.size();
+				const std::size_t repeats = std::max<std::size_t>(1, 10000000 / elements);
+
+				std::vector<Int> expected, output;
+				auto run_std = [&] {
+					expected = std::vector<Int>();
+					if (op == operation::intersection)
+						std::set_intersection(a_first, a_last, b_first, b_last, std::back_inserter(expected));
+					else if (op == operation::set_union)
+						std::set_union(a_first, a_last, b_first, b_last, std::back_inserter(expected));
+					else
+						std::set_difference(a_first, a_last, b_first, b_last, std::back_inserter(expected));
+				};
+				double time = ns_per_element(elements * repeats, [&] {
+					for (std::size_t r = 0; r < repeats; ++r)
+						run_std();
+				});
+				std::cout << std::fixed << std::setprecision(3)
+					  << std::setw(14) << names[int(op)] << std::setw(8) << ratio << std::setw(8) << std::setprecision(0)
+					  << 100 * density << "%" << std::setprecision(3) << std::setw(16) << time;
+
+				auto compare = [&](const char * name) {
+					if (output != expected) {
+						std::cerr << names[int(op)] << " (" << name << "): differs at ratio " << ratio << ", density " << density << "\n";
+						agree = false;
+					}
+				};
+
+				// The union has no vector kernel: one scalar column
+				for (simd_level level : levels) {
+					if (level > simd_reductions::best_level() || (op == operation::set_union && level != simd_level::scalar)) {
+						std::cout << std::setw(12) << "-";
+						continue;
+					}
+					const simd_set_kernels<Int> kernels = simd_set_kernels<Int>::for_level(level);
+					time = ns_per_element(elements * repeats, [&] {
+						for (std::size_t r = 0; r < repeats; ++r) {
+							const std::size_t common = kernels.intersection_size(a_first, a.size(), b_first, b.size());
+							if (op == operation::intersection) {
+								output = std::vector<Int>(common);
+								kernels.intersection(a_first, a.size(), b_first, b.size(), output.data(), output.size());
+							}
+							else if (op == operation::set_union) {
+								output = std::vector<Int>(elements - common);
+								simd_set_union(a_first, a_last, b_first, b_last, output.data());
+							}
+							else {
+								output = std::vector<Int>(a.size() - common);
+								kernels.difference(a_first, a.size(), b_first, b.size(), output.data(), output.size());
+							}
+						}
+					});
+					std::cout << std::setw(12) << time;
+					compare(simd_level_name(level));
+				}
+
+				time = ns_per_element(elements * repeats, [&] {
+					for (std::size_t r = 0; r < repeats; ++r) {
+						output = std::vector<Int>();
+						if (op == operation::intersection)
+							simd_set_intersection(a_first, a_last, b_first, b_last, output, output_sizing::upper_bound);
+						else if (op == operation::set_union)
+							simd_set_union(a_first, a_last, b_first, b_last, output, output_sizing::upper_bound);
+						else
+							simd_set_difference(a_first, a_last, b_first, b_last, output, output_sizing::upper_bound);
+					}
+				});
+				std::cout << std::setw(14) << time << "\n";
+				compare("upper bound");
+			}
+
+	// k sets of sizes n, n / 2, n / 4, ... from the same range: std::set_intersection pairwise, largest
+	// first as the sets come, against the k-way kernel (smallest first)
+	std::cout << "\nintersection of k " << type << " sets [ns/element]\n"
+		  << std::setw(8) << "k" << std::setw(9) << "density" << std::setw(16) << "pairwise" << std::setw(12) << "k-way" << "\n";
+
+	for (std::size_t k : { std::size_t(2), std::size_t(4), std::size_t(8) })
+		for (double density : { 0.5, 0.01 }) {
+			const std::uint64_t range = std::uint64_t(double(max_size) / density);
+			std::vector<std::vector<Int>> sets;
+			std::size_t elements = 0;
+			for (std::size_t s = 0; s < k; ++s) {
+				sets.push_back(random_set<Int>(std::max<std::size_t>(1, max_size >> s), range, seed + s));
+				elements += sets.back().size();
+			}
+			const std::size_t repeats = std::max<std::size_t>(1, 10000000 / elements);
+
+			std::vector<Int> expected, output, step;
+			double pairwise_time = ns_per_element(elements * repeats, [&] {
+				for (std::size_t r = 0; r < repeats; ++r) {
+					expected = sets[0];
+					for (std::size_t s = 1; s < k; ++s) {
+						step.clear();
+						std::set_intersection(expected.begin(), expected.end(), sets[s].begin(), sets[s].end(), std::back_inserter(step));
+						expected.swap(step);
+					}
+				}
+			});
+			double kway_time = ns_per_element(elements * repeats, [&] {
+				for (std::size_t r = 0; r < repeats; ++r) {
+					output = std::vector<Int>();
+					simd_set_intersection(sets, output);
+				}
+			});
+			std::cout << std::fixed << std::setprecision(3)
+				  << std::setw(8) << k << std::setw(8) << std::setprecision(0) << 100 * density << "%"
+				  << std::setprecision(3) << std::setw(16) << pairwise_time << std::setw(12) << kway_time << "\n";
+			if (output != expected) {
+				std::cerr << "k-way intersection: differs for k = " << k << ", density " << density << "\n";
+				agree = false;
+			}
+		}
+	return agree;
+}
+
+
+// About 'size' ids in runs of 1 to 2000 consecutive values, from [0, range), sorted
+std::vector<std::uint32_t> clustered_set(std::size_t size, std::uint64_t range, std::uint64_t seed) {
+	std::vector<std::uint32_t> starts(size / 1000 + 1), lengths(starts.size());
+	random_fill(starts, std::uint32_t(0), std::uint32_t(range - 1), seed);
+	random_fill(lengths, std::uint32_t(1), std::uint32_t(2000), seed + 1);
+	std::vector<std::uint32_t> set;
+	for (std::size_t r = 0; r < starts.size(); ++r)
+		for (std::uint32_t v = starts[r]; v - starts[r] < lengths[r] && v < range; ++v)
+			set.push_back(v);
+	std::sort(set.begin(), set.end());
+	set.erase(std::unique(set.begin(), set.end()), set.end());
+	return set;
+}
+
+
+// One row per operation and distribution; times per element of both inputs
+// Returns false when a result differs from the std:: algorithm
+bool benchmark_bitmaps(std::size_t max_size, std::uint64_t seed) {
+
+	typedef std::uint32_t Int;
+	enum class distribution { dense, sparse, clustered };
+	const char * distributions[] = { "dense", "sparse", "clustered" };
+	bool agree = true;
+
+	std::cout << "\nmemory of two uint32 sets [bytes per value]\n"
+		  << std::setw(14) << "distribution" << std::setw(12) << "values" << std::setw(12) << "vector"
+		  << std::setw(12) << "roaring" << std::setw(14) << "with runs" << "\n";
+
+	std::vector<std::vector<Int>> as, bs;
+	for (distribution d : { distribution::dense, distribution::sparse, distribution::clustered }) {
+		const std::uint64_t range = d == distribution::dense ? 2 * std::uint64_t(max_size) : 100 * std::uint64_t(max_size);
+		if (d == distribution::clustered) {
+			as.push_back(clustered_set(max_size, range, seed));
+			bs.push_back(clustered_set(max_size, range, seed + 2));
+		}
+		else {
+			as.push_back(random_set<Int>(max_size, range, seed));
+			bs.push_back(random_set<Int>(max_size, range, seed + 1));
+		}
+		const std::vector<Int> & a = as.back(), & b = bs.back();
+		const double values = double(a.size() + b.size());
+		roaring_bitmap ra(a.begin(), a.end()), rb(b.begin(), b.end());
+		const double bytes = double(ra.memory_bytes() + rb.memory_bytes());
+		ra.run_optimize();
+		rb.run_optimize();
+		std::cout << std::fixed << std::setprecision(3)
+			  << std::setw(14) << distributions[int(d)] << std::setw(12) << a.size() + b.size()
+			  << std::setw(12) << double(sizeof(Int))
+			  << std::setw(12) << bytes / values
+			  << std::setw(14) << double(ra.memory_bytes() + rb.memory_bytes()) / values << "\n";
+	}
+
+	std::cout << "\nuint32 sets as vectors and as roaring bitmaps [ns/element]\n"
+		  << std::setw(14) << "operation" << std::setw(14) << "distribution" << std::setw(16) << "back_inserter"
+		  << std::setw(14) << "set kernels" << std::setw(12) << "roaring" << std::setw(14) << "with runs"
+		  << std::setw(14) << "size only" << "\n";
+
+	enum class operation { intersection, set_union, difference };
+	const char * names[] = { "intersection", "union", "difference" };
+
+	for (operation op : { operation::intersection, operation::set_union, operation::difference })
+		for (distribution d : { distribution::dense, distribution::sparse, distribution::clustered }) {
+			const std::vector<Int> & a = as[int(d)], & b = bs[int(d)];
+			const Int * a_first = a.data(), * a_last = a.data() + a.size();
+			const Int * b_first = b.data(), * b_last = b.data() + b.size();
+			const std::size_t elements = a.size() + b.size();
+			const std::size_t repeats = std::max<std::size_t>(1, 10000000 / elements);
+
+			std::vector<Int> expected, output;
+			double time = ns_per_element(elements * repeats, [&] {
+				for (std::size_t r = 0; r < repeats; ++r) {
+					expected = std::vector<Int>();
+					if (op == operation::intersection)
+						std::set_intersection(a_first, a_last, b_first, b_last, std::back_inserter(expected));
+					else if (op == operation::set_union)
+						std::set_union(a_first, a_last, b_first, b_last, std::back_inserter(expected));
+					else
+						std::set_difference(a_first, a_last, b_first, b_last, std::back_inserter(expected));
+				}
+			});
+			std::cout << std::fixed << std::setprecision(3)
+				  << std::setw(14) << names[int(op)] << std::setw(14) << distributions[int(d)] << std::setw(16) << time;
+
+			time = ns_per_element(elements * repeats, [&] {
+				for (std::size_t r = 0; r < repeats; ++r) {
+					output = std::vector<Int>();
+					if (op == operation::intersection)
+						simd_set_intersection(a_first, a_last, b_first, b_last, output);
+					else if (op == operation::set_union)
+						simd_set_union(a_first, a_last, b_first, b_last, output);
+					else
+						simd_set_difference(a_first, a_last, b_first, b_last, output);
+				}
+			});
+			std::cout << std::setw(14) << time;
+			if (output != expected) {
+				std::cerr << names[int(op)] << " (set kernels): differs for " << distributions[int(d)] << " sets\n";
+				agree = false;
+			}
+
+			// Without and with run containers; the result is checked once per column
+			roaring_bitmap ra(a.begin(), a.end()), rb(b.begin(), b.end()), result;
+			for (int pass = 0; pass < 2; ++pass) {
+				if (pass == 1) {
+					ra.run_optimize();
+					rb.run_optimize();
+				}
+				time = ns_per_element(elements * repeats, [&] {
+					for (std::size_t r = 0; r < repeats; ++r) {
+						if (op == operation::intersection)
+							result = ra & rb;
+						else if (op == operation::set_union)
+							result = ra | rb;
+						else
+							result = ra - rb;
+					}
+				});
+				std::cout << std::setw(pass ? 14 : 12) << time;
+				if (result.to_vector() != expected) {
+					std::cerr << names[int(op)] << " (roaring): differs for " << distributions[int(d)] << " sets\n";
+					agree = false;
+				}
+			}
+
+			std::uint64_t size = 0;
+			time = ns_per_element(elements * repeats, [&] {
+				for (std::size_t r = 0; r < repeats; ++r) {
+					if (op == operation::intersection)
+						size = intersection_size(ra, rb);
+					else if (op == operation::set_union)
+						size = union_size(ra, rb);
+					else
+						size = difference_size(ra, rb);
+				}
+			});
+			std::cout << std::setw(14) << time << "\n";
+			if (size != expected.size()) {
+				std::cerr << names[int(op)] << " (roaring size): differs for " << distributions[int(d)] << " sets\n";
+				agree = false;
+			}
+		}
+	return agree;
+}
+
+
+// One row per operation and thread count: sequential, parallel and the speedup
+// Returns false when a parallel result differs from the sequential one
+bool benchmark_parallel_sets(std::size_t max_size, std::uint64_t seed) {
+
+	// Values from [0, max_size / 2): most of them twice or more in either input
+	std::vector<std::uint32_t> a(max_size), b(max_size);
+	random_fill(a, std::uint32_t(0), std::uint32_t(std::max<std::size_t>(1, max_size / 2) - 1), seed);
+	random_fill(b, std::uint32_t(0), std::uint32_t(std::max<std::size_t>(1, max_size / 2) - 1), seed + 1);
+	std::sort(a.begin(), a.end());
+	std::sort(b.begin(), b.end());
+
+	const std::size_t elements = a.size() + b.size();
+	const std::size_t repeats = std::max<std::size_t>(1, 10000000 / elements);
+	bool agree = true;
+
+	std::cout << "\nparallel:: set operations on " << max_size << " + " << max_size << " uint32 with repeats [ns/element]\n"
+		  << std::setw(14) << "operation" << std::setw(10) << "threads"
+		  << std::setw(12) << "std::" << std::setw(12) << "parallel::" << std::setw(10) << "speedup" << "\n";
+
+	enum class operation { intersection, set_union, difference };
+	const char * names[] = { "intersection", "union", "difference" };
+	const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+
+	for (operation op : { operation::intersection, operation::set_union, operation::difference }) {
+		std::vector<std::uint32_t> expected(elements), output(elements);
+		std::vector<std::uint32_t>::iterator expected_end = expected.begin(), output_end = output.begin();
+		const double sequential = ns_per_element(elements * repeats, [&] {
+			for (std::size_t r = 0; r < repeats; ++r) {
+				if (op == operation::intersection)
+					expected_end = std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), expected.begin());
+				else if (op == operation::set_union)
+					expected_end = std::set_union(a.begin(), a.end(), b.begin(), b.end(), expected.begin());
+				else
+					expected_end = std::set_difference(a.begin(), a.end(), b.begin(), b.end(), expected.begin());
+			}
+		});
+
+		for (unsigned threads = 1; ; threads = std::min(2 * threads, hardware)) {
+			work_stealing_pool pool(threads);
+			const parallel::parallel_policy policy = parallel::par.on(pool);
+			const double parallel_time = ns_per_element(elements * repeats, [&] {
+				for (std::size_t r = 0; r < repeats; ++r) {
+					if (op == operation::intersection)
+						output_end = parallel::set_intersection(policy, a.begin(), a.end(), b.begin(), b.end(), output.begin());
+					else if (op == operation::set_union)
+						output_end = parallel::set_union(policy, a.begin(), a.end(), b.begin(), b.end(), output.begin());
+					else
+						output_end = parallel::set_difference(policy, a.begin(), a.end(), b.begin(), b.end(), output.begin());
+				}
+			});
+			std::cout << std::fixed << std::setprecision(3)
+				  << std::setw(14) << names[int(op)] << std::setw(10) << threads
+				  << std::setw(12) << sequential << std::setw(12) << parallel_time
+				  << std::setw(10) << std::setprecision(2) << sequential / parallel_time << "\n";
+
+			if (output_end - output.begin() != expected_end - expected.begin() || !std::equal(expected.begin(), expected_end, output.begin())) {
+				std::cerr << names[int(op)] << ": parallel result differs with " << threads << " threads\n";
+				agree = false;
+			}
+
+			if (threads == hardware)
+				break;
+		}
+	}
+	return agree;
+}
+
+
+// std::push_heap and std::pop_heap on a vector, with the interface of std::priority_queue
+template <class T, class Compare>
+class std_heap_algorithms {
+public:
+	template <class InputIterator>
+	std_heap_algorithms(InputIterator first, InputIterator last) : heap(first, last) { std::make_heap(heap.begin(), heap.end(), Compare()); }
+
+	const T & top() const { return heap.front(); }
+	void push(const T & value) {
+		heap.push_back(value);
+		std::push_heap(heap.begin(), heap.end(), Compare());
+	}
+	void pop() {
+		std::pop_heap(heap.begin(), heap.end(), Compare());
+		heap.pop_back();
+	}
+	std::size_t size() const { return heap.size(); }
+	bool empty() const { return heap.empty(); }
+
+private:
+	std::vector<T> heap;
+};
+
+// One push per value, where the heap has no batch push
+template <class Heap, class InputIterator>
+void push_batch(Heap & heap, InputIterator first, InputIterator last) {
+	for (; first != last; ++first)
+		heap.push(*first);
+}
+
+template <class T, unsigned Arity, class Compare, class InputIterator>
+void push_batch(dary_heap<T, Arity, Compare> & heap, InputIterator first, InputIterator last) {
+	heap.push(first, last);
+}
+
+enum class heap_operation { build, push, batch_push, pop, hold, decrease_key };
+
+// Runs one operation on a heap of 'times', 'repeats' times; returns the sum of the values popped
+// (or the size built), to check the heaps against each other
+template <class Heap>
+double run_heap(heap_operation op, const std::vector<double> & times, const std::vector<double> & delays, std::size_t repeats) {
+	double check = 0;
+	const std::size_t batch = 64;
+	for (std::size_t r = 0; r < repeats; ++r) {
+		if (op == heap_operation::build) {
+			Heap heap(times.begin(), times.end());
+			check += double(heap.size()) + heap.top();
+		}
+		else if (op == heap_operation::push || op == heap_operation::batch_push) {
+			Heap heap(times.begin(), times.begin());
+			if (op == heap_operation::push)
+				for (double time : times)
+					heap.push(time);
+			else
+				for (std::size_t i = 0; i < times.size(); i += batch)
+					push_batch(heap, times.begin() + i, times.begin() + std::min(times.size(), i + batch));
+			check += heap.top();
+		}
+		else if (op == heap_operation::pop) {
+			Heap heap(times.begin(), times.end());
+			for (; !heap.empty(); heap.pop())
+				check += heap.top();
+		}
+		else {
+			// A scheduler holding times.size() events: every step runs the next one and schedules a later one
+			Heap heap(times.begin(), times.end());
+			for (double delay : delays) {
+				const double next = heap.top();
+				check += next;
+				heap.pop();
+				heap.push(next + delay);
+			}
+		}
+	}
+	return check;
+}
+
+// Decrease-key on an indexed heap: every step moves a random pending event earlier, then runs the next
+template <unsigned Arity>
+double run_decrease_key(const std::vector<double> & times, const std::vector<double> & delays, std::size_t repeats) {
+	double check = 0;
+	for (std::size_t r = 0; r < repeats; ++r) {
+		indexed_dary_heap<double, Arity, std::greater<double>> heap;
+		std::vector<std::size_t> handles;
+		for (double time : times)
+			handles.push_back(heap.push(time));
+		for (std::size_t step = 0; step < delays.size() && !heap.empty(); ++step) {
+			const std::size_t event = std::size_t(delays[step] * 1e6) % handles.size();
+			if (heap.contains(handles[event]) && heap.value(handles[event]) > delays[step])
+				heap.decrease_key(handles[event], heap.value(handles[event]) - delays[step]);
+			check += heap.top();
+			heap.pop();
+		}
+	}
+	return check;
+}
+
+// The same with std::priority_queue: the earlier time is pushed as a new entry, and entries whose
+// time is no longer current are skipped when popped
+double run_decrease_key_lazy(const std::vector<double> & times, const std::vector<double> & delays, std::size_t repeats) {
+	typedef std::pair<double, std::size_t> entry;
+	double check = 0;
+	for (std::size_t r = 0; r < repeats; ++r) {
+		std::vector<entry> entries;
+		for (std::size_t i = 0; i < times.size(); ++i)
+			entries.push_back(entry(times[i], i));
+		std::priority_queue<entry, std::vector<entry>, std::greater<entry>> heap(entries.begin(), entries.end());
+		std::vector<double> current(times);
+		std::vector<bool> done(times.size(), false);
+		for (std::size_t step = 0; step < delays.size() && !heap.empty(); ++step) {
+			const std::size_t event = std::size_t(delays[step] * 1e6) % times.size();
+			if (!done[event] && current[event] > delays[step]) {
+				current[event] -= delays[step];
+				heap.push(entry(current[event], event));
+			}
+			while (done[heap.top().second] || heap.top().first != current[heap.top().second])
+				heap.pop();
+			check += heap.top().first;
+			done[heap.top().second] = true;
+			heap.pop();
+			while (!heap.empty() && (done[heap.top().second] || heap.top().first != current[heap.top().second]))
+				heap.pop();
+		}
+	}
+	return check;
+}
+
+
+// One row per operation and size; times per value in the heap
+// Returns false when the heaps pop different values
+bool benchmark_heaps(std::size_t max_size, std::uint64_t seed) {
+
+	typedef std::greater<double> earliest_first;
+	bool agree = true;
+
+	std::cout << "\nmin-heaps of double [ns/element]\n"
+		  << std::setw(14) << "operation" << std::setw(12) << "size"
+		  << std::setw(16) << "priority_queue" << std::setw(14) << "std:: heap" << std::setw(12) << "4-ary" << std::setw(12) << "8-ary" << "\n";
+
+	const char * names[] = { "build", "push", "batch push", "pop", "hold", "decrease-key" };
+
+	for (std::size_t size : benchmark_sizes(max_size)) {
+		std::vector<double> times(size), delays(size);
+		random_fill(times, 0.0, 1000.0, seed);
+		random_fill(delays, 0.0, 10.0, seed + 1);
+		const std::size_t repeats = std::max<std::size_t>(1, 10000000 / size);
+
+		for (heap_operation op : { heap_operation::build, heap_operation::push, heap_operation::batch_push,
+					   heap_operation::pop, heap_operation::hold, heap_operation::decrease_key }) {
+			double checks[4] = { 0, 0, 0, 0 };
+			double columns[4];
+			if (op == heap_operation::decrease_key) {
+				columns[0] = ns_per_element(size * repeats, [&] { checks[0] = run_decrease_key_lazy(times, delays, repeats); });
+				columns[1] = -1;
+				columns[2] = ns_per_element(size * repeats, [&] { checks[2] = run_decrease_key<4>(times, delays, repeats); });
+				columns[3] = ns_per_element(size * repeats, [&] { checks[3] = run_decrease_key<8>(times, delays, repeats); });
+				checks[1] = checks[0];
+			}
+			else {
+				columns[0] = ns_per_element(size * repeats, [&] {
+					checks[0] = run_heap<std::priority_queue<double, std::vector<double>, earliest_first>>(op, times, delays, repeats);
+				});
+				columns[1] = ns_per_element(size * repeats, [&] {
+					checks[1] = run_heap<std_heap_algorithms<double, earliest_first>>(op, times, delays, repeats);
+				});
+				columns[2] = ns_per_element(size * repeats, [&] {
+					checks[2] = run_heap<dary_heap<double, 4, earliest_first>>(op, times, delays, repeats);
+				});
+				columns[3] = ns_per_element(size * repeats, [&] {
+					checks[3] = run_heap<dary_heap<double, 8, earliest_first>>(op, times, delays, repeats);
+				});
+			}
+
+			std::cout << std::fixed << std::setprecision(3)
+				  << std::setw(14) << names[int(op)] << std::setw(12) << size << std::setw(16) << columns[0];
+			if (columns[1] < 0)
+				std::cout << std::setw(14) << "-";
+			else
+				std::cout << std::setw(14) << columns[1];
+			std::cout << std::setw(12) << columns[2] << std::setw(12) << columns[3] << "\n";
+
+			if (checks[1] != checks[0] || checks[2] != checks[0] || checks[3] != checks[0]) {
+				std::cerr << names[int(op)] << ": the heaps disagree at size " << size << "\n";
+				agree = false;
+			}
+		}
+	}
+	return agree;
+}
+
+
+int main(int argc, char * argv[]) {
+
+	std::size_t max_size = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+	const std::uint64_t seed = 42;
+
+
+	// 1. Set operations
+
+	std::cout << "set kernels dispatch to " << simd_level_name(simd_set_kernels<std::uint32_t>::best().level) << "\n";
+
+	if (!benchmark_sets<std::uint32_t>("uint32", max_size, seed))
+		return 1;
+	if (!benchmark_sets<std::uint64_t>("uint64", max_size, seed))
+		return 1;
+
+
+	// 2. Compressed bitmaps
+
+	if (!benchmark_bitmaps(max_size, seed))
+		return 1;
+
+
+	// 3. Parallel set operations
+
+	if (!benchmark_parallel_sets(max_size, seed))
+		return 1;
+
+
+	// 4. Priority queues
+
+	if (!benchmark_heaps(max_size, seed))
+		return 1;
+
+	return 0;
+}
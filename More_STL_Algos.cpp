@@ -16,6 +16,11 @@
 #include <utility> 
 #include <cctype>
 
+#include "Dary_Heap.h"
+#include "Parallel_Algorithms.h"
+#include "Roaring_Bitmap.h"
+#include "Simd_Set_Ops.h"
+
 
 int main() {
 
@@ -93,6 +98,82 @@ int main() {
 
 
 
+		// v. The same with the set kernels (Simd_Set_Ops.h)
+
+	// For strictly increasing 32- or 64-bit integers: vector block compares instead of a branch
+	// per element, galloping when one set is much larger, and the output sized exactly
+	std::vector<int> fastIntersection, fastUnion, fastDifference;
+	const int * first1 = set1.data(), * last1 = set1.data() + set1.size();
+	const int * first2 = set2.data(), * last2 = set2.data() + set2.size();
+	simd_set_intersection(first1, last1, first2, last2, fastIntersection);
+	simd_set_union(first1, last1, first2, last2, fastUnion);
+	simd_set_difference(first1, last1, first2, last2, fastDifference);
+
+	if (fastIntersection == setIntersection && fastUnion == setUnion && fastDifference == setDifference)
+		std::cout << "The set kernels agree with std::set_intersection, set_union and set_difference\n";
+	std::cout << "Sizes only: " << simd_set_intersection_size(first1, last1, first2, last2) << " common, "
+		  << simd_set_union_size(first1, last1, first2, last2) << " in the union\n\n";
+
+	// Many sets at once, starting from the smallest
+	std::vector<int> set3 = { 2, 4, 5, 8 };
+	std::vector<int> inAllThree;
+	simd_set_intersection(std::vector<std::vector<int>>{ set1, set2, set3 }, inAllThree);
+
+	std::cout << "Intersection of set1, set2 and { 2, 4, 5, 8 }:\n";
+	for (const int & elem : inAllThree)
+		std::cout << elem << " ";
+	std::cout << "\n\n";
+
+
+
+		// vi. The same with compressed bitmaps (Roaring_Bitmap.h)
+
+	// For sets of non-negative 32-bit values, dense or clustered: every block of 65536 values is
+	// an array, a bitmap or a list of runs, and bitmaps combine 64 values per instruction
+	const roaring_bitmap bits1(set1.begin(), set1.end()), bits2(set2.begin(), set2.end());
+	const roaring_bitmap bitsIntersection = bits1 & bits2, bitsUnion = bits1 | bits2, bitsDifference = bits1 - bits2;
+
+	if (std::vector<int>(bitsIntersection.begin(), bitsIntersection.end()) == setIntersection
+		&& std::vector<int>(bitsUnion.begin(), bitsUnion.end()) == setUnion
+		&& std::vector<int>(bitsDifference.begin(), bitsDifference.end()) == setDifference)
+		std::cout << "The bitmaps agree with std::set_intersection, set_union and set_difference\n";
+	std::cout << "Sizes only: " << intersection_size(bits1, bits2) << " common, " << union_size(bits1, bits2) << " in the union\n";
+
+	// A million consecutive ids: 4 MB in a vector, a few runs once run_optimize()d
+	std::vector<int> ids(1000000);
+	std::iota(ids.begin(), ids.end(), 0);
+	roaring_bitmap idBits(ids.begin(), ids.end());
+	std::cout << "1000000 consecutive ids: " << ids.size() * sizeof(int) << " bytes in a vector, "
+		  << idBits.memory_bytes() << " as bitmaps, ";
+	idBits.run_optimize();
+	std::cout << idBits.memory_bytes() << " as runs\n\n";
+
+
+
+		// vii. In parallel (Parallel_Algorithms.h)
+
+	// The inputs are cut where the merge of the two passes balanced diagonals, never between equal
+	// values; every thread counts its part of the output, then writes it at its offset. Repeated
+	// values come out as from std::: here min, max and difference of the counts of 3 and 5
+	std::vector<int> multiset1 = { 1, 3, 3, 3, 5, 5, 7 };
+	std::vector<int> multiset2 = { 3, 5, 5, 5, 6 };
+	std::vector<int> parallelUnion(multiset1.size() + multiset2.size());
+	parallelUnion.erase(parallel::set_union(parallel::par.with_grain(4), multiset1.begin(), multiset1.end(),
+						multiset2.begin(), multiset2.end(), parallelUnion.begin()), parallelUnion.end());
+	std::vector<int> parallelDifference(multiset1.size());
+	parallelDifference.erase(parallel::set_difference(parallel::par.with_grain(4), multiset1.begin(), multiset1.end(),
+							  multiset2.begin(), multiset2.end(), parallelDifference.begin()), parallelDifference.end());
+
+	std::cout << "Parallel union of { 1 3 3 3 5 5 7 } and { 3 5 5 5 6 }:\n";
+	for (const int & elem : parallelUnion)
+		std::cout << elem << " ";
+	std::cout << "\nParallel difference:\n";
+	for (const int & elem : parallelDifference)
+		std::cout << elem << " ";
+	std::cout << "\n\n";
+
+
+
 
 
 	
@@ -179,6 +260,29 @@ int main() {
 	}
 
 
+		// v. The same as a priority queue on a 4-ary heap (Dary_Heap.h)
+
+	// Four children per node, in one cache line: half the depth of the binary heap above
+	// Built in O(n), pushed in batches, popped several at a time
+	dary_heap<int> queue(std::begin(values), std::end(values));
+	const std::vector<int> more = { 11, -1, 7 };
+	queue.push(more.begin(), more.end());
+
+	std::cout << "Popping the 5 largest of the heap and { 11, -1, 7 }:\n";
+	queue.pop(5, std::ostream_iterator<int>(std::cout, " "));
+	std::cout << "\n" << queue.size() << " left\n\n";
+
+	// With handles: a min-heap of job deadlines, one handle per job, to move a deadline earlier
+	indexed_dary_heap<int, 4, std::greater<int>> deadlines;
+	const std::size_t backup = deadlines.push(30), report = deadlines.push(20);
+	deadlines.push(25);
+	deadlines.decrease_key(backup, 10);
+	std::cout << "Earliest deadline: " << deadlines.top() << (deadlines.top_handle() == backup ? " (backup)" : "") << "\n";
+	deadlines.pop();
+	deadlines.erase(report);
+	std::cout << "Then: " << deadlines.top() << "\n\n";
+
+
 
 	// 3. String operations
 	std::cout << "\n\n*** String operations ***\n\n";
@@ -0,0 +1,368 @@
+/*
+ *	Order Statistics
+ *
+ *	Exact k-th smallest values and medians
+ *
+ *	- introselect: quickselect with the introsort pivots and a Hoare
+ *	  partition that splits runs of equal keys evenly, falling back to
+ *	  heapsort after 2 lg n unbalanced levels, so duplicates and adversarial
+ *	  inputs stay O(n lg n) in the worst case
+ *	- multiselect: several ranks in one call; every partition sends each
+ *	  requested rank to its side, so k ranks cost O(n lg k) instead of k
+ *	  separate selections
+ *	- nth and median read a const range and select on a copy; the
+ *	  *_in_place variants reorder the caller's range instead
+ *	- parallel_nth does not copy the whole input: a sample brackets every
+ *	  requested rank between two splitters, one parallel pass counts the
+ *	  values in every bracket, a second gathers the values of the brackets
+ *	  holding the ranks, and only those are selected. A bad sample (e.g.
+ *	  massive duplicates) only makes the gathered part larger.
+ *
+ *	An even count has two middle values; median() returns their mean.
+ *
+ *	Musser, "Introspective Sorting and Selection Algorithms", 1997
+ *	Floyd and Rivest, "Expected Time Bounds for Selection", 1975 (sampling)
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include "Introsort.h"
+#include "Random_Fill.h"
+#include "Thread_Pool.h"
+
+
+namespace order_statistics_detail {
+
+	// Hoare partition around the pivot in *first, which ends at the returned position:
+	// [first, pivot) <= pivot <= (pivot, last)
+	// Both scans stop on keys equal to the pivot, so runs of duplicates split evenly
+	template <class RandomIt, class Compare>
+	RandomIt partition_pivot(RandomIt first, RandomIt last, Compare comp) {
+		RandomIt i = first, j = last;
+		for (;;) {
+			do ++i; while (i != last && comp(*i, *first));
+			do --j; while (comp(*first, *j));	// *first stops this scan
+			if (!(i < j))
+				break;
+			std::iter_swap(i, j);
+		}
+		std::iter_swap(first, j);
+		return j;
+	}
+
+	// Place the values of ranks [rank_first, rank_last) (sorted, relative to 'first')
+	// at their sorted positions; any other value may end up anywhere in the range
+	template <class RandomIt, class Compare>
+	void multiselect_loop(RandomIt first, RandomIt last, const std::size_t * rank_first, const std::size_t * rank_last,
+			      std::size_t offset, int depth_limit, Compare comp) {
+
+		while (rank_first != rank_last) {
+
+			if (last - first <= introsort_detail::insertion_threshold) {
+				introsort_detail::insertion_sort(first, last, comp);
+				return;
+			}
+
+			// Too many unbalanced partitions: sorting the rest bounds the cost
+			if (depth_limit-- == 0) {
+				std::make_heap(first, last, comp);
+				std::sort_heap(first, last, comp);
+				return;
+			}
+
+			introsort_detail::choose_pivot(first, last, comp);
+			const RandomIt pivot = partition_pivot(first, last, comp);
+
+			// Ranks below the pivot go left, ranks past it go right, the pivot's own rank is done
+			const std::size_t pivot_rank = offset + std::size_t(pivot - first);
+			const std::size_t * left_last = std::lower_bound(rank_first, rank_last, pivot_rank);
+			const std::size_t * right_first = std::upper_bound(left_last, rank_last, pivot_rank);
+
+			// Recurse into the smaller side and loop on the larger one: O(lg n) stack
+			if (pivot - first < last - pivot) {
+				if (rank_first != left_last)
+					multiselect_loop(first, pivot, rank_first, left_last, offset, depth_limit, comp);
+				offset = pivot_rank + 1;
+				first = pivot + 1;
+				rank_first = right_first;
+			}
+			else {
+				if (right_first != rank_last)
+					multiselect_loop(pivot + 1, last, right_first, rank_last, pivot_rank + 1, depth_limit, comp);
+				last = pivot;
+				rank_last = left_last;
+			}
+		}
+	}
+
+	inline void check_ranks(const std::vector<std::size_t> & ranks, std::size_t n) {
+		for (std::size_t rank : ranks)
+			if (rank >= n)
+				throw std::out_of_range("order statistics: rank out of range");
+	}
+
+	// Sorted, without duplicates
+	inline std::vector<std::size_t> sorted_ranks(std::vector<std::size_t> ranks) {
+		std::sort(ranks.begin(), ranks.end());
+		ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+		return ranks;
+	}
+}
+
+
+// Drop-in for std::nth_element
+// O(n) expected, O(n lg n) worst case
+template <class RandomIt, class Compare>
+void introselect(RandomIt first, RandomIt nth, RandomIt last, Compare comp) {
+	if (nth == last || last - first < 2)
+		return;
+	const std::size_t rank = std::size_t(nth - first);
+	order_statistics_detail::multiselect_loop(first, last, &rank, &rank + 1, 0,
+						  2 * introsort_detail::log2_floor(std::size_t(last - first)), comp);
+}
+
+template <class RandomIt>
+void introselect(RandomIt first, RandomIt nth, RandomIt last) {
+	introselect(first, nth, last, std::less<typename std::iterator_traits<RandomIt>::value_type>());
+}
+
+
+// Reorder [first, last) so that first[k] is the k-th smallest value for every k in
+// [rank_first, rank_last), which must be in ascending order and below n
+// O(n lg k) expected for k distinct ranks, no allocation
+template <class RandomIt, class Compare>
+void multiselect(RandomIt first, RandomIt last, const std::size_t * rank_first, const std::size_t * rank_last, Compare comp) {
+	const std::size_t n = std::size_t(last - first);
+	if (n > 1 && rank_first != rank_last)
+		order_statistics_detail::multiselect_loop(first, last, rank_first, rank_last, 0, 2 * introsort_detail::log2_floor(n), comp);
+}
+
+template <class RandomIt>
+void multiselect(RandomIt first, RandomIt last, const std::size_t * rank_first, const std::size_t * rank_last) {
+	multiselect(first, last, rank_first, rank_last, std::less<typename std::iterator_traits<RandomIt>::value_type>());
+}
+
+// The same for ranks in any order; throws std::out_of_range for a rank >= n
+template <class RandomIt, class Compare>
+void multiselect(RandomIt first, RandomIt last, const std::vector<std::size_t> & ranks, Compare comp) {
+	order_statistics_detail::check_ranks(ranks, std::size_t(last - first));
+
+	const std::vector<std::size_t> sorted = order_statistics_detail::sorted_ranks(ranks);
+	multiselect(first, last, sorted.data(), sorted.data() + sorted.size(), comp);
+}
+
+template <class RandomIt>
+void multiselect(RandomIt first, RandomIt last, const std::vector<std::size_t> & ranks) {
+	multiselect(first, last, ranks, std::less<typename std::iterator_traits<RandomIt>::value_type>());
+}
+
+
+// The k-th smallest values of a const range, in the order of 'ranks'
+// Selects on one copy of the range; the caller's values are not reordered
+template <class Value>
+std::vector<Value> nth(const Value * first, const Value * last, const std::vector<std::size_t> & ranks) {
+	std::vector<Value> work(first, last);
+	multiselect(work.begin(), work.end(), ranks);
+
+	std::vector<Value> result;
+	result.reserve(ranks.size());
+	for (std::size_t rank : ranks)
+		result.push_back(work[rank]);
+	return result;
+}
+
+template <class Value>
+Value nth(const Value * first, const Value * last, std::size_t rank) {
+	return nth(first, last, std::vector<std::size_t>(1, rank))[0];
+}
+
+template <class Value>
+std::vector<Value> nth(const std::vector<Value> & values, const std::vector<std::size_t> & ranks) {
+	return nth(values.data(), values.data() + values.size(), ranks);
+}
+
+template <class Value>
+Value nth(const std::vector<Value> & values, std::size_t rank) {
+	return nth(values.data(), values.data() + values.size(), rank);
+}
+
+
+// Ranks of the middle values: one for an odd count, two for an even count
+inline std::vector<std::size_t> median_ranks(std::size_t n) {
+	if (n == 0)
+		throw std::domain_error("median: no values");
+	std::vector<std::size_t> ranks(1, (n - 1) / 2);
+	if (n % 2 == 0)
+		ranks.push_back(n / 2);
+	return ranks;
+}
+
+// Median of a const range, O(n) expected; throws std::domain_error when empty
+template <class Value>
+double median(const Value * first, const Value * last) {
+	const std::vector<std::size_t> ranks = median_ranks(std::size_t(last - first));
+	const std::vector<Value> middle = nth(first, last, ranks);
+	return (double(middle.front()) + double(middle.back())) / 2;
+}
+
+template <class Value>
+double median(const std::vector<Value> & values) {
+	return median(values.data(), values.data() + values.size());
+}
+
+// Median without a copy: [first, last) is reordered
+template <class RandomIt>
+double median_in_place(RandomIt first, RandomIt last) {
+	const std::vector<std::size_t> ranks = median_ranks(std::size_t(last - first));
+	multiselect(first, last, ranks);
+	return (double(first[ranks.front()]) + double(first[ranks.back()])) / 2;
+}
+
+
+// Inputs below this size per thread are selected on a copy
+const std::size_t parallel_select_grain = std::size_t(1) << 18;
+
+
+namespace order_statistics_detail {
+
+	// Bracket every rank with sampled splitters, count, gather the values
+	// of the brackets holding the ranks and select there
+	template <class Value>
+	std::vector<Value> sampled_select(const Value * first, std::size_t n, const std::vector<std::size_t> & ranks,
+					  work_stealing_pool & pool) {
+
+		const std::size_t sample_size = 1 << 16;
+		const std::size_t margin = 1024;	// 8 standard deviations of a sampled rank or more
+		const std::size_t blocks = 4 * pool.size();
+
+		// 1. Sorted pseudo-random sample
+		std::vector<Value> sample(sample_size);
+		std::uint64_t state = n;
+		for (Value & value : sample)
+			value = first[std::size_t(splitmix64(state) % n)];
+		introsort(sample.begin(), sample.end());
+
+		// 2. Two splitters per rank: value x lies in bucket b when splitters[b - 1] <= x < splitters[b]
+		std::vector<Value> splitters;
+		for (std::size_t rank : ranks) {
+			const std::size_t position = std::size_t(double(rank) / double(n) * double(sample_size));
+			splitters.push_back(sample[position > margin ? position - margin : 0]);
+			splitters.push_back(sample[std::min(sample_size - 1, position + margin)]);
+		}
+		introsort(splitters.begin(), splitters.end());
+		const std::size_t buckets = splitters.size() + 1;
+
+		auto bucket_of = [&](const Value & value) {
+			return std::size_t(std::upper_bound(splitters.begin(), splitters.end(), value) - splitters.begin());
+		};
+		auto block_begin = [&](std::size_t block) { return n * block / blocks; };
+
+		// 3. Count every bucket in every block, in parallel
+		std::vector<std::size_t> counts(blocks * buckets, 0);
+		{
+			task_group group(pool);
+			for (std::size_t k = 0; k < blocks; ++k)
+				group.run([&, k] {
+					std::size_t * local = &counts[k * buckets];
+					for (std::size_t i = block_begin(k); i < block_begin(k + 1); ++i)
+						++local[bucket_of(first[i])];
+				});
+			group.wait();
+		}
+
+		std::vector<std::size_t> below(buckets + 1, 0);	// values in buckets before b
+		for (std::size_t b = 0; b < buckets; ++b) {
+			below[b + 1] = below[b];
+			for (std::size_t k = 0; k < blocks; ++k)
+				below[b + 1] += counts[k * buckets + b];
+		}
+
+		// 4. The buckets holding a requested rank
+		std::vector<char> wanted(buckets, 0);
+		for (std::size_t rank : ranks)
+			wanted[std::size_t(std::upper_bound(below.begin(), below.end(), rank) - below.begin()) - 1] = 1;
+
+		// Gathered layout: wanted buckets back to back, in bucket order
+		std::vector<std::size_t> gathered_first(buckets + 1, 0);
+		for (std::size_t b = 0; b < buckets; ++b)
+			gathered_first[b + 1] = gathered_first[b] + (wanted[b] ? below[b + 1] - below[b] : 0);
+
+		// Exclusive offsets per block inside each wanted bucket, so the gather needs no locks
+		for (std::size_t b = 0; b < buckets; ++b) {
+			std::size_t offset = gathered_first[b];
+			for (std::size_t k = 0; k < blocks; ++k) {
+				const std::size_t count = counts[k * buckets + b];
+				counts[k * buckets + b] = offset;
+				offset += count;
+			}
+		}
+
+		// 5. Gather the values of the wanted buckets, in parallel
+		std::vector<Value> gathered(gathered_first[buckets]);
+		{
+			task_group group(pool);
+			for (std::size_t k = 0; k < blocks; ++k)
+				group.run([&, k] {
+					std::size_t * next = &counts[k * buckets];
+					for (std::size_t i = block_begin(k); i < block_begin(k + 1); ++i) {
+						const std::size_t b = bucket_of(first[i]);
+						if (wanted[b])
+							gathered[next[b]++] = first[i];
+					}
+				});
+			group.wait();
+		}
+
+		// 6. Select inside each wanted bucket; buckets are ordered, so the
+		// rank inside the bucket is the global rank minus the values below it
+		std::vector<Value> result(ranks.size());
+		for (std::size_t b = 0; b < buckets; ++b) {
+			if (!wanted[b])
+				continue;
+			std::vector<std::size_t> local;
+			for (std::size_t rank : ranks)
+				if (rank >= below[b] && rank < below[b + 1])
+					local.push_back(rank - below[b]);
+
+			auto bucket_first = gathered.begin() + gathered_first[b];
+			multiselect(bucket_first, gathered.begin() + gathered_first[b + 1], local);
+
+			for (std::size_t i = 0; i < ranks.size(); ++i)
+				if (ranks[i] >= below[b] && ranks[i] < below[b + 1])
+					result[i] = bucket_first[ranks[i] - below[b]];
+		}
+		return result;
+	}
+}
+
+
+// nth() for very large arrays, on the pool
+// O(n lg k / threads) expected, reads the input twice and copies only the
+// values near the requested ranks; the same result as nth()
+template <class Value>
+std::vector<Value> parallel_nth(const Value * first, const Value * last, const std::vector<std::size_t> & ranks,
+				work_stealing_pool & pool = work_stealing_pool::shared()) {
+	const std::size_t n = std::size_t(last - first);
+	order_statistics_detail::check_ranks(ranks, n);
+
+	if (ranks.empty() || pool.size() <= 1 || n < parallel_select_grain * pool.size())
+		return nth(first, last, ranks);
+	return order_statistics_detail::sampled_select(first, n, ranks, pool);
+}
+
+template <class Value>
+double parallel_median(const Value * first, const Value * last, work_stealing_pool & pool = work_stealing_pool::shared()) {
+	const std::vector<std::size_t> ranks = median_ranks(std::size_t(last - first));
+	const std::vector<Value> middle = parallel_nth(first, last, ranks, pool);
+	return (double(middle.front()) + double(middle.back())) / 2;
+}
@@ -0,0 +1,688 @@
+/*
+ *	Parallel Elementary Algorithms
+ *
+ *	for_each, transform, find_if, copy_if, set_intersection, set_union,
+ *	set_difference, accumulate and transform_reduce with the call shapes
+ *	of the C++17 parallel algorithms: the first argument is a policy
+ *	object, parallel::seq or parallel::par. The parallel versions run on
+ *	the work-stealing thread pool and need no external runtime.
+ *
+ *	The range is cut into chunks of 'grain' elements, and the pool's workers
+ *	claim chunks in ascending order. The chunks depend only on the size of
+ *	the range and the grain, never on the number of threads or on timing:
+ *
+ *	- accumulate and transform_reduce reduce every chunk left to right and
+ *	  combine the partial results in chunk order, so they return the same
+ *	  bits on every run and for every pool size. Like std::reduce, op must
+ *	  be associative; for floating point the result may differ in the last
+ *	  bits from std::accumulate, which is one long left-to-right chain
+ *	- find_if returns the first match; chunks past a match already found
+ *	  are skipped, and a chunk being scanned stops once an earlier match
+ *	  turns up
+ *	- copy_if counts the matches per chunk, takes a prefix sum and scatters
+ *	  every chunk to its own offset, so the output is in input order
+ *	- the set operations cut both inputs along their merge path: the
+ *	  boundary of chunk c lies on diagonal c * grain of the merge, moved
+ *	  back to the first element of its value in both inputs, so that all
+ *	  the equivalent elements of either input fall into one chunk. Every
+ *	  chunk runs the std:: algorithm once to count its output and, after a
+ *	  prefix sum, once more to write it at its own offset. The output is
+ *	  that of the std:: algorithm, duplicates included: min(m, n) copies
+ *	  of a value in the intersection, max(m, n) in the union, m - n in the
+ *	  difference, taken from the same input positions. A value repeated
+ *	  across many chunks makes one chunk that large
+ *
+ *	Parallel execution needs random access iterators (and a random access
+ *	output for copy_if and the set operations); other iterators, and
+ *	ranges of a single chunk, run sequentially. Function objects are
+ *	copied once per chunk.
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Thread_Pool.h"
+
+
+// Ranges below this size are not worth a task
+const std::size_t parallel_algorithms_grain = std::size_t(1) << 14;
+
+
+namespace parallel {
+
+	// Run on the calling thread, exactly as the std:: algorithm
+	struct sequenced_policy {};
+
+	// Run on a work-stealing pool, 'grain' elements per chunk
+	struct parallel_policy {
+		work_stealing_pool * pool_ptr;
+		std::size_t grain;
+
+		work_stealing_pool & pool() const { return pool_ptr ? *pool_ptr : work_stealing_pool::shared(); }
+
+		// The same policy on another pool
+		parallel_policy on(work_stealing_pool & other) const { return parallel_policy{ &other, grain }; }
+
+		// The same policy with another chunk size; it fixes the result of the reductions
+		parallel_policy with_grain(std::size_t size) const { return parallel_policy{ pool_ptr, std::max<std::size_t>(1, size) }; }
+	};
+
+	const sequenced_policy seq = {};
+	const parallel_policy par = { nullptr, parallel_algorithms_grain };
+
+
+	namespace detail {
+
+		template <class Iterator>
+		struct is_random_access : std::is_base_of<std::random_access_iterator_tag,
+			typename std::iterator_traits<Iterator>::iterator_category> {};
+
+		// std::true_type when every iterator is random access: the chunked versions apply
+		template <class It1, class It2 = It1, class It3 = It1>
+		struct random_access : std::integral_constant<bool,
+			is_random_access<It1>::value && is_random_access<It2>::value && is_random_access<It3>::value> {};
+
+		inline std::size_t chunk_count(std::size_t n, std::size_t grain) {
+			return (n + grain - 1) / grain;
+		}
+
+		// Call body(c) for every chunk c < chunks; workers claim chunks in ascending order
+		// The calling thread helps, so this may be nested in a task of the same pool
+		template <class Body>
+		void run_chunks(const parallel_policy & policy, std::size_t chunks, Body body) {
+			if (chunks == 1) {
+				body(std::size_t(0));
+				return;
+			}
+
+			work_stealing_pool & pool = policy.pool();
+			std::atomic<std::size_t> next{ 0 };
+
+			task_group group(pool);
+			const std::size_t tasks = std::min<std::size_t>(chunks, pool.size());
+			for (std::size_t t = 0; t < tasks; ++t)
+				group.run([&] {
+					for (std::size_t c = next++; c < chunks; c = next++)
+						body(c);
+				});
+			group.wait();
+		}
+
+		// Lower 'target' to 'value' unless it is already lower
+		inline void store_min(std::atomic<std::size_t> & target, std::size_t value) {
+			std::size_t current = target.load();
+			while (value < current && !target.compare_exchange_weak(current, value)) {}
+		}
+
+		// Elements scanned between two looks at the cancellation flag of find_if
+		const std::size_t find_block = 256;
+
+	}
+
+
+	/** for_each ***/
+
+	template <class InputIt, class Function>
+	void for_each(const sequenced_policy &, InputIt first, InputIt last, Function f) {
+		std::for_each(first, last, f);
+	}
+
+	namespace detail {
+
+		template <class InputIt, class Function>
+		void for_each(const parallel_policy &, InputIt first, InputIt last, Function f, std::false_type) {
+			std::for_each(first, last, f);
+		}
+
+		template <class RandomIt, class Function>
+		void for_each(const parallel_policy & policy, RandomIt first, RandomIt last, Function f, std::true_type) {
+			const std::size_t n = std::size_t(last - first);
+			if (n == 0)
+				return;
+			run_chunks(policy, chunk_count(n, policy.grain), [&](std::size_t c) {
+				const std::size_t begin = c * policy.grain, end = std::min(n, begin + policy.grain);
+				std::for_each(first + begin, first + end, f);
+			});
+		}
+
+	}
+
+	// O(n / p)
+	template <class InputIt, class Function>
+	void for_each(const parallel_policy & policy, InputIt first, InputIt last, Function f) {
+		detail::for_each(policy, first, last, f, detail::random_access<InputIt>());
+	}
+
+
+	/** transform ***/
+
+	template <class InputIt, class OutputIt, class UnaryOperation>
+	OutputIt transform(const sequenced_policy &, InputIt first, InputIt last, OutputIt d_first, UnaryOperation op) {
+		return std::transform(first, last, d_first, op);
+	}
+
+	template <class InputIt1, class InputIt2, class OutputIt, class BinaryOperation>
+	OutputIt transform(const sequenced_policy &, InputIt1 first1, InputIt1 last1, InputIt2 first2, OutputIt d_first, BinaryOperation op) {
+		return std::transform(first1, last1, first2, d_first, op);
+	}
+
+	namespace detail {
+
+		template <class InputIt, class OutputIt, class UnaryOperation>
+		OutputIt transform(const parallel_policy &, InputIt first, InputIt last, OutputIt d_first, UnaryOperation op, std::false_type) {
+			return std::transform(first, last, d_first, op);
+		}
+
+		template <class RandomIt, class RandomOutputIt, class UnaryOperation>
+		RandomOutputIt transform(const parallel_policy & policy, RandomIt first, RandomIt last, RandomOutputIt d_first, UnaryOperation op, std::true_type) {
+			const std::size_t n = std::size_t(last - first);
+			if (n == 0)
+				return d_first;
+			run_chunks(policy, chunk_count(n, policy.grain), [&](std::size_t c) {
+				const std::size_t begin = c * policy.grain, end = std::min(n, begin + policy.grain);
+				std::transform(first + begin, first + end, d_first + begin, op);
+			});
+			return d_first + n;
+		}
+
+		template <class InputIt1, class InputIt2, class OutputIt, class BinaryOperation>
+		OutputIt transform(const parallel_policy &, InputIt1 first1, InputIt1 last1, InputIt2 first2, OutputIt d_first, BinaryOperation op, std::false_type) {
+			return std::transform(first1, last1, first2, d_first, op);
+		}
+
+		template <class RandomIt1, class RandomIt2, class RandomOutputIt, class BinaryOperation>
+		RandomOutputIt transform(const parallel_policy & policy, RandomIt1 first1, RandomIt1 last1, RandomIt2 first2, RandomOutputIt d_first,
+					 BinaryOperation op, std::true_type) {
+			const std::size_t n = std::size_t(last1 - first1);
+			if (n == 0)
+				return d_first;
+			run_chunks(policy, chunk_count(n, policy.grain), [&](std::size_t c) {
+				const std::size_t begin = c * policy.grain, end = std::min(n, begin + policy.grain);
+				std::transform(first1 + begin, first1 + end, first2 + begin, d_first + begin, op);
+			});
+			return d_first + n;
+		}
+
+	}
+
+	// O(n / p), d_first may equal first
+	template <class InputIt, class OutputIt, class UnaryOperation>
+	OutputIt transform(const parallel_policy & policy, InputIt first, InputIt last, OutputIt d_first, UnaryOperation op) {
+		return detail::transform(policy, first, last, d_first, op, detail::random_access<InputIt, OutputIt>());
+	}
+
+	// O(n / p)
+	template <class InputIt1, class InputIt2, class OutputIt, class BinaryOperation>
+	OutputIt transform(const parallel_policy & policy, InputIt1 first1, InputIt1 last1, InputIt2 first2, OutputIt d_first, BinaryOperation op) {
+		return detail::transform(policy, first1, last1, first2, d_first, op, detail::random_access<InputIt1, InputIt2, OutputIt>());
+	}
+
+
+	/** find_if ***/
+
+	template <class InputIt, class UnaryPredicate>
+	InputIt find_if(const sequenced_policy &, InputIt first, InputIt last, UnaryPredicate pred) {
+		return std::find_if(first, last, pred);
+	}
+
+	namespace detail {
+
+		template <class InputIt, class UnaryPredicate>
+		InputIt find_if(const parallel_policy &, InputIt first, InputIt last, UnaryPredicate pred, std::false_type) {
+			return std::find_if(first, last, pred);
+		}
+
+		template <class RandomIt, class UnaryPredicate>
+		RandomIt find_if(const parallel_policy & policy, RandomIt first, RandomIt last, UnaryPredicate pred, std::true_type) {
+			const std::size_t n = std::size_t(last - first);
+			if (n == 0)
+				return last;
+
+			// Index of the first match found so far, n while there is none
+			std::atomic<std::size_t> found{ n };
+
+			run_chunks(policy, chunk_count(n, policy.grain), [&](std::size_t c) {
+				const std::size_t begin = c * policy.grain, end = std::min(n, begin + policy.grain);
+				UnaryPredicate local = pred;
+
+				for (std::size_t block = begin; block < end; block += find_block) {
+					// An earlier chunk already has a match: nothing here can be first
+					if (found.load(std::memory_order_relaxed) < begin)
+						return;
+
+					const std::size_t block_end = std::min(end, block + find_block);
+					RandomIt match = std::find_if(first + block, first + block_end, local);
+					if (match != first + block_end) {
+						store_min(found, std::size_t(match - first));
+						return;
+					}
+				}
+			});
+			return first + found.load();
+		}
+
+	}
+
+	// The first element satisfying 'pred'
+	// O(n / p); O(m + grain p) when the first match is at m, as later chunks are cancelled
+	template <class InputIt, class UnaryPredicate>
+	InputIt find_if(const parallel_policy & policy, InputIt first, InputIt last, UnaryPredicate pred) {
+		return detail::find_if(policy, first, last, pred, detail::random_access<InputIt>());
+	}
+
+
+	/** copy_if ***/
+
+	template <class InputIt, class OutputIt, class UnaryPredicate>
+	OutputIt copy_if(const sequenced_policy &, InputIt first, InputIt last, OutputIt d_first, UnaryPredicate pred) {
+		return std::copy_if(first, last, d_first, pred);
+	}
+
+	namespace detail {
+
+		template <class InputIt, class OutputIt, class UnaryPredicate>
+		OutputIt copy_if(const parallel_policy &, InputIt first, InputIt last, OutputIt d_first, UnaryPredicate pred, std::false_type) {
+			return std::copy_if(first, last, d_first, pred);
+		}
+
+		template <class RandomIt, class RandomOutputIt, class UnaryPredicate>
+		RandomOutputIt copy_if(const parallel_policy & policy, RandomIt first, RandomIt last, RandomOutputIt d_first, UnaryPredicate pred, std::true_type) {
+			const std::size_t n = std::size_t(last - first);
+			const std::size_t chunks = chunk_count(n, policy.grain);
+			if (chunks <= 1)
+				return std::copy_if(first, last, d_first, pred);
+
+			// 1. Test every element once and count the matches of every chunk
+			std::vector<unsigned char> selected(n);
+			std::vector<std::size_t> offsets(chunks + 1, 0);
+			run_chunks(policy, chunks, [&](std::size_t c) {
+				const std::size_t begin = c * policy.grain, end = std::min(n, begin + policy.grain);
+				UnaryPredicate local = pred;
+				std::size_t count = 0;
+				for (std::size_t i = begin; i < end; ++i) {
+					const bool keep = local(first[i]) ? true : false;
+					selected[i] = keep;
+					count += keep;
+				}
+				offsets[c + 1] = count;
+			});
+
+			// 2. Where every chunk starts in the output
+			std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+			// 3. Scatter, every chunk to its own slice
+			run_chunks(policy, chunks, [&](std::size_t c) {
+				const std::size_t begin = c * policy.grain, end = std::min(n, begin + policy.grain);
+				RandomOutputIt out = d_first + offsets[c];
+				for (std::size_t i = begin; i < end; ++i)
+					if (selected[i])
+						*out++ = first[i];
+			});
+			return d_first + offsets[chunks];
+		}
+
+	}
+
+	// Copies the elements satisfying 'pred' in input order; 'pred' is called once per element
+	// The output needs room for every match: a sized buffer, not a back_inserter (that runs sequentially)
+	// O(n / p + chunks) with n bytes of scratch space
+	template <class InputIt, class OutputIt, class UnaryPredicate>
+	OutputIt copy_if(const parallel_policy & policy, InputIt first, InputIt last, OutputIt d_first, UnaryPredicate pred) {
+		return detail::copy_if(policy, first, last, d_first, pred, detail::random_access<InputIt, OutputIt>());
+	}
+
+
+	/** set_intersection, set_union, set_difference ***/
+
+	template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+	OutputIt set_intersection(const sequenced_policy &, InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first, Compare comp) {
+		return std::set_intersection(first1, last1, first2, last2, d_first, comp);
+	}
+
+	template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+	OutputIt set_union(const sequenced_policy &, InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first, Compare comp) {
+		return std::set_union(first1, last1, first2, last2, d_first, comp);
+	}
+
+	template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+	OutputIt set_difference(const sequenced_policy &, InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first, Compare comp) {
+		return std::set_difference(first1, last1, first2, last2, d_first, comp);
+	}
+
+	template <class InputIt1, class InputIt2, class OutputIt>
+	OutputIt set_intersection(const sequenced_policy &, InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first) {
+		return std::set_intersection(first1, last1, first2, last2, d_first);
+	}
+
+	template <class InputIt1, class InputIt2, class OutputIt>
+	OutputIt set_union(const sequenced_policy &, InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first) {
+		return std::set_union(first1, last1, first2, last2, d_first);
+	}
+
+	template <class InputIt1, class InputIt2, class OutputIt>
+	OutputIt set_difference(const sequenced_policy &, InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first) {
+		return std::set_difference(first1, last1, first2, last2, d_first);
+	}
+
+	namespace detail {
+
+		// operator< between the elements of the two ranges, which may differ in type
+		struct less_than {
+			template <class T, class U>
+			bool operator()(const T & a, const U & b) const { return a < b; }
+		};
+
+		// An output iterator that only counts what is written through it
+		struct counting_output {
+			typedef std::output_iterator_tag iterator_category;
+			typedef void value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef void pointer;
+			typedef void reference;
+
+			std::size_t count;
+
+			counting_output & operator*() { return *this; }
+			counting_output & operator++() { return *this; }
+			counting_output & operator++(int) { return *this; }
+			template <class T>
+			counting_output & operator=(const T &) {
+				++count;
+				return *this;
+			}
+		};
+
+		// The set algorithms as function objects, to be run on every chunk
+		struct intersection_operation {
+			template <class It1, class It2, class OutputIt, class Compare>
+			OutputIt operator()(It1 first1, It1 last1, It2 first2, It2 last2, OutputIt d_first, Compare comp) const {
+				return std::set_intersection(first1, last1, first2, last2, d_first, comp);
+			}
+		};
+
+		struct union_operation {
+			template <class It1, class It2, class OutputIt, class Compare>
+			OutputIt operator()(It1 first1, It1 last1, It2 first2, It2 last2, OutputIt d_first, Compare comp) const {
+				return std::set_union(first1, last1, first2, last2, d_first, comp);
+			}
+		};
+
+		struct difference_operation {
+			template <class It1, class It2, class OutputIt, class Compare>
+			OutputIt operator()(It1 first1, It1 last1, It2 first2, It2 last2, OutputIt d_first, Compare comp) const {
+				return std::set_difference(first1, last1, first2, last2, d_first, comp);
+			}
+		};
+
+		// Where diagonal 'd' of the merge of the two ranges crosses them, elements of the first
+		// range taken first among equivalent ones; then moved back to the first element not less
+		// than the next one of the merge, in both ranges. The sequential algorithm reaches that
+		// pair of positions with nothing pending, whatever the operation
+		// O(lg n)
+		template <class RandomIt1, class RandomIt2, class Compare>
+		std::pair<std::size_t, std::size_t> merge_path_split(RandomIt1 first1, std::size_t n1, RandomIt2 first2, std::size_t n2,
+								     std::size_t d, Compare comp) {
+			std::size_t low = d > n2 ? d - n2 : 0, high = std::min(d, n1);
+			while (low < high) {
+				const std::size_t middle = low + (high - low) / 2;
+				if (!comp(first2[d - 1 - middle], first1[middle]))
+					low = middle + 1;
+				else
+					high = middle;
+			}
+			const std::size_t i = low, j = d - low;
+			if (i == n1 && j == n2)
+				return std::make_pair(i, j);
+			if (j == n2 || (i < n1 && !comp(first2[j], first1[i]))) {
+				const RandomIt1 split = first1 + std::ptrdiff_t(i);
+				return std::make_pair(std::size_t(std::lower_bound(first1, split, *split, comp) - first1),
+						      std::size_t(std::lower_bound(first2, first2 + std::ptrdiff_t(j), *split, comp) - first2));
+			}
+			const RandomIt2 split = first2 + std::ptrdiff_t(j);
+			return std::make_pair(std::size_t(std::lower_bound(first1, first1 + std::ptrdiff_t(i), *split, comp) - first1),
+					      std::size_t(std::lower_bound(first2, split, *split, comp) - first2));
+		}
+
+		template <class Operation, class InputIt1, class InputIt2, class OutputIt, class Compare>
+		OutputIt set_operation(const parallel_policy &, InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first,
+				       Compare comp, Operation operation, std::false_type) {
+			return operation(first1, last1, first2, last2, d_first, comp);
+		}
+
+		template <class Operation, class RandomIt1, class RandomIt2, class RandomOutputIt, class Compare>
+		RandomOutputIt set_operation(const parallel_policy & policy, RandomIt1 first1, RandomIt1 last1, RandomIt2 first2, RandomIt2 last2,
+					     RandomOutputIt d_first, Compare comp, Operation operation, std::true_type) {
+			const std::size_t n1 = std::size_t(last1 - first1), n2 = std::size_t(last2 - first2);
+			const std::size_t chunks = chunk_count(n1 + n2, policy.grain);
+
+			// On one worker the two passes below would only double the work
+			if (chunks <= 1 || policy.pool().size() == 1)
+				return operation(first1, last1, first2, last2, d_first, comp);
+
+			// 1. Cut both ranges along the merge path and count the output of every chunk
+			std::vector<std::pair<std::size_t, std::size_t>> splits(chunks + 1);
+			std::vector<std::size_t> offsets(chunks + 1, 0);
+			splits[chunks] = std::make_pair(n1, n2);
+			run_chunks(policy, chunks, [&](std::size_t c) {
+				splits[c] = merge_path_split(first1, n1, first2, n2, c * policy.grain, comp);
+			});
+			run_chunks(policy, chunks, [&](std::size_t c) {
+				offsets[c + 1] = operation(first1 + splits[c].first, first1 + splits[c + 1].first,
+							   first2 + splits[c].second, first2 + splits[c + 1].second, counting_output{ 0 }, comp).count;
+			});
+
+			// 2. Where every chunk starts in the output
+			std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+			// 3. Write, every chunk to its own slice
+			run_chunks(policy, chunks, [&](std::size_t c) {
+				operation(first1 + splits[c].first, first1 + splits[c + 1].first,
+					  first2 + splits[c].second, first2 + splits[c + 1].second, d_first + offsets[c], comp);
+			});
+			return d_first + offsets[chunks];
+		}
+
+	}
+
+	// The std:: set algorithms on sorted ranges, duplicates included; the output needs room for
+	// the whole result, as for copy_if, and may not overlap the inputs
+	// O((n1 + n2) / p + chunks lg (n1 + n2)), comparing every element twice
+	template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+	OutputIt set_intersection(const parallel_policy & policy, InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first, Compare comp) {
+		return detail::set_operation(policy, first1, last1, first2, last2, d_first, comp, detail::intersection_operation(),
+					     detail::random_access<InputIt1, InputIt2, OutputIt>());
+	}
+
+	template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+	OutputIt set_union(const parallel_policy & policy, InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first, Compare comp) {
+		return detail::set_operation(policy, first1, last1, first2, last2, d_first, comp, detail::union_operation(),
+					     detail::random_access<InputIt1, InputIt2, OutputIt>());
+	}
+
+	template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+	OutputIt set_difference(const parallel_policy & policy, InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first, Compare comp) {
+		return detail::set_operation(policy, first1, last1, first2, last2, d_first, comp, detail::difference_operation(),
+					     detail::random_access<InputIt1, InputIt2, OutputIt>());
+	}
+
+	template <class InputIt1, class InputIt2, class OutputIt>
+	OutputIt set_intersection(const parallel_policy & policy, InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first) {
+		return set_intersection(policy, first1, last1, first2, last2, d_first, detail::less_than());
+	}
+
+	template <class InputIt1, class InputIt2, class OutputIt>
+	OutputIt set_union(const parallel_policy & policy, InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first) {
+		return set_union(policy, first1, last1, first2, last2, d_first, detail::less_than());
+	}
+
+	template <class InputIt1, class InputIt2, class OutputIt>
+	OutputIt set_difference(const parallel_policy & policy, InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, OutputIt d_first) {
+		return set_difference(policy, first1, last1, first2, last2, d_first, detail::less_than());
+	}
+
+
+	/** accumulate ***/
+
+	template <class InputIt, class T>
+	T accumulate(const sequenced_policy &, InputIt first, InputIt last, T init) {
+		return std::accumulate(first, last, init);
+	}
+
+	template <class InputIt, class T, class BinaryOperation>
+	T accumulate(const sequenced_policy &, InputIt first, InputIt last, T init, BinaryOperation op) {
+		return std::accumulate(first, last, init, op);
+	}
+
+	namespace detail {
+
+		template <class InputIt, class T, class BinaryOperation>
+		T accumulate(const parallel_policy &, InputIt first, InputIt last, T init, BinaryOperation op, std::false_type) {
+			return std::accumulate(first, last, init, op);
+		}
+
+		template <class RandomIt, class T, class BinaryOperation>
+		T accumulate(const parallel_policy & policy, RandomIt first, RandomIt last, T init, BinaryOperation op, std::true_type) {
+			const std::size_t n = std::size_t(last - first);
+			const std::size_t chunks = chunk_count(n, policy.grain);
+			if (chunks <= 1)
+				return std::accumulate(first, last, init, op);
+
+			// Every chunk starts from its own first element
+			std::vector<T> partials(chunks, init);
+			run_chunks(policy, chunks, [&](std::size_t c) {
+				const std::size_t begin = c * policy.grain, end = std::min(n, begin + policy.grain);
+				partials[c] = std::accumulate(first + begin + 1, first + end, T(first[begin]), op);
+			});
+
+			// Combined in chunk order, independent of which thread finished first
+			return std::accumulate(partials.begin(), partials.end(), init, op);
+		}
+
+	}
+
+	// init combined with every element; op must be associative and accept (T, T) and (T, element)
+	// The same result on every run and pool size
+	// O(n / p + chunks)
+	template <class InputIt, class T, class BinaryOperation>
+	T accumulate(const parallel_policy & policy, InputIt first, InputIt last, T init, BinaryOperation op) {
+		return detail::accumulate(policy, first, last, init, op, detail::random_access<InputIt>());
+	}
+
+	template <class InputIt, class T>
+	T accumulate(const parallel_policy & policy, InputIt first, InputIt last, T init) {
+		return accumulate(policy, first, last, init, std::plus<T>());
+	}
+
+
+	/** transform_reduce ***/
+
+	template <class InputIt, class T, class BinaryReduction, class UnaryTransform>
+	T transform_reduce(const sequenced_policy &, InputIt first, InputIt last, T init, BinaryReduction reduce, UnaryTransform transform) {
+		for (; first != last; ++first)
+			init = reduce(init, transform(*first));
+		return init;
+	}
+
+	template <class InputIt1, class InputIt2, class T, class BinaryReduction, class BinaryTransform>
+	T transform_reduce(const sequenced_policy &, InputIt1 first1, InputIt1 last1, InputIt2 first2, T init,
+			   BinaryReduction reduce, BinaryTransform transform) {
+		for (; first1 != last1; ++first1, ++first2)
+			init = reduce(init, transform(*first1, *first2));
+		return init;
+	}
+
+	// Inner product
+	template <class InputIt1, class InputIt2, class T>
+	T transform_reduce(const sequenced_policy & policy, InputIt1 first1, InputIt1 last1, InputIt2 first2, T init) {
+		return transform_reduce(policy, first1, last1, first2, init, std::plus<T>(), std::multiplies<T>());
+	}
+
+	namespace detail {
+
+		template <class InputIt, class T, class BinaryReduction, class UnaryTransform>
+		T transform_reduce(const parallel_policy &, InputIt first, InputIt last, T init, BinaryReduction reduce, UnaryTransform transform, std::false_type) {
+			return parallel::transform_reduce(seq, first, last, init, reduce, transform);
+		}
+
+		template <class RandomIt, class T, class BinaryReduction, class UnaryTransform>
+		T transform_reduce(const parallel_policy & policy, RandomIt first, RandomIt last, T init, BinaryReduction reduce, UnaryTransform transform, std::true_type) {
+			const std::size_t n = std::size_t(last - first);
+			const std::size_t chunks = chunk_count(n, policy.grain);
+			if (chunks <= 1)
+				return parallel::transform_reduce(seq, first, last, init, reduce, transform);
+
+			std::vector<T> partials(chunks, init);
+			run_chunks(policy, chunks, [&](std::size_t c) {
+				const std::size_t begin = c * policy.grain, end = std::min(n, begin + policy.grain);
+				UnaryTransform local = transform;
+				T partial = T(local(first[begin]));
+				for (std::size_t i = begin + 1; i < end; ++i)
+					partial = reduce(partial, T(local(first[i])));
+				partials[c] = partial;
+			});
+
+			return std::accumulate(partials.begin(), partials.end(), init, reduce);
+		}
+
+		template <class InputIt1, class InputIt2, class T, class BinaryReduction, class BinaryTransform>
+		T transform_reduce(const parallel_policy &, InputIt1 first1, InputIt1 last1, InputIt2 first2, T init,
+				   BinaryReduction reduce, BinaryTransform transform, std::false_type) {
+			return parallel::transform_reduce(seq, first1, last1, first2, init, reduce, transform);
+		}
+
+		template <class RandomIt1, class RandomIt2, class T, class BinaryReduction, class BinaryTransform>
+		T transform_reduce(const parallel_policy & policy, RandomIt1 first1, RandomIt1 last1, RandomIt2 first2, T init,
+				   BinaryReduction reduce, BinaryTransform transform, std::true_type) {
+			const std::size_t n = std::size_t(last1 - first1);
+			const std::size_t chunks = chunk_count(n, policy.grain);
+			if (chunks <= 1)
+				return parallel::transform_reduce(seq, first1, last1, first2, init, reduce, transform);
+
+			std::vector<T> partials(chunks, init);
+			run_chunks(policy, chunks, [&](std::size_t c) {
+				const std::size_t begin = c * policy.grain, end = std::min(n, begin + policy.grain);
+				BinaryTransform local = transform;
+				T partial = T(local(first1[begin], first2[begin]));
+				for (std::size_t i = begin + 1; i < end; ++i)
+					partial = reduce(partial, T(local(first1[i], first2[i])));
+				partials[c] = partial;
+			});
+
+			return std::accumulate(partials.begin(), partials.end(), init, reduce);
+		}
+
+	}
+
+	// init reduced with transform(x) for every x; reduce must be associative
+	// The same result on every run and pool size
+	// O(n / p + chunks)
+	template <class InputIt, class T, class BinaryReduction, class UnaryTransform>
+	T transform_reduce(const parallel_policy & policy, InputIt first, InputIt last, T init, BinaryReduction reduce, UnaryTransform transform) {
+		return detail::transform_reduce(policy, first, last, init, reduce, transform, detail::random_access<InputIt>());
+	}
+
+	// init reduced with transform(x, y) for every pair
+	template <class InputIt1, class InputIt2, class T, class BinaryReduction, class BinaryTransform>
+	T transform_reduce(const parallel_policy & policy, InputIt1 first1, InputIt1 last1, InputIt2 first2, T init,
+			   BinaryReduction reduce, BinaryTransform transform) {
+		return detail::transform_reduce(policy, first1, last1, first2, init, reduce, transform, detail::random_access<InputIt1, InputIt2>());
+	}
+
+	// Inner product, the same result on every run and pool size
+	template <class InputIt1, class InputIt2, class T>
+	T transform_reduce(const parallel_policy & policy, InputIt1 first1, InputIt1 last1, InputIt2 first2, T init) {
+		return transform_reduce(policy, first1, last1, first2, init, std::plus<T>(), std::multiplies<T>());
+	}
+
+}
@@ -0,0 +1,81 @@
+/*
+ *	Parallel Stream Compaction
+ *
+ *	simd_copy_if of Simd_Compact.h on the thread pool: every chunk is
+ *	counted, a prefix sum gives each chunk its slice of the output, and
+ *	every chunk then compacts straight into its slice, so the selected
+ *	elements keep their input order
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+#include "Parallel_Algorithms.h"
+#include "Simd_Compact.h"
+
+
+namespace simd_compact_detail {
+
+	// Where every chunk's selected elements go: chunk c writes [offsets[c], offsets[c + 1])
+	template <class Value>
+	std::vector<std::size_t> chunk_offsets(const parallel::parallel_policy & policy, const Value * first, std::size_t n,
+					       std::size_t chunks, threshold_predicate<Value> pred) {
+		std::vector<std::size_t> offsets(chunks + 1, 0);
+		parallel::detail::run_chunks(policy, chunks, [&](std::size_t c) {
+			const std::size_t begin = c * policy.grain, end = std::min(n, begin + policy.grain);
+			offsets[c + 1] = count(first + begin, end - begin, pred);
+		});
+		std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+		return offsets;
+	}
+
+	// Every chunk compacts into its own slice, with full-width stores up to its last vector
+	template <class Value>
+	void scatter_chunks(const parallel::parallel_policy & policy, const Value * first, std::size_t n,
+			    const std::vector<std::size_t> & offsets, Value * d_first, threshold_predicate<Value> pred) {
+		parallel::detail::run_chunks(policy, offsets.size() - 1, [&](std::size_t c) {
+			const std::size_t begin = c * policy.grain, end = std::min(n, begin + policy.grain);
+			compact(first + begin, end - begin, d_first + offsets[c], offsets[c + 1] - offsets[c], pred);
+		});
+	}
+
+}
+
+
+// simd_copy_if on the thread pool: count per chunk, prefix sum, then every chunk
+// compacts into its own slice of the output, so the order is the input order
+// O(n / p + chunks)
+template <class Value>
+Value * simd_copy_if(const parallel::parallel_policy & policy, const Value * first, const Value * last, Value * d_first,
+		     threshold_predicate<Value> pred) {
+	const std::size_t n = std::size_t(last - first);
+	const std::size_t chunks = parallel::detail::chunk_count(n, policy.grain);
+	if (chunks <= 1)
+		return simd_copy_if(first, last, d_first, pred);
+
+	const std::vector<std::size_t> offsets = simd_compact_detail::chunk_offsets(policy, first, n, chunks, pred);
+	simd_compact_detail::scatter_chunks(policy, first, n, offsets, d_first, pred);
+	return d_first + offsets[chunks];
+}
+
+// Appends the selected elements to 'out', sized exactly, returns how many
+template <class Value>
+std::size_t simd_copy_if(const parallel::parallel_policy & policy, const Value * first, const Value * last, std::vector<Value> & out,
+			 threshold_predicate<Value> pred) {
+	const std::size_t n = std::size_t(last - first);
+	const std::size_t chunks = parallel::detail::chunk_count(n, policy.grain);
+	if (chunks <= 1)
+		return simd_copy_if(first, last, out, pred);
+
+	const std::vector<std::size_t> offsets = simd_compact_detail::chunk_offsets(policy, first, n, chunks, pred);
+	const std::size_t start = out.size();
+	out.resize(start + offsets[chunks]);
+	simd_compact_detail::scatter_chunks(policy, first, n, offsets, out.data() + start, pred);
+	return offsets[chunks];
+}
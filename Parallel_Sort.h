@@ -0,0 +1,182 @@
+/*
+ *	Parallel Sort
+ *
+ *	Task-parallel introsort on the work-stealing thread pool
+ *
+ *	- Ranges up to 'grain' elements are sorted sequentially with introsort
+ *	- Larger ranges are partitioned three-way; the smaller side becomes a
+ *	  new task and the current task keeps working on the larger side
+ *	- Very large ranges are first split into many buckets in parallel
+ *	  (one samplesort pass), so no single partitioning pass over the whole
+ *	  input stays on the critical path. This step needs an O(n) buffer and
+ *	  a default-constructible value type.
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+#include "Introsort.h"
+#include "Random_Fill.h"
+#include "Thread_Pool.h"
+
+
+// Ranges below this size are not worth a task
+const std::ptrdiff_t parallel_sort_grain = std::ptrdiff_t(1) << 15;
+
+
+namespace parallel_sort_detail {
+
+	template <class RandomIt, class Compare>
+	void quicksort_task(RandomIt first, RandomIt last, Compare comp, std::ptrdiff_t grain, int depth_limit, task_group & group) {
+		while (last - first > grain) {
+
+			// Unbalanced partitions: finish sequentially, introsort bounds the cost
+			if (depth_limit-- == 0)
+				break;
+
+			introsort_detail::choose_pivot(first, last, comp);
+			std::pair<RandomIt, RandomIt> equal = introsort_detail::partition3(first, last, comp);
+
+			// Give the smaller side away and keep the larger one
+			RandomIt side_first = first, side_last = equal.first;
+			if (equal.first - first < last - equal.second)
+				first = equal.second;
+			else {
+				side_first = equal.second;
+				side_last = last;
+				last = equal.first;
+			}
+
+			if (side_last - side_first > grain)
+				group.run([=, &group] { quicksort_task(side_first, side_last, comp, grain, depth_limit, group); });
+			else
+				introsort(side_first, side_last, comp);
+		}
+		introsort(first, last, comp);
+	}
+
+	// One parallel samplesort pass: scatter [first, last) into buckets
+	// bounded by sampled splitters, then sort every bucket as its own task
+	template <class RandomIt, class Compare>
+	void samplesort(RandomIt first, RandomIt last, Compare comp, std::ptrdiff_t grain, work_stealing_pool & pool) {
+
+		typedef typename std::iterator_traits<RandomIt>::value_type Value;
+
+		const std::size_t n = std::size_t(last - first);
+		const std::size_t buckets = std::min<std::size_t>(256, 8 * pool.size());
+		const std::size_t blocks = 4 * pool.size();
+		const std::size_t oversampling = 32;
+
+		// 1. Splitters from a pseudo-random sample, O(buckets lg buckets)
+		std::vector<Value> sample;
+		sample.reserve(buckets * oversampling);
+		std::uint64_t state = n;
+		for (std::size_t i = 0; i < buckets * oversampling; ++i)
+			sample.push_back(first[std::size_t(splitmix64(state) % n)]);
+		introsort(sample.begin(), sample.end(), comp);
+
+		std::vector<Value> splitters;
+		for (std::size_t b = 1; b < buckets; ++b)
+			splitters.push_back(sample[b * oversampling]);
+
+		auto bucket_of = [&](const Value & value) {
+			return std::size_t(std::upper_bound(splitters.begin(), splitters.end(), value, comp) - splitters.begin());
+		};
+		auto block_begin = [&](std::size_t block) { return n * block / blocks; };
+
+		// 2. Count every bucket in every block, O(n lg buckets / threads)
+		std::vector<std::size_t> offsets(blocks * buckets, 0);
+		{
+			task_group group(pool);
+			for (std::size_t k = 0; k < blocks; ++k)
+				group.run([&, k] {
+					for (std::size_t i = block_begin(k); i < block_begin(k + 1); ++i)
+						++offsets[k * buckets + bucket_of(first[i])];
+				});
+			group.wait();
+		}
+
+		// 3. Exclusive prefix sum in bucket-major order: every block owns a
+		// disjoint output slice of every bucket, so the scatter needs no locks
+		std::vector<std::size_t> bucket_bounds(buckets + 1, 0);
+		std::size_t sum = 0;
+		for (std::size_t b = 0; b < buckets; ++b) {
+			bucket_bounds[b] = sum;
+			for (std::size_t k = 0; k < blocks; ++k) {
+				const std::size_t count = offsets[k * buckets + b];
+				offsets[k * buckets + b] = sum;
+				sum += count;
+			}
+		}
+		bucket_bounds[buckets] = n;
+
+		// 4. Scatter into the buffer, O(n lg buckets / threads)
+		std::vector<Value> buffer(n);
+		{
+			task_group group(pool);
+			for (std::size_t k = 0; k < blocks; ++k)
+				group.run([&, k] {
+					std::size_t * next = &offsets[k * buckets];
+					for (std::size_t i = block_begin(k); i < block_begin(k + 1); ++i)
+						buffer[next[bucket_of(first[i])]++] = std::move(first[i]);
+				});
+			group.wait();
+		}
+
+		// 5. Sort every bucket, then move it back to its final place
+		{
+			task_group group(pool);
+			for (std::size_t b = 0; b < buckets; ++b)
+				group.run([&, b] {
+					auto bucket_first = buffer.begin() + bucket_bounds[b];
+					auto bucket_last = buffer.begin() + bucket_bounds[b + 1];
+
+					task_group bucket_group(pool);
+					quicksort_task(bucket_first, bucket_last, comp, grain,
+						       2 * introsort_detail::log2_floor(bucket_bounds[b + 1] - bucket_bounds[b] + 1), bucket_group);
+					bucket_group.wait();
+
+					std::move(bucket_first, bucket_last, first + bucket_bounds[b]);
+				});
+			group.wait();
+		}
+	}
+}
+
+
+// O(n lg n / threads) expected, O(n lg n) worst case
+// Falls back to sequential introsort below 'grain' elements or on a single-thread pool
+template <class RandomIt, class Compare>
+void parallel_sort(RandomIt first, RandomIt last, Compare comp,
+		   work_stealing_pool & pool = work_stealing_pool::shared(), std::ptrdiff_t grain = parallel_sort_grain) {
+
+	const std::ptrdiff_t n = last - first;
+
+	if (n <= grain || pool.size() <= 1) {
+		introsort(first, last, comp);
+		return;
+	}
+
+	// Enough work for every thread to get many buckets: take the samplesort pass
+	if (n >= 16 * grain * std::ptrdiff_t(pool.size())) {
+		parallel_sort_detail::samplesort(first, last, comp, grain, pool);
+		return;
+	}
+
+	task_group group(pool);
+	parallel_sort_detail::quicksort_task(first, last, comp, grain, 2 * introsort_detail::log2_floor(std::size_t(n)), group);
+	group.wait();
+}
+
+template <class RandomIt>
+void parallel_sort(RandomIt first, RandomIt last) {
+	parallel_sort(first, last, std::less<typename std::iterator_traits<RandomIt>::value_type>());
+}
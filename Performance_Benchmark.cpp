@@ -0,0 +1,182 @@
+/*
+ *	Performance in Development
+ *
+ *	Native versus STL benchmark suite: the Problem 2 solutions, each run as
+ *	in its program, over input sizes from 10 up to max_size (10^9 is
+ *	supported, memory permitting) and over four input distributions:
+ *	random, sorted, reversed and few-unique
+ *
+ *	Every case reports the median time per element and its median absolute
+ *	deviation over the repetitions, and hardware counters per element when
+ *	perf_event_open is available. All rows are also written to a CSV file.
+ *
+ *	Problem 1 is not compared here: both of its programs run the same
+ *	counting sort. Problem1_Benchmark.cpp measures its sort paths.
+ *
+ *	Usage: Performance_Benchmark [max_size] [results.csv]
+ *
+ */
+
+// Include Standard Library headers
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <functional>
+#include <iterator>
+
+#include "Benchmark_Harness.h"
+#include "Order_Statistics.h"
+#include "Parallel_Sort.h"
+#include "Quantile_Sketch.h"
+#include "Random_Fill.h"
+#include "Running_Stats.h"
+#include "Top_K.h"
+
+
+enum class distribution { random, sorted, reversed, few_unique };
+
+const distribution distributions[] = { distribution::random, distribution::sorted, distribution::reversed, distribution::few_unique };
+
+const char * distribution_name(distribution d) {
+	switch (d) {
+	case distribution::sorted: return "sorted";
+	case distribution::reversed: return "reversed";
+	case distribution::few_unique: return "few-unique";
+	default: return "random";
+	}
+}
+
+// Problem 2 input: prices in [20, 30) $, or 10 distinct prices for few-unique
+std::vector<double> make_prices(std::size_t size, distribution d, std::uint64_t seed) {
+	std::vector<double> prices(size);
+	random_fill(prices, 20.0, 30.0, seed);
+	if (d == distribution::sorted)
+		parallel_sort(prices.begin(), prices.end());
+	else if (d == distribution::reversed)
+		parallel_sort(prices.begin(), prices.end(), std::greater<double>());
+	else if (d == distribution::few_unique)
+		for (auto & elem : prices)
+			elem = std::floor(elem) + 0.5;
+	return prices;
+}
+
+
+// The solutions, as in their programs; each returns a value depending on the whole result
+
+// Problem2_Native.cpp: bulk statistics, exact median, sketch, one heap pass for the 5 peaks
+double problem2_native(const std::vector<double> & prices) {
+	running_stats<double> stats;
+	stats.push(prices.data(), prices.data() + prices.size());
+
+	const double exact_median = median(prices);
+
+	quantile_sketch<double> sketch;
+	for (const double & elem : prices)
+		sketch.push(elem);
+	const std::vector<double> percentiles = sketch.quantiles({ 0.95, 0.99 });
+
+	top_k_selector<double> selector(5);
+	for (std::size_t i = 0; i < prices.size(); ++i)
+		selector.push(prices[i], i);
+	double peaks = 0;
+	for (const auto & peak : selector.sorted())
+		peaks += peak.value;
+
+	return stats.mean() + stats.variance() + stats.range() + exact_median + percentiles[1] + peaks;
+}
+
+// Problem2_STL.cpp: std::for_each over both functors, exact median, top_k for the 5 peaks
+double problem2_stl(const std::vector<double> & prices) {
+	running_stats<double> stats = std::for_each(std::begin(prices), std::end(prices), running_stats<double>());
+
+	const double exact_median = median(prices);
+
+	quantile_sketch<double> sketch = std::for_each(std::begin(prices), std::end(prices), quantile_sketch<double>());
+	const std::vector<double> percentiles = sketch.quantiles({ 0.95, 0.99 });
+
+	double peaks = 0;
+	for (const auto & peak : top_k(prices.data(), prices.data() + prices.size(), 5))
+		peaks += peak.value;
+
+	return stats.mean() + stats.variance() + stats.range() + exact_median + percentiles[1] + peaks;
+}
+
+
+// Repetitions: many for small inputs, never fewer than 3 for a median and a MAD
+std::size_t repetitions_for(std::size_t size) {
+	return std::max<std::size_t>(3, std::min<std::size_t>(21, 100000000 / size));
+}
+
+void print_row(const char * problem, const char * variant, distribution d, const benchmark_result & result) {
+	std::cout << std::setw(10) << problem
+		  << std::setw(8) << variant
+		  << std::setw(12) << distribution_name(d)
+		  << std::setw(12) << result.size
+		  << std::fixed << std::setprecision(3)
+		  << std::setw(12) << result.median_ns
+		  << std::setw(10) << result.mad_ns;
+	for (int e = 0; e < hardware_counters::event_count; ++e) {
+		if (result.counters[e] < 0)
+			std::cout << std::setw(14) << "-";
+		else
+			std::cout << std::setw(14) << result.counters[e];
+	}
+	std::cout << "\n";
+}
+
+
+int main(int argc, char * argv[]) {
+
+	std::size_t max_size = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+	const std::string csv_path = (argc > 2) ? argv[2] : "Performance_Benchmark.csv";
+
+	const std::uint64_t seed = 42;
+
+	hardware_counters counters;
+	benchmark_report report(csv_path);
+	if (!report.is_open()) {
+		std::cerr << "Cannot write " << csv_path << "\n";
+		return 1;
+	}
+
+	std::cout << "Native versus STL, median and MAD over the repetitions [ns/element]"
+		  << (counters.available() ? ", hardware counters per element\n\n" : ", hardware counters unavailable\n\n");
+
+	std::cout << std::setw(10) << "problem"
+		  << std::setw(8) << "variant"
+		  << std::setw(12) << "input"
+		  << std::setw(12) << "size"
+		  << std::setw(12) << "median"
+		  << std::setw(10) << "MAD";
+	for (int e = 0; e < hardware_counters::event_count; ++e)
+		std::cout << std::setw(14) << hardware_counters::name(hardware_counters::event(e));
+	std::cout << "\n";
+
+	volatile double sink = 0;
+
+
+	// Problem 2: statistics, median and the 5 highest prices
+
+	for (std::size_t size = 10; size <= max_size; size *= 10) {
+		for (distribution d : distributions) {
+
+			const std::vector<double> prices = make_prices(size, d, seed);
+
+			benchmark_result native = measure(size, repetitions_for(size), [&] { sink = problem2_native(prices); }, &counters);
+			benchmark_result stl = measure(size, repetitions_for(size), [&] { sink = problem2_stl(prices); }, &counters);
+
+			print_row("Problem 2", "Native", d, native);
+			print_row("Problem 2", "STL", d, stl);
+			report.add("problem2", "native", distribution_name(d), native);
+			report.add("problem2", "stl", distribution_name(d), stl);
+		}
+	}
+
+	std::cout << "\nResults written to " << csv_path << "\n";
+	return 0;
+}
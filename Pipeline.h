@@ -0,0 +1,559 @@
+/*
+ *	Lazy Pipelines
+ *
+ *	filter, transform and a terminal step composed with operator| and run
+ *	as one loop over the source, with no container between the steps:
+ *
+ *	  double total = pipeline::from(values)
+ *	               | pipeline::filter(is_negative<double>())
+ *	               | pipeline::transform(exponentiate<double>())
+ *	               | pipeline::reduce(0.0);
+ *
+ *	Nothing runs until the terminal step (reduce, count, to_vector,
+ *	for_each, collect). It drives the source, and every element is pushed
+ *	through the chain of steps: filter forwards it only if the predicate
+ *	holds, transform forwards the result of its function. Each step is a
+ *	small struct calling the next one, so the compiler inlines the whole
+ *	chain into the source loop, as if it were written by hand.
+ *
+ *	Any function object works, including the tutorial functors whose call
+ *	operator is not const (is_greater) or takes a non-const reference
+ *	(exponentiate: it gets a copy of the element when the source is const).
+ *
+ *	The terminal steps also accept parallel::par. Random access sources
+ *	are then cut into the chunks of Parallel_Algorithms.h, every chunk runs
+ *	the fused loop on the pool, and the partial results are combined in
+ *	chunk order: reduce returns the same result on every run and pool size,
+ *	and to_vector keeps the source order. Other sources run sequentially.
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Parallel_Algorithms.h"
+
+
+namespace pipeline {
+
+	namespace detail {
+
+		// op(x) when op accepts x as is, otherwise op(copy of x): exponentiate takes a T &
+		template <class Function, class T>
+		auto call(Function & function, T && x, int) -> decltype(function(std::forward<T>(x))) {
+			return function(std::forward<T>(x));
+		}
+
+		template <class Function, class T>
+		auto call(Function & function, T && x, long) -> decltype(function(std::declval<typename std::decay<T>::type &>())) {
+			typename std::decay<T>::type copy(std::forward<T>(x));
+			return function(copy);
+		}
+
+	}
+
+
+	/** Sources and steps ***/
+
+	// Every range of the pipeline provides
+	//   value_type, random_access, size()     (size() counts source elements)
+	//   push(consumer)                         every element, in order
+	//   push(begin, end, consumer)             elements of source positions [begin, end), random access only
+
+	template <class Iterator>
+	class source {
+	public:
+
+		typedef typename std::iterator_traits<Iterator>::value_type value_type;
+		static const bool random_access = parallel::detail::is_random_access<Iterator>::value;
+
+		source(Iterator first, Iterator last) : first(first), last(last) {}
+
+		std::size_t size() const { return std::size_t(std::distance(first, last)); }
+
+		template <class Consumer>
+		void push(Consumer & consumer) const {
+			for (Iterator it = first; it != last; ++it)
+				consumer(*it);
+		}
+
+		template <class Consumer>
+		void push(std::size_t begin, std::size_t end, Consumer & consumer) const {
+			for (Iterator it = std::next(first, begin), stop = std::next(first, end); it != stop; ++it)
+				consumer(*it);
+		}
+
+	private:
+		Iterator first, last;
+	};
+
+	// The elements of [first, last), or of a container, not copied
+	template <class Iterator>
+	source<Iterator> from(Iterator first, Iterator last) {
+		return source<Iterator>(first, last);
+	}
+
+	template <class Container>
+	source<typename Container::const_iterator> from(const Container & container) {
+		return source<typename Container::const_iterator>(container.begin(), container.end());
+	}
+
+
+	template <class Range, class Predicate>
+	class filter_view {
+	public:
+
+		typedef typename Range::value_type value_type;
+		static const bool random_access = Range::random_access;
+
+		filter_view(const Range & range, Predicate pred) : range(range), pred(pred) {}
+
+		std::size_t size() const { return range.size(); }
+
+		template <class Consumer>
+		void push(Consumer & consumer) const {
+			step<Consumer> next = { pred, consumer };
+			range.push(next);
+		}
+
+		template <class Consumer>
+		void push(std::size_t begin, std::size_t end, Consumer & consumer) const {
+			step<Consumer> next = { pred, consumer };
+			range.push(begin, end, next);
+		}
+
+	private:
+
+		// One copy of the predicate per run, so its call operator need not be const
+		template <class Consumer>
+		struct step {
+			Predicate pred;
+			Consumer & consumer;
+
+			template <class T>
+			void operator()(T && x) {
+				if (pred(x))
+					consumer(std::forward<T>(x));
+			}
+		};
+
+		Range range;
+		Predicate pred;
+	};
+
+
+	template <class Range, class Function>
+	class transform_view {
+	public:
+
+		typedef typename std::decay<decltype(detail::call(std::declval<Function &>(),
+			std::declval<typename Range::value_type &>(), 0))>::type value_type;
+		static const bool random_access = Range::random_access;
+
+		transform_view(const Range & range, Function function) : range(range), function(function) {}
+
+		std::size_t size() const { return range.size(); }
+
+		template <class Consumer>
+		void push(Consumer & consumer) const {
+			step<Consumer> next = { function, consumer };
+			range.push(next);
+		}
+
+		template <class Consumer>
+		void push(std::size_t begin, std::size_t end, Consumer & consumer) const {
+			step<Consumer> next = { function, consumer };
+			range.push(begin, end, next);
+		}
+
+	private:
+
+		template <class Consumer>
+		struct step {
+			Function function;
+			Consumer & consumer;
+
+			template <class T>
+			void operator()(T && x) {
+				consumer(detail::call(function, std::forward<T>(x), 0));
+			}
+		};
+
+		Range range;
+		Function function;
+	};
+
+
+	template <class Predicate>
+	struct filter_step {
+		Predicate pred;
+	};
+
+	template <class Function>
+	struct transform_step {
+		Function function;
+	};
+
+	// Keep the elements satisfying 'pred'
+	template <class Predicate>
+	filter_step<Predicate> filter(Predicate pred) { return { pred }; }
+
+	// Replace every element x by function(x)
+	template <class Function>
+	transform_step<Function> transform(Function function) { return { function }; }
+
+	template <class Range, class Predicate>
+	filter_view<Range, Predicate> operator|(const Range & range, const filter_step<Predicate> & step) {
+		return filter_view<Range, Predicate>(range, step.pred);
+	}
+
+	template <class Range, class Function>
+	transform_view<Range, Function> operator|(const Range & range, const transform_step<Function> & step) {
+		return transform_view<Range, Function>(range, step.function);
+	}
+
+
+	/** Terminal steps ***/
+
+	namespace detail {
+
+		// Run body(c, begin, end) for every chunk of the source on the pool, and return true,
+		// or return false when the range must run sequentially (no random access, or one chunk)
+		template <class Range, class Body>
+		bool run_chunks(const Range & range, const parallel::parallel_policy & policy, std::true_type, Body body) {
+			const std::size_t n = range.size();
+			const std::size_t chunks = parallel::detail::chunk_count(n, policy.grain);
+			if (chunks <= 1)
+				return false;
+			parallel::detail::run_chunks(policy, chunks, [&](std::size_t c) {
+				const std::size_t begin = c * policy.grain;
+				body(c, begin, std::min(n, begin + policy.grain));
+			});
+			return true;
+		}
+
+		template <class Range, class Body>
+		bool run_chunks(const Range &, const parallel::parallel_policy &, std::false_type, Body) {
+			return false;
+		}
+
+		template <class Range>
+		std::size_t chunk_count(const Range & range, const parallel::parallel_policy & policy) {
+			return Range::random_access ? parallel::detail::chunk_count(range.size(), policy.grain) : 0;
+		}
+
+		template <class T, class BinaryOperation>
+		struct fold {
+			T value;
+			BinaryOperation op;
+
+			template <class U>
+			void operator()(U && x) { value = op(value, std::forward<U>(x)); }
+		};
+
+		// A fold without an initial value, for the chunks of a parallel reduce
+		template <class T, class BinaryOperation>
+		struct partial_fold {
+			T value;
+			bool empty;
+			BinaryOperation op;
+
+			template <class U>
+			void operator()(U && x) {
+				if (empty) {
+					value = T(std::forward<U>(x));
+					empty = false;
+				}
+				else
+					value = op(value, std::forward<U>(x));
+			}
+		};
+
+		struct counter {
+			std::size_t n;
+
+			template <class U>
+			void operator()(U &&) { ++n; }
+		};
+
+		template <class T>
+		struct appender {
+			std::vector<T> & out;
+
+			template <class U>
+			void operator()(U && x) { out.push_back(std::forward<U>(x)); }
+		};
+
+		// Lets a functor held by reference act as a consumer
+		template <class Function>
+		struct forwarder {
+			Function & function;
+
+			template <class U>
+			void operator()(U && x) { function(std::forward<U>(x)); }
+		};
+
+		// Tells reduce(init, op) from reduce(init, policy)
+		template <class T> struct is_policy : std::false_type {};
+		template <> struct is_policy<parallel::sequenced_policy> : std::true_type {};
+		template <> struct is_policy<parallel::parallel_policy> : std::true_type {};
+
+	}
+
+
+	template <class T, class BinaryOperation, class Policy>
+	struct reduce_step {
+		T init;
+		BinaryOperation op;
+		Policy policy;
+
+		template <class Range>
+		T run(const Range & range) const { return run(range, policy); }
+
+	private:
+
+		template <class Range>
+		T run(const Range & range, const parallel::sequenced_policy &) const {
+			detail::fold<T, BinaryOperation> fold = { init, op };
+			range.push(fold);
+			return fold.value;
+		}
+
+		template <class Range>
+		T run(const Range & range, const parallel::parallel_policy & par) const {
+			typedef detail::partial_fold<T, BinaryOperation> partial;
+			std::vector<partial> partials(detail::chunk_count(range, par), partial{ init, true, op });
+
+			const bool chunked = detail::run_chunks(range, par, std::integral_constant<bool, Range::random_access>(),
+				[&](std::size_t c, std::size_t begin, std::size_t end) { range.push(begin, end, partials[c]); });
+			if (!chunked)
+				return run(range, parallel::seq);
+
+			// In chunk order, whichever thread finished first
+			T result = init;
+			for (const partial & part : partials)
+				if (!part.empty)
+					result = op(result, part.value);
+			return result;
+		}
+	};
+
+	template <class Policy>
+	struct count_step {
+		Policy policy;
+
+		template <class Range>
+		std::size_t run(const Range & range) const { return run(range, policy); }
+
+	private:
+
+		template <class Range>
+		std::size_t run(const Range & range, const parallel::sequenced_policy &) const {
+			detail::counter counter = { 0 };
+			range.push(counter);
+			return counter.n;
+		}
+
+		template <class Range>
+		std::size_t run(const Range & range, const parallel::parallel_policy & par) const {
+			std::vector<detail::counter> counters(detail::chunk_count(range, par), detail::counter{ 0 });
+
+			const bool chunked = detail::run_chunks(range, par, std::integral_constant<bool, Range::random_access>(),
+				[&](std::size_t c, std::size_t begin, std::size_t end) { range.push(begin, end, counters[c]); });
+			if (!chunked)
+				return run(range, parallel::seq);
+
+			std::size_t n = 0;
+			for (const detail::counter & counter : counters)
+				n += counter.n;
+			return n;
+		}
+	};
+
+	template <class Policy>
+	struct to_vector_step {
+		Policy policy;
+
+		template <class Range>
+		std::vector<typename Range::value_type> run(const Range & range) const { return run(range, policy); }
+
+	private:
+
+		template <class Range>
+		std::vector<typename Range::value_type> run(const Range & range, const parallel::sequenced_policy &) const {
+			std::vector<typename Range::value_type> out;
+			detail::appender<typename Range::value_type> appender = { out };
+			range.push(appender);
+			return out;
+		}
+
+		template <class Range>
+		std::vector<typename Range::value_type> run(const Range & range, const parallel::parallel_policy & par) const {
+			typedef typename Range::value_type value_type;
+			std::vector<std::vector<value_type>> parts(detail::chunk_count(range, par));
+
+			const bool chunked = detail::run_chunks(range, par, std::integral_constant<bool, Range::random_access>(),
+				[&](std::size_t c, std::size_t begin, std::size_t end) {
+					detail::appender<value_type> appender = { parts[c] };
+					range.push(begin, end, appender);
+				});
+			if (!chunked)
+				return run(range, parallel::seq);
+
+			// Concatenated in chunk order, so the output is in source order
+			std::size_t total = 0;
+			for (const std::vector<value_type> & part : parts)
+				total += part.size();
+			std::vector<value_type> out;
+			out.reserve(total);
+			for (std::vector<value_type> & part : parts)
+				out.insert(out.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
+			return out;
+		}
+	};
+
+	template <class Accumulator, class Policy>
+	struct collect_step {
+		Accumulator accumulator;
+		Policy policy;
+
+		template <class Range>
+		Accumulator run(const Range & range) const { return run(range, policy); }
+
+	private:
+
+		template <class Range>
+		Accumulator run(const Range & range, const parallel::sequenced_policy &) const {
+			Accumulator result = accumulator;
+			detail::forwarder<Accumulator> forward = { result };
+			range.push(forward);
+			return result;
+		}
+
+		template <class Range>
+		Accumulator run(const Range & range, const parallel::parallel_policy & par) const {
+			std::vector<Accumulator> parts(detail::chunk_count(range, par), accumulator);
+
+			const bool chunked = detail::run_chunks(range, par, std::integral_constant<bool, Range::random_access>(),
+				[&](std::size_t c, std::size_t begin, std::size_t end) {
+					detail::forwarder<Accumulator> forward = { parts[c] };
+					range.push(begin, end, forward);
+				});
+			if (!chunked)
+				return run(range, parallel::seq);
+
+			for (std::size_t c = 1; c < parts.size(); ++c)
+				parts[0].merge(parts[c]);
+			return parts[0];
+		}
+	};
+
+	template <class Function, class Policy>
+	struct for_each_step {
+		Function function;
+		Policy policy;
+
+		template <class Range>
+		void run(const Range & range) const {
+			const bool chunked = detail::run_chunks(range, policy, std::integral_constant<bool, Range::random_access>(),
+				[&](std::size_t, std::size_t begin, std::size_t end) {
+					Function copy = function;
+					detail::forwarder<Function> forward = { copy };
+					range.push(begin, end, forward);
+				});
+			if (!chunked) {
+				Function copy = function;
+				detail::forwarder<Function> forward = { copy };
+				range.push(forward);
+			}
+		}
+	};
+
+	template <class Function>
+	struct for_each_step<Function, parallel::sequenced_policy> {
+		Function function;
+		parallel::sequenced_policy policy;
+
+		template <class Range>
+		Function run(const Range & range) const {
+			Function result = function;
+			detail::forwarder<Function> forward = { result };
+			range.push(forward);
+			return result;
+		}
+	};
+
+
+	// init combined with every element by op (default +), left to right
+	// With parallel::par, op must be associative; the result is the same on every run and pool size
+	template <class T>
+	reduce_step<T, std::plus<T>, parallel::sequenced_policy> reduce(T init) {
+		return { init, std::plus<T>(), parallel::seq };
+	}
+
+	template <class T, class BinaryOperation>
+	typename std::enable_if<!detail::is_policy<BinaryOperation>::value, reduce_step<T, BinaryOperation, parallel::sequenced_policy>>::type
+	reduce(T init, BinaryOperation op) {
+		return { init, op, parallel::seq };
+	}
+
+	template <class T, class Policy>
+	typename std::enable_if<detail::is_policy<Policy>::value, reduce_step<T, std::plus<T>, Policy>>::type
+	reduce(T init, const Policy & policy) {
+		return { init, std::plus<T>(), policy };
+	}
+
+	template <class T, class BinaryOperation, class Policy>
+	reduce_step<T, BinaryOperation, Policy> reduce(T init, BinaryOperation op, const Policy & policy) {
+		return { init, op, policy };
+	}
+
+	// Number of elements reaching the end of the pipeline
+	inline count_step<parallel::sequenced_policy> count() { return { parallel::seq }; }
+
+	template <class Policy>
+	count_step<Policy> count(const Policy & policy) { return { policy }; }
+
+	// The elements reaching the end of the pipeline, in source order
+	inline to_vector_step<parallel::sequenced_policy> to_vector() { return { parallel::seq }; }
+
+	template <class Policy>
+	to_vector_step<Policy> to_vector(const Policy & policy) { return { policy }; }
+
+	// Feed every element to a copy of 'accumulator' (running_stats, quantile_sketch, ...) and return it
+	// With parallel::par every chunk feeds its own copy, merged in chunk order with merge(),
+	// so 'accumulator' should be empty
+	template <class Accumulator>
+	collect_step<Accumulator, parallel::sequenced_policy> collect(const Accumulator & accumulator) {
+		return { accumulator, parallel::seq };
+	}
+
+	template <class Accumulator, class Policy>
+	collect_step<Accumulator, Policy> collect(const Accumulator & accumulator, const Policy & policy) {
+		return { accumulator, policy };
+	}
+
+	// Call 'function' on every element, in order; returns the function, as std::for_each
+	template <class Function>
+	for_each_step<Function, parallel::sequenced_policy> for_each(Function function) { return { function, parallel::seq }; }
+
+	// With parallel::par every chunk calls its own copy of 'function', in any order, and nothing is returned
+	template <class Function, class Policy>
+	for_each_step<Function, Policy> for_each(Function function, const Policy & policy) { return { function, policy }; }
+
+
+	// Running a pipeline: range | terminal step
+	template <class Range, class Step>
+	auto operator|(const Range & range, const Step & step) -> decltype(step.run(range)) {
+		return step.run(range);
+	}
+
+}
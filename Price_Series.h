@@ -0,0 +1,265 @@
+/*
+ *	Price Series
+ *
+ *	Columnar (structure-of-arrays) store for a time series of prices
+ *
+ *	Timestamps and prices live in two contiguous columns. A record costs
+ *	sizeof(Time) + sizeof(Price) bytes with no heap allocation of its own,
+ *	and statistics run directly on the price column: no extraction copy.
+ *
+ *	Time is a small value type that knows how to parse and print itself,
+ *	e.g. clock_minutes, 2 bytes for "09:30AM" instead of a std::string,
+ *	or epoch_nanos for tick data.
+ *
+ *	price_series_view is the non-owning counterpart, e.g. over the columns
+ *	of a memory-mapped tick file.
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+
+// Accumulate up to 'max_digits' decimal digits from [p, last) into 'value'
+// Returns the position after the last digit consumed; 'count' grows by the digits read.
+// Eight digits at a time are checked and converted with a few 64-bit operations (SWAR),
+// which breaks the one-multiply-per-digit dependency chain of the scalar loop
+inline const char * parse_digits(const char * p, const char * last, std::uint64_t & value, int & count, int max_digits = 19) {
+
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	while (max_digits - count >= 8 && last - p >= 8) {
+		std::uint64_t chunk;
+		std::memcpy(&chunk, p, sizeof(chunk));
+
+		// All eight bytes in '0'..'9'?
+		if ((((chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) != 0x3333333333333333ULL))
+			break;
+
+		// Pairwise combine: 8 x 1 digit -> 4 x 2 digits -> 2 x 4 digits -> 8 digits
+		chunk = ((chunk & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+		chunk = ((chunk & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+		chunk = ((chunk & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32;
+
+		value = value * 100000000ULL + chunk;
+		count += 8;
+		p += 8;
+	}
+#endif
+
+	for (; p != last && count < max_digits && *p >= '0' && *p <= '9'; ++p, ++count)
+		value = value * 10 + std::uint64_t(*p - '0');
+	return p;
+}
+
+
+// Minutes since midnight, parsed from "09:30AM", "12:00PM" or 24-hour "16:00"
+struct clock_minutes {
+
+	std::uint16_t minutes;
+
+	clock_minutes(std::uint16_t minutes = 0) : minutes(minutes) {}
+
+	// Throws std::invalid_argument on malformed input
+	static clock_minutes parse(const char * first, const char * last) {
+		if ((last - first != 5 && last - first != 7) || first[2] != ':')
+			throw std::invalid_argument("clock_minutes: expected HH:MM[AM|PM]");
+
+		auto digit = [](char c) {
+			if (c < '0' || c > '9')
+				throw std::invalid_argument("clock_minutes: expected a digit");
+			return c - '0';
+		};
+
+		int hours = digit(first[0]) * 10 + digit(first[1]);
+		const int mins = digit(first[3]) * 10 + digit(first[4]);
+
+		if (last - first == 7) {
+			const bool am = (first[5] == 'A' || first[5] == 'a'), pm = (first[5] == 'P' || first[5] == 'p');
+			if (!(am || pm) || (first[6] != 'M' && first[6] != 'm'))
+				throw std::invalid_argument("clock_minutes: expected HH:MM[AM|PM]");
+			if (hours < 1 || hours > 12)
+				throw std::invalid_argument("clock_minutes: 12-hour clock out of range");
+			hours = (hours % 12) + (pm ? 12 : 0);
+		}
+
+		if (hours > 23 || mins > 59)
+			throw std::invalid_argument("clock_minutes: time out of range");
+		return clock_minutes(std::uint16_t(hours * 60 + mins));
+	}
+
+	static clock_minutes parse(const char * text) { return parse(text, text + std::strlen(text)); }
+
+	// Minutes since midnight, e.g. for time windows
+	std::int64_t count() const { return minutes; }
+
+	bool operator<(const clock_minutes & other) const { return minutes < other.minutes; }
+	bool operator==(const clock_minutes & other) const { return minutes == other.minutes; }
+};
+
+// Prints in the 12-hour "09:30AM" format
+inline std::ostream & operator<<(std::ostream & out, const clock_minutes & time) {
+	const int hours = time.minutes / 60;
+	const int hours12 = (hours % 12 == 0) ? 12 : hours % 12;
+	const char fill = out.fill('0');
+	out << std::setw(2) << hours12 << ':' << std::setw(2) << time.minutes % 60 << (hours < 12 ? "AM" : "PM");
+	out.fill(fill);
+	return out;
+}
+
+
+// Nanoseconds since the Unix epoch, parsed from a decimal integer
+// Layout-compatible with std::int64_t, so binary tick files map onto it directly
+struct epoch_nanos {
+
+	std::int64_t nanos;
+
+	epoch_nanos(std::int64_t nanos = 0) : nanos(nanos) {}
+
+	// Throws std::invalid_argument on malformed input
+	static epoch_nanos parse(const char * first, const char * last) {
+		const bool negative = (first != last && *first == '-');
+		if (negative)
+			++first;
+		if (first == last)
+			throw std::invalid_argument("epoch_nanos: expected an integer");
+
+		std::uint64_t value = 0;
+		int digits = 0;
+		if (parse_digits(first, last, value, digits) != last)
+			throw std::invalid_argument("epoch_nanos: expected at most 19 digits");
+
+		// 19 digits go past the int64 range; the negative side holds one more value
+		const std::uint64_t max = std::uint64_t(std::numeric_limits<std::int64_t>::max());
+		if (value > max + (negative ? 1 : 0))
+			throw std::invalid_argument("epoch_nanos: out of the int64 range");
+		if (negative)
+			return epoch_nanos(value > max ? std::numeric_limits<std::int64_t>::min() : -std::int64_t(value));
+		return epoch_nanos(std::int64_t(value));
+	}
+
+	static epoch_nanos parse(const char * text) { return parse(text, text + std::strlen(text)); }
+
+	std::int64_t count() const { return nanos; }
+
+	bool operator<(const epoch_nanos & other) const { return nanos < other.nanos; }
+	bool operator==(const epoch_nanos & other) const { return nanos == other.nanos; }
+};
+
+inline std::ostream & operator<<(std::ostream & out, const epoch_nanos & time) { return out << time.nanos; }
+
+
+template <class Time, class Price = double>
+class basic_price_series {
+public:
+
+	typedef Time time_type;
+	typedef Price price_type;
+
+	basic_price_series() {}
+
+	// { { "09:30AM", 23.29 }, { "10:00AM", 22.11 }, ... }
+	// The text is parsed into Time, nothing is kept as a string
+	basic_price_series(std::initializer_list<std::pair<const char *, Price>> records) {
+		reserve(records.size());
+		for (const auto & record : records)
+			push_back(Time::parse(record.first), record.second);
+	}
+
+	void reserve(std::size_t n) {
+		time_column.reserve(n);
+		price_column.reserve(n);
+	}
+
+	// Amortized O(1)
+	void push_back(const Time & time, const Price & price) {
+		time_column.push_back(time);
+		price_column.push_back(price);
+	}
+
+	void clear() {
+		time_column.clear();
+		price_column.clear();
+	}
+
+	// For bulk loaders that fill the columns in place
+	void resize(std::size_t n) {
+		time_column.resize(n);
+		price_column.resize(n);
+	}
+
+	Time * time_data() { return time_column.data(); }
+	Price * price_data() { return price_column.data(); }
+
+	std::size_t size() const { return price_column.size(); }
+	bool empty() const { return price_column.empty(); }
+
+	const Time & time(std::size_t i) const { return time_column[i]; }
+	const Price & price(std::size_t i) const { return price_column[i]; }
+
+	// Whole columns, contiguous: pass them straight to the statistics kernels
+	const std::vector<Time> & times() const { return time_column; }
+	const std::vector<Price> & prices() const { return price_column; }
+
+	const Price * price_begin() const { return price_column.data(); }
+	const Price * price_end() const { return price_column.data() + price_column.size(); }
+
+	// Price of the first and last record
+	const Price & open() const { return price_column.front(); }
+	const Price & close() const { return price_column.back(); }
+
+private:
+	std::vector<Time> time_column;
+	std::vector<Price> price_column;
+};
+
+
+// Non-owning view over two columns of equal length
+// The columns must outlive the view
+template <class Time, class Price = double>
+class price_series_view {
+public:
+
+	typedef Time time_type;
+	typedef Price price_type;
+
+	price_series_view() : time_column(nullptr), price_column(nullptr), n(0) {}
+	price_series_view(const Time * times, const Price * prices, std::size_t n) : time_column(times), price_column(prices), n(n) {}
+	price_series_view(const basic_price_series<Time, Price> & series)
+		: time_column(series.times().data()), price_column(series.price_begin()), n(series.size()) {}
+
+	std::size_t size() const { return n; }
+	bool empty() const { return n == 0; }
+
+	const Time & time(std::size_t i) const { return time_column[i]; }
+	const Price & price(std::size_t i) const { return price_column[i]; }
+
+	const Price * price_begin() const { return price_column; }
+	const Price * price_end() const { return price_column + n; }
+
+	const Price & open() const { return price_column[0]; }
+	const Price & close() const { return price_column[n - 1]; }
+
+private:
+	const Time * time_column;
+	const Price * price_column;
+	std::size_t n;
+};
+
+
+// One trading day sampled on the clock, e.g. every 30 minutes
+typedef basic_price_series<clock_minutes> intraday_series;
+
+// Tick data stamped in nanoseconds since the epoch
+typedef basic_price_series<epoch_nanos> tick_series;
+typedef price_series_view<epoch_nanos> tick_series_view;
@@ -0,0 +1,265 @@
+/*
+ *	Performance in Development
+ *
+ *	Problem 1 benchmark: increasing and decreasing copies of a vector of chars
+ *
+ *	Compares the original input generator (reseeded per element) with the
+ *	bulk random fill, and the original sort paths (Lomuto quicksort, std::sort)
+ *	with introsort and the small-domain counting sort, and measures how the
+ *	parallel sort scales with the number of threads
+ *
+ *	Usage: Problem1_Benchmark [max_size]
+ *
+ */
+
+// Include Standard Library headers
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <iterator>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <functional>
+#include <thread>
+
+#include "Benchmark_Harness.h"
+#include "Introsort.h"
+#include "Parallel_Sort.h"
+#include "Random_Fill.h"
+#include "Small_Domain_Sort.h"
+#include "Sorted_View.h"
+
+
+// The original Problem 1 quicksort, kept here as the baseline
+// Lomuto partition with the last element as pivot: O(n^2) on few-unique data
+
+template <class Type>
+long long lomuto_partition(std::vector<Type> & myVector, long long begin, long long end) {
+	Type x = myVector[end];
+	long long i = begin - 1;
+	for (long long j = begin; j < end; j++) {
+		if (myVector[j] <= x) {
+			i++;
+			std::swap(myVector[j], myVector[i]);
+		}
+	}
+	std::swap(myVector[i + 1], myVector[end]);
+	return i + 1;
+}
+
+template <class Type>
+void lomuto_quicksort(std::vector<Type> & myVector, long long begin, long long end) {
+	if (begin < end) {
+		long long mid = lomuto_partition(myVector, begin, end);
+		lomuto_quicksort(myVector, begin, mid - 1);
+		lomuto_quicksort(myVector, mid + 1, end);
+	}
+}
+
+
+int main(int argc, char * argv[]) {
+
+	std::size_t max_size = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+	// Quadratic on 26 distinct values, so only run it on small inputs
+	const std::size_t lomuto_limit = 100000;
+
+	const std::uint64_t seed = 42;
+
+
+	// 1. Input generation
+
+	{
+		// Original generator: engine reseeded from the system clock for every element
+		const std::size_t reseed_size = std::min<std::size_t>(max_size, 1000000);
+		std::vector<char> input(reseed_size);
+		double reseeded = ns_per_element(reseed_size, [&] {
+			std::default_random_engine engine;
+			std::uniform_int_distribution<int> dist(0, 25);
+			for (auto & elem : input) {
+				engine.seed((unsigned int)std::chrono::system_clock::now().time_since_epoch().count());
+				elem = char('A' + dist(engine));
+			}
+		});
+
+		input.resize(max_size);
+		double bulk_1 = ns_per_element(max_size, [&] { random_fill(input, 'A', 'Z', seed, 1); });
+		double bulk_all = ns_per_element(max_size, [&] { random_fill(input, 'A', 'Z', seed); });
+
+		std::cout << std::fixed << std::setprecision(3)
+			  << "Input generation [ns/element]\n"
+			  << "  reseeded per element: " << reseeded << "\n"
+			  << "  random_fill (1):      " << bulk_1 << "  (" << 1.0 / bulk_1 << " GB/s)\n"
+			  << "  random_fill (all):    " << bulk_all << "  (" << 1.0 / bulk_all << " GB/s)\n\n";
+	}
+
+
+	// 2. Sorting
+
+	std::cout << std::setw(12) << "size"
+		  << std::setw(16) << "lomuto"
+		  << std::setw(16) << "std::sort"
+		  << std::setw(16) << "introsort"
+		  << std::setw(16) << "counting(1)"
+		  << std::setw(16) << "counting(all)"
+		  << std::setw(16) << "counting+view" << "    [ns/element]\n";
+
+	for (std::size_t size = 10; size <= max_size; size *= 10) {
+
+		std::vector<char> input(size);
+		random_fill(input, 'A', 'Z', seed);
+
+		std::vector<char> increasing, decreasing;
+
+		// Native path: sort a copy, then copy out both orders
+		double lomuto = -1.0;
+		if (size <= lomuto_limit) {
+			lomuto = ns_per_element(size, [&] {
+				std::vector<char> work(input);
+				lomuto_quicksort(work, 0, (long long)size - 1);
+				increasing.assign(work.begin(), work.end());
+				decreasing.assign(work.rbegin(), work.rend());
+			});
+		}
+
+		// STL path
+		double stl = ns_per_element(size, [&] {
+			std::vector<char> work(input);
+			std::sort(work.begin(), work.end());
+			increasing.assign(work.begin(), work.end());
+			decreasing.assign(work.rbegin(), work.rend());
+		});
+		std::vector<char> expected = increasing;
+
+		// Introsort: three-way partitioning handles the 26 distinct keys
+		double intro = ns_per_element(size, [&] {
+			std::vector<char> work(input);
+			introsort(work.begin(), work.end());
+			increasing.assign(work.begin(), work.end());
+			decreasing.assign(work.rbegin(), work.rend());
+		});
+
+		if (increasing != expected) {
+			std::cerr << "introsort mismatch at size " << size << "\n";
+			return 1;
+		}
+
+		// Counting sort, single-threaded and with all hardware threads
+		double counting_1 = ns_per_element(size, [&] {
+			counting_sort_both(input, 'A', 'Z', increasing, decreasing, 1);
+		});
+		double counting_all = ns_per_element(size, [&] {
+			counting_sort_both(input, 'A', 'Z', increasing, decreasing);
+		});
+
+		if (increasing != expected || !std::equal(decreasing.rbegin(), decreasing.rend(), expected.begin())) {
+			std::cerr << "Mismatch at size " << size << "\n";
+			return 1;
+		}
+
+		// Counting sort in place, both orders read through a view: no output vectors
+		std::vector<char> work;
+		double counting_view = ns_per_element(size, [&] {
+			work = input;
+			counting_sort(work, 'A', 'Z');
+		});
+		sorted_view<char> sorted(work);
+
+		if (!std::equal(sorted.begin(), sorted.end(), expected.begin())
+		    || !std::equal(sorted.descending().begin(), sorted.descending().end(), expected.rbegin())) {
+			std::cerr << "View mismatch at size " << size << "\n";
+			return 1;
+		}
+
+		std::cout << std::setw(12) << size << std::fixed << std::setprecision(3) << std::setw(16);
+		if (lomuto < 0)
+			std::cout << "-";
+		else
+			std::cout << lomuto;
+		std::cout << std::setw(16) << stl
+			  << std::setw(16) << intro
+			  << std::setw(16) << counting_1
+			  << std::setw(16) << counting_all
+			  << std::setw(16) << counting_view << "\n";
+	}
+
+
+
+	// 3. Generic sorts on doubles, by input distribution
+
+	std::cout << "\n" << std::setw(12) << "size"
+		  << std::setw(16) << "distribution"
+		  << std::setw(16) << "std::sort"
+		  << std::setw(16) << "introsort" << "    [ns/element]\n";
+
+	const char * distributions[] = { "random", "sorted", "reversed", "few-unique" };
+
+	for (std::size_t size = 1000; size <= max_size; size *= 10) {
+		for (int d = 0; d < 4; ++d) {
+
+			std::vector<double> input(size);
+			random_fill(input, 0.0, 1.0, seed);
+
+			if (d == 1)
+				std::sort(input.begin(), input.end());
+			else if (d == 2)
+				std::sort(input.rbegin(), input.rend());
+			else if (d == 3)
+				for (auto & elem : input)
+					elem = std::floor(elem * 26);
+
+			std::vector<double> expected(input), work(input);
+
+			double stl = ns_per_element(size, [&] { std::sort(expected.begin(), expected.end()); });
+			double intro = ns_per_element(size, [&] { introsort(work.begin(), work.end()); });
+
+			if (work != expected) {
+				std::cerr << "introsort mismatch at size " << size << "\n";
+				return 1;
+			}
+
+			std::cout << std::setw(12) << size << std::setw(16) << distributions[d]
+				  << std::setw(16) << stl << std::setw(16) << intro << "\n";
+		}
+	}
+
+
+
+	// 4. Parallel sort scaling on random doubles
+
+	{
+		std::vector<double> input(max_size);
+		random_fill(input, 0.0, 1.0, seed);
+
+		std::vector<double> expected(input);
+		double sequential = ns_per_element(max_size, [&] { introsort(expected.begin(), expected.end()); });
+
+		std::cout << "\nParallel sort of " << max_size << " doubles [ns/element]\n"
+			  << std::setw(12) << "threads" << std::setw(16) << "time" << std::setw(16) << "speedup" << "\n"
+			  << std::setw(12) << "introsort" << std::setw(16) << sequential << std::setw(16) << 1.0 << "\n";
+
+		const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+		for (unsigned threads = 1; ; threads = std::min(2 * threads, hardware)) {
+			work_stealing_pool pool(threads);
+			std::vector<double> work(input);
+
+			double parallel = ns_per_element(max_size, [&] { parallel_sort(work.begin(), work.end(), std::less<double>(), pool); });
+
+			if (work != expected) {
+				std::cerr << "parallel_sort mismatch with " << threads << " threads\n";
+				return 1;
+			}
+
+			std::cout << std::setw(12) << threads << std::setw(16) << parallel << std::setw(16) << sequential / parallel << "\n";
+
+			if (threads == hardware)
+				break;
+		}
+	}
+
+	return 0;
+}
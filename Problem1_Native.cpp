@@ -10,58 +10,18 @@
  // Include Standard Library headers
 #include <iostream>
 #include <vector>
-#include <chrono>
-#include <random>
+#include <cstdint>
 
-
-// O(input_size) (linear)
-void myCharInit(std::vector<char> & myVec) {
-
-	// RNG 
-	std::default_random_engine engine;
-	std::uniform_int<int> dist(0, 25);
-
-	// Iterators
-	auto begin = myVec.begin();
-	auto end = myVec.end();
-
-	// Assign random characters to each element
-	for (; begin != end; ++begin) {
-		engine.seed((unsigned int)std::chrono::system_clock::now().time_since_epoch().count());
-		*begin = ('A' + (char)dist(engine));
-	}
-}
+#include "Random_Fill.h"
+#include "Small_Domain_Sort.h"
+#include "Sorted_View.h"
 
 
-// O(n lg n) Quicksort
-
-// Partition auxiliary function for quicksort
-template <class Type>
-int partition(std::vector<Type> & myVector, int begin, int end) {
-	Type x = myVector[end];
-	int i = begin - 1;
-	for (unsigned j = begin; j < end; j++) {
-		if (myVector[j] <= x) {
-			i++;
-			Type temp = myVector[j];
-			myVector[j] = myVector[i];
-			myVector[i] = temp;
-		}
-	}
-	Type temp = myVector[i + 1];
-	myVector[i + 1] = myVector[end];
-	myVector[end] = temp;
-	return i + 1;
-}
+// O(input_size) (linear)
+void myCharInit(std::vector<char> & myVec, std::uint64_t seed) {
 
-// Recursive Quicksort algorithm
-template <class Type>
-void myQuicksort(std::vector<Type> & myVector, int begin, int end) {
-	if (begin < end) {
-		int mid = partition(myVector, begin, end);
-		myQuicksort(myVector, begin, mid - 1);
-		myQuicksort(myVector, mid + 1, end);
-	}
+	// Bulk RNG: seeded once, the same seed always gives the same characters
+	random_fill(myVec, 'A', 'Z', seed);
 }
 
 
@@ -70,9 +30,10 @@ int main() {
 	// 1. Create a vector populated with characters
 
 	const std::size_t size = 10;
+	const std::uint64_t seed = 2018;
 
 	std::vector<char> myVector(size);
-	myCharInit(myVector);
+	myCharInit(myVector, seed);
 
 	
 		// i. Print the initial values
@@ -85,38 +46,35 @@ int main() {
 	
 
 	// 2. Sort
-	myQuicksort<char>(myVector, 0, size - 1); // O(n lg n)
 
+	// All values lie in 'A'..'Z', so a histogram of 26 counters replaces
+	// the comparison sort: one counting pass, no comparisons
+	small_domain_histogram<char> histogram('A', 'Z');
+	histogram.count(myVector.data(), myVector.data() + size); // O(n)
 
+	// Write the sorted values back in place
+	histogram.write_increasing(myVector.begin()); // O(n)
 
-	// 3. Copy values to increasing-order vector
 
-	std::vector<char> increasing;
 
-	for (const double & elem : myVector)
-		increasing.push_back(elem);
+	// 3. View the sorted values in increasing order
 
+	// No copy: the view reads myVector directly
+	sorted_view<char> sorted(myVector); // O(1)
 
 
-	// 4. Copy values to increasing-order vector
-	
-	std::vector<char> decreasing;
-
-	// Copy to the decreasing vector
-	auto begin = myVector.begin();
-	auto end = myVector.end();
 
-	int i = 1;
+	// 4. View the sorted values in decreasing order
 	
-	for (; begin != end; ++begin)
-		decreasing.push_back(*(end - i++));
+	// No copy either: descending() walks the same buffer backwards
+	auto decreasing = sorted.descending(); // O(1)
 
 
 
 	// 5. Print results
 
 	std::cout << "Increasing:\n";
-	for (const double & elem : increasing)
+	for (const double & elem : sorted.ascending())
 		std::cout << elem << " ";
 	std::cout << "\n\n";
 
@@ -11,57 +11,47 @@
 #include <iostream>
 #include <algorithm>
 #include <vector>
-#include <random>
-#include <chrono>
+#include <cstdint>
 #include <iterator>
 
+#include "Random_Fill.h"
+#include "Small_Domain_Sort.h"
+#include "Sorted_View.h"
+
 // Auxiliary function to populate input vector with random characters
 
 // O( input_size ) (linear)
-void initialize(std::vector<char> & myVec) {
-
-	// RNG 
-	std::default_random_engine engine;
-	std::uniform_int<int> dist(0, 25);
-	
-	// Iterators
-	auto begin = myVec.begin();
-	auto end = myVec.end();
+void initialize(std::vector<char> & myVec, std::uint64_t seed) {
 
-	// Assign random characters to each element
-	for (; begin != end; ++begin) {
-		engine.seed((unsigned int)std::chrono::system_clock::now().time_since_epoch().count());
-		*begin = ('A' + (char)dist(engine));
-	}
+	// Bulk RNG: seeded once, the same seed always gives the same characters
+	random_fill(myVec, 'A', 'Z', seed);
 }
 
 int main() {
 
 	// Create a vector populated with characters
 	const std::size_t SIZE = 20;
+	const std::uint64_t SEED = 2018;
 	std::vector<char> myVector(SIZE);
-	initialize(myVector);
-
-	// Result vectors
-	std::vector<char> increasing, decreasing;
+	initialize(myVector, SEED);
 
-	// Sort 
-	std::sort(myVector.begin(), myVector.end());  // O(n lg n)
+	// Sort
 
-	// Copy increasing
-	std::copy(myVector.begin(), myVector.end(), std::back_inserter(increasing));  // O(n)
+	// All values lie in 'A'..'Z': a single counting pass over 26 buckets,
+	// then the sorted values are written back in place, with no comparisons
+	counting_sort(myVector, 'A', 'Z');  // O(n)
 
-	// Copy decreasing
-	std::reverse_copy(myVector.begin(), myVector.end(), std::back_inserter(decreasing));  // O(n)
+	// Result views: increasing and decreasing order over the same buffer, no copies
+	sorted_view<char> sorted(myVector);  // O(1)
 
 	// Print results
 	std::cout << "Increasing:\n";
-	for (const double & elem : increasing)
+	for (const double & elem : sorted.ascending())
 		std::cout << elem << " ";
 	std::cout << "\n\n";
 
 	std::cout << "Decreasing:\n";
-	for (const double & elem : decreasing)
+	for (const double & elem : sorted.descending())
 		std::cout << elem << " ";
 	std::cout << "\n\n";
 
@@ -0,0 +1,548 @@
+/*
+ *	Performance in Development
+ *
+ *	Problem 2 benchmark: order statistics of a long intraday price series
+ *
+ *	Compares the exact median paths of the Native (full sort) and STL
+ *	(std::partial_sort, std::nth_element) solutions with the KLL quantile
+ *	sketch, single-stream and merged from shards, and the cost of loading
+ *	a day of ticks from CSV (std::getline + std::stod versus the mapped
+ *	parallel loader) and from a mapped binary tick file, and the throughput
+ *	of the sum, min/max and variance reductions per SIMD instruction set,
+ *	and rolling-window updates versus recomputing the window per tick,
+ *	and the batch report of 8,000 symbols per thread count, and the
+ *	selection of the k highest prices (sort, nth_element, partial_sort_copy
+ *	on copies versus the streaming top-k heap, sequential and sharded), and
+ *	the exact median, p95 and p99 (sorting, three nth_element calls, one
+ *	multiselect, and the sampled parallel selection without a full copy)
+ *
+ *	Usage: Problem2_Benchmark [max_size]
+ *
+ */
+
+// Include Standard Library headers
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <vector>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <numeric>
+
+#include "Batch_Stats.h"
+#include "Benchmark_Harness.h"
+#include "Order_Statistics.h"
+#include "Quantile_Sketch.h"
+#include "Random_Fill.h"
+#include "Rolling_Stats.h"
+#include "Running_Stats.h"
+#include "Simd_Reductions.h"
+#include "Tick_Loader.h"
+#include "Top_K.h"
+
+
+// Random walk around 25 $ with one-cent steps at most, reproducible from 'seed'
+std::vector<double> make_prices(std::size_t size, std::uint64_t seed) {
+	std::vector<double> prices(size);
+	random_fill(prices, -0.01, 0.01, seed);
+
+	double price = 25.0;
+	for (auto & elem : prices) {
+		price = std::max(0.01, price + elem);
+		elem = price;
+	}
+	return prices;
+}
+
+// Distance between the normalized rank of 'value' and the requested rank 'q'
+double rank_error(const std::vector<double> & sorted, double value, double q) {
+	const double rank = double(std::lower_bound(sorted.begin(), sorted.end(), value) - sorted.begin()) / double(sorted.size());
+	return std::abs(rank - q);
+}
+
+
+int main(int argc, char * argv[]) {
+
+	std::size_t max_size = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+	const std::uint64_t seed = 42;
+	const std::size_t shards = 16;
+	const std::vector<double> qs = { 0.5, 0.95, 0.99 };
+
+	std::cout << "Median [ns/element], sketch rank error for p50 / p95 / p99 (bound "
+		  << quantile_sketch<double>::error_bound(quantile_sketch<double>::default_k) << ")\n\n";
+
+	std::cout << std::setw(12) << "size"
+		  << std::setw(12) << "sort"
+		  << std::setw(14) << "partial_sort"
+		  << std::setw(14) << "nth_element"
+		  << std::setw(12) << "sketch"
+		  << std::setw(12) << "sharded"
+		  << std::setw(10) << "retained"
+		  << std::setw(30) << "rank error" << "\n";
+
+	for (std::size_t size = 1000; size <= max_size; size *= 10) {
+
+		const std::vector<double> prices = make_prices(size, seed);
+		std::vector<double> work;
+
+		// Native: full sort of a copy
+		double sorted = ns_per_element(size, [&] {
+			work = prices;
+			std::sort(work.begin(), work.end());
+		});
+		const std::vector<double> exact = work;
+
+		// STL: partial sort of half of a copy
+		double partial = ns_per_element(size, [&] {
+			work = prices;
+			std::partial_sort(work.begin(), work.begin() + size / 2 + 1, work.end());
+		});
+
+		// Selection on a copy
+		double selected = ns_per_element(size, [&] {
+			work = prices;
+			std::nth_element(work.begin(), work.begin() + size / 2, work.end());
+		});
+
+		// One sketch over the whole stream, no copy
+		quantile_sketch<double> sketch;
+		std::vector<double> estimates;
+		double streamed = ns_per_element(size, [&] {
+			for (const double & elem : prices)
+				sketch.push(elem);
+			estimates = sketch.quantiles(qs);
+		});
+
+		// One sketch per shard, merged at the end
+		std::vector<double> merged_estimates;
+		double sharded = ns_per_element(size, [&] {
+			quantile_sketch<double> merged;
+			for (std::size_t s = 0; s < shards; ++s) {
+				quantile_sketch<double> shard(quantile_sketch<double>::default_k, s);
+				for (std::size_t i = size * s / shards; i < size * (s + 1) / shards; ++i)
+					shard.push(prices[i]);
+				merged.merge(shard);
+			}
+			merged_estimates = merged.quantiles(qs);
+		});
+
+		std::cout << std::fixed << std::setprecision(2)
+			  << std::setw(12) << size
+			  << std::setw(12) << sorted
+			  << std::setw(14) << partial
+			  << std::setw(14) << selected
+			  << std::setw(12) << streamed
+			  << std::setw(12) << sharded
+			  << std::setw(10) << sketch.retained_size()
+			  << std::setprecision(4) << "    ";
+		for (std::size_t i = 0; i < qs.size(); ++i)
+			std::cout << rank_error(exact, estimates[i], qs[i]) << "/" << rank_error(exact, merged_estimates[i], qs[i]) << " ";
+		std::cout << "\n";
+	}
+
+	std::cout << "\n(rank error: single sketch / merged shards)\n";
+
+
+
+	// 2. Loading a day of ticks
+
+	{
+		const std::string csv_path = "Problem2_Benchmark.csv";
+		const std::string binary_path = "Problem2_Benchmark.ticks";
+
+		// One tick per millisecond
+		const std::vector<double> prices = make_prices(max_size, seed);
+		tick_series ticks;
+		ticks.reserve(max_size);
+		for (std::size_t i = 0; i < max_size; ++i)
+			ticks.push_back(epoch_nanos(1514903400000000000LL + std::int64_t(i) * 1000000), prices[i]);
+
+		{
+			std::ofstream csv(csv_path);
+			csv << "time,price\n" << std::setprecision(10);
+			for (std::size_t i = 0; i < ticks.size(); ++i)
+				csv << ticks.time(i) << "," << ticks.price(i) << "\n";
+		}
+		tick_file::write(binary_path, ticks);
+
+		std::ifstream size_probe(csv_path, std::ios::binary | std::ios::ate);
+		const double csv_bytes = double(size_probe.tellg());
+
+		// Line by line with std::getline and std::stod
+		tick_series naive;
+		double getline_time = ns_per_element(max_size, [&] {
+			std::ifstream csv(csv_path);
+			std::string line;
+			std::getline(csv, line);
+			while (std::getline(csv, line)) {
+				const std::size_t comma = line.find(',');
+				naive.push_back(epoch_nanos(std::stoll(line.substr(0, comma))), std::stod(line.substr(comma + 1)));
+			}
+		});
+
+		tick_series loaded;
+		double mapped_1 = ns_per_element(max_size, [&] { loaded = load_csv<tick_series>(csv_path, 1); });
+		double mapped_all = ns_per_element(max_size, [&] { loaded = load_csv<tick_series>(csv_path); });
+
+		// Binary: map, then one statistics pass straight over the mapped price column
+		running_stats<double> stats;
+		double binary = ns_per_element(max_size, [&] {
+			tick_file file(binary_path);
+			tick_series_view view = file.view();
+			stats.push(view.price_begin(), view.price_end());
+		});
+
+		if (loaded.size() != max_size || naive.size() != max_size || stats.count() != max_size
+		    || !std::equal(loaded.prices().begin(), loaded.prices().end(), naive.prices().begin())) {
+			std::cerr << "Loaded series mismatch\n";
+			return 1;
+		}
+
+		std::cout << "\nLoading " << max_size << " ticks (" << csv_bytes / 1e6 << " MB of CSV) [ns/record]\n"
+			  << std::setprecision(2)
+			  << "  getline + stod:       " << getline_time << "  (" << csv_bytes / (getline_time * max_size) << " GB/s)\n"
+			  << "  load_csv (1):         " << mapped_1 << "  (" << csv_bytes / (mapped_1 * max_size) << " GB/s)\n"
+			  << "  load_csv (all):       " << mapped_all << "  (" << csv_bytes / (mapped_all * max_size) << " GB/s)\n"
+			  << "  tick_file + stats:    " << binary << "\n";
+
+		std::remove(csv_path.c_str());
+		std::remove(binary_path.c_str());
+	}
+
+
+
+
+	// 3. Reductions per instruction set
+
+	{
+		const simd_level levels[] = { simd_level::scalar, simd_level::sse2, simd_level::avx2, simd_level::avx512 };
+		const char * kernels[] = { "sum", "min + max", "squared deviations" };
+
+		std::cout << "\nReductions [GB/s], this CPU dispatches to " << simd_level_name(simd_reductions::best_level())
+			  << " (L1-, L2- and memory-sized inputs)\n";
+
+		for (int kernel = 0; kernel < 3; ++kernel) {
+
+			std::cout << "\n" << kernels[kernel] << "\n"
+				  << std::setw(12) << "size" << std::setw(12) << "std";
+			for (simd_level level : levels)
+				std::cout << std::setw(12) << simd_level_name(level);
+			std::cout << std::setw(16) << "max rel. diff" << "\n";
+
+			for (std::size_t size : benchmark_sizes(max_size)) {
+
+				const std::vector<double> prices = make_prices(size, seed);
+				const double * first = prices.data();
+				const double * last = first + size;
+				const double mean = std::accumulate(first, last, 0.0) / double(size);
+
+				// Enough repetitions for about 10^8 elements per measurement
+				const std::size_t repeats = std::max<std::size_t>(1, 100000000 / size);
+				volatile double sink = 0;
+
+				auto gb_per_s = [&](double ns) { return double(sizeof(double)) / ns; };
+
+				// The reference: std algorithms, sequential
+				double reference = 0;
+				double std_time = ns_per_element(size * repeats, [&] {
+					for (std::size_t r = 0; r < repeats; ++r) {
+						if (kernel == 0)
+							reference = std::accumulate(first, last, 0.0);
+						else if (kernel == 1)
+							reference = *std::min_element(first, last) + *std::max_element(first, last);
+						else
+							reference = std::accumulate(first, last, 0.0, [mean](double sum, double x) { return sum + (x - mean) * (x - mean); });
+						sink = reference;
+					}
+				});
+
+				std::cout << std::setprecision(2)
+					  << std::setw(12) << size
+					  << std::setw(12) << gb_per_s(std_time);
+
+				double max_difference = 0;
+				for (simd_level level : levels) {
+					if (level > simd_reductions::best_level()) {
+						std::cout << std::setw(12) << "-";
+						continue;
+					}
+					const simd_reductions reductions = simd_reductions::for_level(level);
+
+					double result = 0;
+					double time = ns_per_element(size * repeats, [&] {
+						for (std::size_t r = 0; r < repeats; ++r) {
+							if (kernel == 0)
+								result = reductions.sum(first, size);
+							else if (kernel == 1) {
+								const min_max_result extremes = reductions.min_max(first, size);
+								result = extremes.min + extremes.max;
+							}
+							else
+								result = reductions.squared_deviations(first, size, mean);
+							sink = result;
+						}
+					});
+					max_difference = std::max(max_difference, std::abs(result - reference) / std::abs(reference));
+					std::cout << std::setw(12) << gb_per_s(time);
+				}
+				std::cout << std::setw(16) << std::scientific << max_difference << std::fixed << "\n";
+			}
+		}
+	}
+
+
+
+	// 4. Rolling window, per new tick
+
+	{
+		const std::size_t ticks = std::min<std::size_t>(max_size, 1000000);
+		const std::vector<double> prices = make_prices(ticks, seed);
+
+		std::cout << "\nRolling window of the last w ticks, mean + variance + min + max + median [ns/tick]\n\n"
+			  << std::setw(12) << "w"
+			  << std::setw(12) << "rolling"
+			  << std::setw(12) << "recompute"
+			  << std::setw(16) << "max median diff" << "\n";
+
+		for (std::size_t w : { std::size_t(100), std::size_t(10000) }) {
+
+			auto window = rolling_stats<epoch_nanos>::count_window(w);
+			std::vector<double> medians(ticks);
+			volatile double sink = 0;
+
+			double rolling = ns_per_element(ticks, [&] {
+				for (std::size_t i = 0; i < ticks; ++i) {
+					window.push(epoch_nanos(std::int64_t(i)), prices[i]);
+					sink = window.mean() + window.variance() + window.min() + window.max();
+					medians[i] = window.median();
+				}
+			});
+
+			// From scratch on every 100th tick: copy the window, one statistics pass, nth_element
+			std::vector<double> work;
+			double difference = 0;
+			std::size_t checked = 0;
+			double recompute = ns_per_element(1, [&] {
+				for (std::size_t i = 0; i < ticks; i += 100, ++checked) {
+					const std::size_t first = (i + 1 > w) ? i + 1 - w : 0;
+					work.assign(prices.begin() + first, prices.begin() + i + 1);
+
+					running_stats<double> stats;
+					stats.push(work.data(), work.data() + work.size());
+					sink = stats.mean() + stats.variance() + stats.min() + stats.max();
+
+					const std::size_t half = work.size() / 2;
+					std::nth_element(work.begin(), work.begin() + half, work.end());
+					double median = work[half];
+					if (work.size() % 2 == 0)
+						median = (median + *std::max_element(work.begin(), work.begin() + half)) / 2;
+
+					difference = std::max(difference, std::abs(median - medians[i]));
+				}
+			}) / double(checked);
+
+			std::cout << std::setprecision(2)
+				  << std::setw(12) << w
+				  << std::setw(12) << rolling
+				  << std::setw(12) << recompute
+				  << std::setw(16) << std::scientific << difference << std::fixed << "\n";
+		}
+	}
+
+
+
+	// 5. Batch report over many symbols
+
+	{
+		const std::size_t symbol_count = 8000;
+
+		// 100 to 2000 prices per symbol, all stored back to back
+		std::vector<std::size_t> lengths(symbol_count);
+		random_fill(lengths, std::size_t(100), std::size_t(2000), seed);
+
+		std::size_t total = 0;
+		for (std::size_t length : lengths)
+			total += length;
+		const std::vector<double> prices = make_prices(total, seed);
+
+		std::vector<epoch_nanos> times(2000);
+		for (std::size_t i = 0; i < times.size(); ++i)
+			times[i] = epoch_nanos(std::int64_t(i) * 1000000);
+
+		std::vector<tick_series_view> symbols;
+		symbols.reserve(symbol_count);
+		for (std::size_t i = 0, offset = 0; i < symbol_count; offset += lengths[i], ++i)
+			symbols.push_back(tick_series_view(times.data(), prices.data() + offset, lengths[i]));
+
+		std::cout << "\nBatch report of " << symbol_count << " symbols (" << total << " prices), per-symbol latency [us]\n\n"
+			  << std::setw(12) << "threads"
+			  << std::setw(14) << "symbols/s"
+			  << std::setw(12) << "speedup"
+			  << std::setw(12) << "p50"
+			  << std::setw(12) << "p95"
+			  << std::setw(12) << "p99" << "\n";
+
+		const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+		double single = 0;
+		std::vector<symbol_stats> first_reports;
+
+		for (unsigned threads = 1; threads <= hardware; threads = (threads == hardware) ? hardware + 1 : std::min(hardware, threads * 2)) {
+			work_stealing_pool pool(threads);
+			batch_timing timing;
+			std::vector<symbol_stats> reports = batch_stats(symbols, pool, &timing);
+
+			if (threads == 1) {
+				single = timing.throughput();
+				first_reports = reports;
+			}
+			else if (!std::equal(reports.begin(), reports.end(), first_reports.begin(),
+					     [](const symbol_stats & a, const symbol_stats & b) { return a.median == b.median && a.p99 == b.p99 && a.mean == b.mean; })) {
+				std::cerr << "Batch reports differ between thread counts\n";
+				return 1;
+			}
+
+			std::cout << std::setprecision(2)
+				  << std::setw(12) << threads
+				  << std::setw(14) << std::setprecision(0) << timing.throughput()
+				  << std::setw(12) << std::setprecision(2) << timing.throughput() / single
+				  << std::setw(12) << timing.latency_percentile(0.50) / 1000
+				  << std::setw(12) << timing.latency_percentile(0.95) / 1000
+				  << std::setw(12) << timing.latency_percentile(0.99) / 1000 << "\n";
+		}
+	}
+
+
+
+	// 6. The k highest prices
+
+	{
+		const std::vector<double> prices = make_prices(max_size, seed);
+		std::vector<epoch_nanos> times(max_size);
+		for (std::size_t i = 0; i < max_size; ++i)
+			times[i] = epoch_nanos(std::int64_t(i) * 1000000);
+		const tick_series_view series(times.data(), prices.data(), max_size);
+
+		std::cout << "\nTop k of " << max_size << " prices, highest first [ns/element]\n\n"
+			  << std::setw(12) << "k"
+			  << std::setw(12) << "sort"
+			  << std::setw(14) << "nth_element"
+			  << std::setw(16) << "partial_sort"
+			  << std::setw(12) << "top_k"
+			  << std::setw(16) << "parallel_top_k" << "\n";
+
+		for (std::size_t k : { std::size_t(5), std::size_t(100), std::size_t(10000) }) {
+			if (k > max_size)
+				break;
+
+			std::vector<double> work, expected;
+
+			// Native: sort a copy, read the back
+			double sorted = ns_per_element(max_size, [&] {
+				work = prices;
+				std::sort(work.begin(), work.end());
+				expected.assign(work.rbegin(), work.rbegin() + k);
+			});
+
+			// STL: select on a copy, then order the k selected
+			double selected = ns_per_element(max_size, [&] {
+				work = prices;
+				std::nth_element(work.begin(), work.begin() + k - 1, work.end(), std::greater<double>());
+				std::sort(work.begin(), work.begin() + k, std::greater<double>());
+			});
+
+			std::vector<double> partial(k);
+			double partial_time = ns_per_element(max_size, [&] {
+				std::partial_sort_copy(prices.begin(), prices.end(), partial.begin(), partial.end(), std::greater<double>());
+			});
+
+			std::vector<top_k_entry<double, epoch_nanos>> streamed, sharded;
+			double streamed_time = ns_per_element(max_size, [&] { streamed = top_k(series, k); });
+			double sharded_time = ns_per_element(max_size, [&] { sharded = parallel_top_k(series, k); });
+
+			bool same = std::equal(expected.begin(), expected.end(), work.begin()) && partial == expected
+				    && streamed.size() == k && sharded.size() == k;
+			for (std::size_t i = 0; same && i < k; ++i)
+				same = streamed[i].value == expected[i] && prices[std::size_t(streamed[i].time.count() / 1000000)] == expected[i]
+				       && sharded[i].value == streamed[i].value && sharded[i].time == streamed[i].time;
+			if (!same) {
+				std::cerr << "Top " << k << " mismatch\n";
+				return 1;
+			}
+
+			std::cout << std::setprecision(2)
+				  << std::setw(12) << k
+				  << std::setw(12) << sorted
+				  << std::setw(14) << selected
+				  << std::setw(16) << partial_time
+				  << std::setw(12) << streamed_time
+				  << std::setw(16) << sharded_time << "\n";
+		}
+	}
+
+
+
+	// 7. Exact median, p95 and p99
+
+	{
+		std::cout << "\nExact median (both middle values when even), p95 and p99 [ns/element]\n\n"
+			  << std::setw(12) << "size"
+			  << std::setw(12) << "sort"
+			  << std::setw(14) << "nth_element"
+			  << std::setw(14) << "multiselect"
+			  << std::setw(14) << "parallel_nth" << "\n";
+
+		// Odd and even sizes
+		for (std::size_t size = 1001; size <= max_size + 1; size = (size % 2 != 0) ? size * 10 - 10 : size * 10 + 1) {
+
+			const std::vector<double> prices = make_prices(size, seed);
+			std::vector<std::size_t> ranks = median_ranks(size);
+			ranks.push_back((std::size_t)std::ceil(0.95 * double(size)) - 1);
+			ranks.push_back((std::size_t)std::ceil(0.99 * double(size)) - 1);
+
+			std::vector<double> work, expected(ranks.size()), cascaded(ranks.size()), selected, parallel;
+
+			// Native: sort a copy
+			double sorted = ns_per_element(size, [&] {
+				work = prices;
+				std::sort(work.begin(), work.end());
+				for (std::size_t i = 0; i < ranks.size(); ++i)
+					expected[i] = work[ranks[i]];
+			});
+
+			// STL: one std::nth_element per rank on a copy, each above the previous one
+			double nth_time = ns_per_element(size, [&] {
+				work = prices;
+				for (std::size_t i = 0; i < ranks.size(); ++i) {
+					const std::size_t from = (i == 0) ? 0 : ranks[i - 1];
+					std::nth_element(work.begin() + from, work.begin() + ranks[i], work.end());
+					cascaded[i] = work[ranks[i]];
+				}
+			});
+
+			double multi_time = ns_per_element(size, [&] { selected = nth(prices, ranks); });
+			double parallel_time = ns_per_element(size, [&] { parallel = parallel_nth(prices.data(), prices.data() + size, ranks); });
+
+			const double exact_median = (expected[0] + expected[ranks.size() - 3]) / 2;
+			if (selected != expected || parallel != expected || cascaded != expected || median(prices) != exact_median) {
+				std::cerr << "Order statistics mismatch at size " << size << "\n";
+				return 1;
+			}
+
+			std::cout << std::setprecision(2)
+				  << std::setw(12) << size
+				  << std::setw(12) << sorted
+				  << std::setw(14) << nth_time
+				  << std::setw(14) << multi_time
+				  << std::setw(14) << parallel_time << "\n";
+		}
+	}
+
+	return 0;
+}
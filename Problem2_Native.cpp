@@ -9,194 +9,154 @@
 
 // Include Standard Library headers
 #include <iostream>
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <utility> // std::pair
 
+#include "Order_Statistics.h"
+#include "Price_Series.h"
+#include "Quantile_Sketch.h"
+#include "Rolling_Stats.h"
+#include "Tick_Loader.h"
+#include "Running_Stats.h"
+#include "Top_K.h"
 
-// O(n lg n) Quicksort
 
-// Partition auxiliary function for quicksort
-template <class Type>
-int partition(std::vector<Type> & myVector, int begin, int end) {
-	Type x = myVector[end];
-	int i = begin - 1;
-	for (unsigned j = begin; j < end; j++) {
-		if (myVector[j] <= x) {
-			i++;
-			std::swap(myVector[j], myVector[i]);
-		}
-	}
-	std::swap(myVector[i + 1], myVector[end]);
-	return i + 1;
-}
-
-// Recursive Quicksort algorithm
-template <class Type>
-void myQuicksort(std::vector<Type> & myVector, int begin, int end) {
-	if (begin < end) {
-		int mid = partition(myVector, begin, end);
-		myQuicksort(myVector, begin, mid - 1);
-		myQuicksort(myVector, mid + 1, end);
-	}
-}
-
-int main() {
+int main(int argc, char * argv[]) {
 
 	// 1. Get the prices
 
 	// Daily stock prices, updated every 30 minutes
-	// std::pair
-	// http://en.cppreference.com/w/cpp/utility/pair
+	// Columnar series: the times are parsed into 2-byte minutes since midnight
+	// and the prices are stored in one contiguous column, with no string per record
 
-	std::vector<std::pair<std::string, double>> input_prices =
+	intraday_series input_prices =
 
 	{ { "09:30AM", 23.29 },{ "10:00AM", 22.11 },{ "10:30AM", 23.42 },{ "11:00AM", 23.64 },{ "11:30AM", 22.95 },
 	{ "12:00PM", 22.81 },{ "12:30PM", 22.98 },{ "01:00PM", 24.65 },{ "01:30PM", 25.10 },{ "02:00PM", 25.12 },
 	{ "02:30PM", 25.96 },{ "03:00PM", 24.98 },{ "03:30PM", 24.65 },{ "04:00PM", 23.45 } };
 
+	// Or load a whole day from a "time,price" CSV file, one "09:30AM,23.29" record per line
+	if (argc > 1) {
+		try {
+			input_prices = load_csv<intraday_series>(argv[1]);
+		}
+		catch (const std::exception & error) {
+			std::cerr << error.what() << "\n";
+			return 1;
+		}
+		if (input_prices.empty()) {
+			std::cerr << "No prices in " << argv[1] << "\n";
+			return 1;
+		}
+	}
 
 
 
-	// 2. Process the prices 
-
-	// Get a non-zero size
-	std::size_t size;
-	(input_prices.size() != 0) ? size = input_prices.size() : size = 1;
-
-	// Convert values to a vector
-	std::vector<double> prices;
 
-	// C++ ranged-based for loop 
-	// Get the numeric values i.e. 
-	// elem.first = key
-	// elem.second = value
+	// 2. Process the prices 
 
-	for (auto & elem : input_prices) 
-		prices.push_back(elem.second);
+	// The prices already are one contiguous column: no conversion, no copy
+	const std::vector<double> & prices = input_prices.prices();
 
 
 
 	// 3. Compute statistics
 
-		// i. Average price
-
-	double daily_average = 0.0;
-
-	for (const double & elem : prices)
-		daily_average += elem;
-
-	daily_average /= (double)size;
-
-	
-
-
-		// ii. Median price
-
-	double daily_median = 0.0;
-
-	myQuicksort(prices, 0, size - 1);
-	
-	daily_median = prices[size / 2 - 1];
-
+		// i. Average, variance, max, min and range in a single pass
 
-		// iii. Max price
+	// Welford's update keeps the variance accurate without a second pass
+	// over the prices; open and close are the first and last values seen
+	// The bulk push runs straight on the price column
+	running_stats<double> stats;
+	stats.push(input_prices.price_begin(), input_prices.price_end());
 
-	double max_price = 0.0;
-	
-	auto first = std::begin(prices);
-	auto last = std::end(prices);
+	double daily_average = stats.mean();
+	double variance = stats.variance();	// unbiased
+	double max_price = stats.max();
+	double min_price = stats.min();
+	double price_range = stats.range();
 
-	if (first != last)
-		max_price = *first++;
 
-	for (const double & elem : prices) 
-		if (elem > max_price)
-			max_price = elem;
-	
-	
-	// Since 'prices' is a sorted vector from computing the median,
-	// we could instead do the following:
-	// max_price = prices[size - 1]; // last element is the largest
+		// ii. Median price and upper percentiles
 
+	// Exact median: introselect on one copy, 'prices' keeps its time order
+	// An even number of prices gives the mean of the two middle ones
+	double daily_median = median(prices);
 
-		// iv. Min price
-	
-	double min_price = 0.0;
-
-	first = prices.begin();
-	last = prices.end();
-
-	if (first != last)
-		min_price = *first++;
+	// Streaming KLL sketch for the percentiles: bounded memory, no reordering
+	// of 'prices', exact for short series such as this one
+	quantile_sketch<double> sketch;
 
 	for (const double & elem : prices)
-		if (elem < min_price)
-			min_price = elem;
+		sketch.push(elem);
 
-	// Since 'prices' is a sorted vector from computing the median,
-	// we could instead do the following:
-	// max_price = prices[0]; // first element is the smallest
+	std::vector<double> percentiles = sketch.quantiles({ 0.95, 0.99 });
 
+	double p95_price = percentiles[0];
+	double p99_price = percentiles[1];
 
-		// v. Price range
 
-	double price_range = 0.0;
-	price_range = std::abs(max_price - min_price);
+		// iii. Max 5 prices
 
+	// One pass over the series with a 5-entry heap: no copy, no sort,
+	// most prices cost a single comparison with the weakest peak kept so far
+	top_k_selector<double, clock_minutes> peaks(5);
 
-		// v. Max 5 prices
+	for (std::size_t i = 0; i < input_prices.size(); ++i)
+		peaks.push(input_prices.price(i), input_prices.time(i));
 
-	std::vector<double> max_5_prices(5);
-	
-	// Since 'prices' is a sorted vector from computing the median,
-	// we can do the following:
-	for (unsigned i = 0; i < 5; ++i)
-		max_5_prices[i] = prices[size - 1 - i];
+	// Highest first, with the time of each peak; fewer than 5 prices give fewer peaks
+	std::vector<top_k_entry<double, clock_minutes>> max_5_prices = peaks.sorted();
 
-	// Alternatively, we would have to sort the vector first and then copy the values
 
+		// iv. Rolling statistics of the last 2 hours, after every update
 
-		// vi. Variance
+	// Each new price updates the window in O(lg n) instead of recomputing the day
+	rolling_stats<clock_minutes> last_2_hours = rolling_stats<clock_minutes>::time_window(120);
 
-	double variance = 0.0;
+	struct rolling_row { double mean, median, min, max; };
+	std::vector<rolling_row> rolling(input_prices.size());
 
-	for (const double & elem : prices) 
-		variance += std::pow(elem - daily_average, 2);
-	
-	// Compute the unbiased variance
-	variance /= (double)(size - 1);
+	for (std::size_t i = 0; i < input_prices.size(); ++i) {
+		last_2_hours.push(input_prices.time(i), input_prices.price(i));
+		rolling[i] = { last_2_hours.mean(), last_2_hours.median(), last_2_hours.min(), last_2_hours.max() };
+	}
 
 
 
 
 	// 4. Print statistics
 
-	// Print input prices
+	// Print input prices, with the statistics of the 2 hours up to each update
 
-	std::cout << "Daily prices: [$]\n\n";
-	for (const auto & price_pair : input_prices) {
-		std::cout << price_pair.first << "\t" << price_pair.second << "\n";
+	std::cout << "Daily prices: [$]\t\tLast 2 hours: mean\tmedian\tmin\tmax\n\n";
+	for (std::size_t i = 0; i < input_prices.size(); ++i) {
+		std::cout << input_prices.time(i) << "\t" << input_prices.price(i) << "\t\t\t"
+			  << rolling[i].mean << "\t" << rolling[i].median << "\t" << rolling[i].min << "\t" << rolling[i].max << "\n";
 	}
 	
 
 	// Print statistics
 
 	std::cout	<< "\n\n";
-	std::cout	<< "Open: "		<< input_prices.begin()->second		<< " [$]\n"
-			<< "Close: "		<< (input_prices.end() - 1)->second	<< " [$]\n\n"
+	std::cout	<< "Open: "		<< stats.open()				<< " [$]\n"
+			<< "Close: "		<< stats.close()			<< " [$]\n\n"
 			<< "Average price: "	<< daily_average			<< " [$]\n"
 			<< "Variance: "		<< variance				<< "\n"
-			<< "Median price: "	<< daily_median				<< " [$]\n\n"
+			<< "Median price: "	<< daily_median				<< " [$]\n"
+			<< "95th percentile: "	<< p95_price				<< " [$]\n"
+			<< "99th percentile: "	<< p99_price				<< " [$]\n\n"
 			<< "Max price: "	<< max_price				<< " [$]\n"
 			<< "Min price: "	<< min_price				<< " [$]\n"
 			<< "Price range: "	<< price_range				<< " [$]\n\n"
-			<< "Top 5 price peaks: [$]\t";
+			<< "Top 5 price peaks: [$]\n";
 
 
-	for (const double & elem : max_5_prices)
-		std::cout << elem << "\t";
-	std::cout << "\n\n";
+	for (const auto & peak : max_5_prices)
+		std::cout << peak.time << "\t" << peak.value << "\n";
+	std::cout << "\n";
 
 	return 0;
 }
@@ -16,132 +16,98 @@
 #include <iterator>
 #include <utility> // pair
 
-// Policy (callable object / functor)
+#include "Order_Statistics.h"
+#include "Price_Series.h"
+#include "Quantile_Sketch.h"
+#include "Tick_Loader.h"
+#include "Running_Stats.h"
+#include "Top_K.h"
 
-// Use this predicate for comparison sorting condition
-// Will sort in decreasing order
-template <class Numeric>
-struct decreasing_order {
-	bool operator()(const Numeric & a, const Numeric & b)
-		{ return a > b;	}
-};
 
-
-int main() {
+int main(int argc, char * argv[]) {
 
 	// 1. Get the prices
 
 	// Daily stock prices, updated every 30 minutes
-	// std::pair
-	// http://en.cppreference.com/w/cpp/utility/pair
+	// Columnar series: the times are parsed into 2-byte minutes since midnight
+	// and the prices are stored in one contiguous column, with no string per record
 
-	std::vector<std::pair<std::string, double>> input_prices =
+	intraday_series input_prices =
 	{ {"09:30AM", 23.29}, {"10:00AM", 22.11}, {"10:30AM", 23.42}, {"11:00AM", 23.64}, {"11:30AM", 22.95},
 	  {"12:00PM", 22.81}, {"12:30PM", 22.98}, {"01:00PM", 24.65}, {"01:30PM", 25.10}, {"02:00PM", 25.12},
 	  {"02:30PM", 25.96}, {"03:00PM", 24.98}, {"03:30PM", 24.65}, {"04:00PM", 23.45} };
+
+	// Or load a whole day from a "time,price" CSV file, one "09:30AM,23.29" record per line
+	if (argc > 1) {
+		try {
+			input_prices = load_csv<intraday_series>(argv[1]);
+		}
+		catch (const std::exception & error) {
+			std::cerr << error.what() << "\n";
+			return 1;
+		}
+		if (input_prices.empty()) {
+			std::cerr << "No prices in " << argv[1] << "\n";
+			return 1;
+		}
+	}
 	
 
 
 
 	// 2. Process the prices 
 
-	// Get a non-zero size
-	std::size_t size;
-	(input_prices.size() != 0) ? size = input_prices.size() : size = 1;
-
-	// Convert values to a vector
-	std::vector<double> prices;
-
-	// Range-based C++11 for loop
-	// http://en.cppreference.com/w/cpp/language/range-for
-	// Get the numeric values i.e. 
-	// elem.first = key
-	// elem.second = value
-	// Notice: In STL there is no built-in method to get all keys or values from a map
-
-	for (const auto & elem : input_prices) 
-		prices.push_back(elem.second);
+	// The prices already are one contiguous column: no conversion, no copy
+	const std::vector<double> & prices = input_prices.prices();
 
 
 
 
 	// 3. Compute statistics
 
-		// i. Average price
-
-	// std::accumulate
-	// http://en.cppreference.com/w/cpp/algorithm/accumulate
-
-	double daily_average = 0.0;
-	daily_average = std::accumulate(std::begin(prices), std::end(prices), 0.0);
-	daily_average /= (double)size;
-	
-
-		// ii. Median price
-
-	// std::partial_sort
-	// http://en.cppreference.com/w/cpp/algorithm/partial_sort
-
-	double daily_median = 0.0;
-	std::partial_sort(std::begin(prices), std::begin(prices) + (size / 2) + 1, std::end(prices));
+		// i. Average, variance, max, min and range in a single pass
 
-	daily_median = prices[size / 2  - 1];
-
-
-		// iii. Max price
-
-	// std::max_element
-	// http://en.cppreference.com/w/cpp/algorithm/max_element
-	// Notice: max_element returns the iterator to the max element
-
-	double max_price = 0.0;
-	std::vector<double>::iterator max_price_position = std::max_element(std::begin(prices), std::end(prices));
-	if (max_price_position != prices.end())
-		max_price = *max_price_position;
-
-
-		// iv. Min price
+	// std::for_each returns its functor, here a running_stats accumulator
+	// http://en.cppreference.com/w/cpp/algorithm/for_each
+	// Welford's update keeps the variance accurate without a second pass
+	// over the prices; open and close are the first and last values seen
 
-	// std::min_element
-	// http://en.cppreference.com/w/cpp/algorithm/min_element
-	// Notice: min_element returns the iterator to the min element
+	running_stats<double> stats = std::for_each(std::begin(prices), std::end(prices), running_stats<double>());
 
-	double min_price = 0.0;
-	auto min_price_position = std::min_element(std::begin(prices), std::end(prices));
-	if (min_price_position != std::end(prices)) 
-		min_price = *min_price_position;
+	double daily_average = stats.mean();
+	double variance = stats.variance();	// unbiased
+	double max_price = stats.max();
+	double min_price = stats.min();
+	double price_range = stats.range();
 	
 
-		// v. Price range
-
-	double price_range = 0.0;
-	price_range = std::abs(max_price - min_price);
+		// ii. Median price and upper percentiles
 
+	// median() selects both middle ranks of an even count in one introselect
+	// pass (the algorithm behind std::nth_element) on a copy, and averages them
+	// http://en.cppreference.com/w/cpp/algorithm/nth_element
 
-		// v. Max 5 prices
+	double daily_median = median(prices);
 
-	// std::nth_element
-	// http://en.cppreference.com/w/cpp/algorithm/nth_element
+	// A KLL sketch is also a functor, so std::for_each can feed it
+	// Bounded memory and no reordering of 'prices'; exact for short series such as this one
 
-	std::vector<double> max_5_prices;
-	std::nth_element(std::begin(prices), std::begin(prices) + 5, std::end(prices), decreasing_order<double>());
-	
-	std::copy(std::begin(prices), std::begin(prices) + 5, std::back_inserter(max_5_prices));
+	quantile_sketch<double> sketch = std::for_each(std::begin(prices), std::end(prices), quantile_sketch<double>());
+	std::vector<double> percentiles = sketch.quantiles({ 0.95, 0.99 });
 
+	double p95_price = percentiles[0];
+	double p99_price = percentiles[1];
 
-		// vi. Variance
 
-	// std::for_each with a lambda function (Bonus: what is lambda function?)
-	// http://en.cppreference.com/w/cpp/algorithm/for_each
-	// http://en.cppreference.com/w/cpp/language/lambda
+		// iii. Max 5 prices
 
-	double variance = 0.0;
-	std::for_each(std::begin(prices), std::end(prices), [&](double elem) {
-		variance += std::pow(elem - daily_average, 2);
-	});
+	// top_k keeps a 5-entry heap (std::push_heap, std::pop_heap, std::sort_heap)
+	// while reading the series once: unlike std::nth_element on a copy, nothing
+	// is copied or reordered, and the peaks come out sorted with their times
+	// http://en.cppreference.com/w/cpp/algorithm/push_heap
 
-	// Compute the unbiased variance
-	variance /= (double)(size - 1);
+	// Highest first; fewer than 5 prices give fewer peaks
+	std::vector<top_k_entry<double, clock_minutes>> max_5_prices = top_k(input_prices, 5);
 
 
 
@@ -149,26 +115,28 @@ int main() {
 
 	// Print input prices
 	std::cout << "Daily prices: [$]\n\n";
-	for (const auto & price_pair : input_prices) {
-		std::cout << price_pair.first << "\t" << price_pair.second << "\n";
+	for (std::size_t i = 0; i < input_prices.size(); ++i) {
+		std::cout << input_prices.time(i) << "\t" << input_prices.price(i) << "\n";
 	}
 
 	// Print statistics
 
 	std::cout   	<< "\n\n";
-	std::cout   	<< "Open: "			<< input_prices.begin()->second		<< " [$]\n" 
-			<< "Close: "			<< (input_prices.end() - 1)->second	<< " [$]\n\n"
+	std::cout   	<< "Open: "			<< stats.open()				<< " [$]\n" 
+			<< "Close: "			<< stats.close()			<< " [$]\n\n"
 			<< "Average price: "		<< daily_average			<< " [$]\n"
 			<< "Variance: " 		<< variance				<< "\n"
-			<< "Median price: "		<< daily_median				<< " [$]\n\n"
+			<< "Median price: "		<< daily_median				<< " [$]\n"
+			<< "95th percentile: "		<< p95_price				<< " [$]\n"
+			<< "99th percentile: "		<< p99_price				<< " [$]\n\n"
 			<< "Max price: "		<< max_price				<< " [$]\n"
 			<< "Min price: "		<< min_price				<< " [$]\n"
 			<< "Price range: "		<< price_range				<< " [$]\n\n"
-			<< "Top 5 price peaks: [$]\t";
+			<< "Top 5 price peaks: [$]\n";
 	
-	for (const double & elem : max_5_prices)
-		std::cout << elem << "\t";
-	std::cout << "\n\n";
+	for (const auto & peak : max_5_prices)
+		std::cout << peak.time << "\t" << peak.value << "\n";
+	std::cout << "\n";
 	
 	return 0;
 }
@@ -0,0 +1,228 @@
+/*
+ *	Quantile Sketch
+ *
+ *	KLL streaming quantile sketch: approximate median, p95, p99, ... of a
+ *	stream in bounded memory, mergeable across shards
+ *
+ *	Values go into a stack of compactors. A full compactor sorts itself and
+ *	promotes every other value (random offset) to the next level, where each
+ *	value stands for twice as many inputs. Capacities shrink geometrically
+ *	towards the lower levels, so memory stays O(k) for any stream length.
+ *
+ *	The accuracy parameter k sets the rank error: with k = 200 the returned
+ *	value's rank is within about 1.3% of n of the requested rank, with 99%
+ *	confidence. Streams shorter than k are kept whole and answered exactly.
+ *
+ *	Karnin, Lang and Liberty, "Optimal Quantile Approximation in Streams", 2016
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Random_Fill.h" // splitmix64
+
+
+template <class Type>
+class quantile_sketch {
+public:
+
+	static const std::size_t default_k = 200;
+
+	// Smallest k whose normalized rank error is at most 'epsilon' (99% confidence)
+	// Empirical fit published with the Apache DataSketches KLL implementation
+	static std::size_t k_for_error(double epsilon) {
+		if (!(epsilon > 0.0 && epsilon < 1.0))
+			throw std::invalid_argument("quantile_sketch: epsilon must lie in (0, 1)");
+		return std::max<std::size_t>(8, (std::size_t)std::ceil(std::pow(2.296 / epsilon, 1.0 / 0.9723)));
+	}
+
+	// Normalized rank error (99% confidence) for accuracy parameter k
+	static double error_bound(std::size_t k) { return 2.296 / std::pow(double(k), 0.9723); }
+
+	explicit quantile_sketch(std::size_t k = default_k, std::uint64_t seed = 0x5EED)
+		: k(std::max<std::size_t>(k, 8)), n(0), retained(0), random_state(seed), random_bits(0), random_left(0),
+		  minimum(std::numeric_limits<Type>::max()), maximum(std::numeric_limits<Type>::lowest()),
+		  levels(1) { update_capacities(); }
+
+	// Add one value, amortized O(lg k)
+	void push(const Type & value) {
+		minimum = std::min(minimum, value);
+		maximum = std::max(maximum, value);
+
+		levels[0].push_back(value);
+		++n;
+		++retained;
+		while (retained >= capacity_total)
+			compress();
+	}
+
+	void operator()(const Type & value) { push(value); }
+
+	// Absorb another sketch, e.g. one per shard or per thread
+	void merge(const quantile_sketch & other) {
+		if (other.n == 0)
+			return;
+
+		if (levels.size() < other.levels.size()) {
+			levels.resize(other.levels.size());
+			update_capacities();
+		}
+		for (std::size_t h = 0; h < other.levels.size(); ++h)
+			levels[h].insert(levels[h].end(), other.levels[h].begin(), other.levels[h].end());
+
+		n += other.n;
+		retained += other.retained;
+		minimum = std::min(minimum, other.minimum);
+		maximum = std::max(maximum, other.maximum);
+
+		while (retained >= capacity_total)
+			compress();
+	}
+
+	// Value at normalized rank q in [0, 1]
+	Type quantile(double q) const {
+		return quantiles(std::vector<double>(1, q))[0];
+	}
+
+	// Several quantiles with a single sort of the retained values
+	// O(k lg k); throws std::domain_error on an empty sketch
+	std::vector<Type> quantiles(const std::vector<double> & qs) const {
+		if (n == 0)
+			throw std::domain_error("quantile_sketch: no values");
+
+		// (value, weight): a value on level h stands for 2^h inputs
+		std::vector<std::pair<Type, std::uint64_t>> weighted;
+		weighted.reserve(retained);
+		for (std::size_t h = 0; h < levels.size(); ++h)
+			for (const Type & value : levels[h])
+				weighted.push_back(std::make_pair(value, std::uint64_t(1) << h));
+
+		std::sort(weighted.begin(), weighted.end(),
+			  [](const std::pair<Type, std::uint64_t> & a, const std::pair<Type, std::uint64_t> & b) { return a.first < b.first; });
+
+		std::uint64_t total = 0;
+		for (const auto & item : weighted)
+			total += item.second;
+
+		std::vector<Type> result;
+		result.reserve(qs.size());
+		for (double q : qs) {
+			if (q <= 0.0) {
+				result.push_back(minimum);
+				continue;
+			}
+			if (q >= 1.0) {
+				result.push_back(maximum);
+				continue;
+			}
+
+			// First value whose cumulative weight reaches q * total
+			const double target = q * double(total);
+			std::uint64_t cumulative = 0;
+			Type value = maximum;
+			for (const auto & item : weighted) {
+				cumulative += item.second;
+				if (double(cumulative) >= target) {
+					value = item.first;
+					break;
+				}
+			}
+			result.push_back(value);
+		}
+		return result;
+	}
+
+	Type median() const { return quantile(0.5); }
+
+	std::size_t count() const { return n; }
+	bool empty() const { return n == 0; }
+	Type min() const { return minimum; }
+	Type max() const { return maximum; }
+
+	// Values currently held: the memory footprint, O(k)
+	std::size_t retained_size() const { return retained; }
+
+	// Normalized rank error of this sketch (99% confidence)
+	double error_bound() const { return error_bound(k); }
+
+private:
+
+	// Level h of H holds at most k * (2/3)^(H - 1 - h) values, and never fewer than 2
+	// Recomputed only when a level is added
+	void update_capacities() {
+		capacities.resize(levels.size());
+		capacity_total = 0;
+		for (std::size_t h = 0; h < levels.size(); ++h) {
+			const double depth = double(levels.size() - 1 - h);
+			capacities[h] = std::max<std::size_t>(2, (std::size_t)std::ceil(double(k) * std::pow(2.0 / 3.0, depth)));
+			capacity_total += capacities[h];
+		}
+	}
+
+	// Compact the lowest full level, O(capacity lg capacity)
+	void compress() {
+		for (std::size_t h = 0; h < levels.size(); ++h) {
+			if (levels[h].size() < capacities[h])
+				continue;
+
+			if (h + 1 == levels.size()) {
+				levels.emplace_back();
+				update_capacities();
+			}
+
+			std::vector<Type> & level = levels[h];
+			std::sort(level.begin(), level.end());
+
+			// An odd value out stays behind
+			const bool odd = level.size() % 2 != 0;
+			Type kept = odd ? level.back() : Type();
+			if (odd)
+				level.pop_back();
+
+			// Every other value, starting at a random offset, moves up with double weight
+			const std::size_t before = level.size();
+			for (std::size_t i = random_bit(); i < before; i += 2)
+				levels[h + 1].push_back(level[i]);
+			retained -= before / 2;
+
+			level.clear();
+			if (odd)
+				level.push_back(kept);
+			return;
+		}
+	}
+
+	std::size_t random_bit() {
+		if (random_left == 0) {
+			random_bits = splitmix64(random_state);
+			random_left = 64;
+		}
+		--random_left;
+		const std::size_t bit = std::size_t(random_bits & 1);
+		random_bits >>= 1;
+		return bit;
+	}
+
+	std::size_t k;
+	std::size_t n;
+	std::size_t retained;
+
+	std::uint64_t random_state;
+	std::uint64_t random_bits;
+	unsigned random_left;
+
+	Type minimum, maximum;
+	std::vector<std::vector<Type>> levels;
+	std::vector<std::size_t> capacities;
+	std::size_t capacity_total;
+};
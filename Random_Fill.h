@@ -0,0 +1,203 @@
+/*
+ *	Bulk Random Fill
+ *
+ *	Seeded, reproducible random fill for large buffers
+ *
+ *	The buffer is cut into fixed-size blocks and every block draws from its own
+ *	xoshiro256+ stream, derived from (seed, block index) with splitmix64.
+ *	The output therefore depends only on the seed, never on the thread count.
+ *	Each stream keeps 4 generators side by side in structure-of-arrays form,
+ *	so the compiler can vectorize the state update across the lanes.
+ *
+ *	xoshiro256+ by D. Blackman and S. Vigna: http://prng.di.unimi.it/
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+
+// splitmix64: turns any 64-bit value into a well-mixed 64-bit value
+inline std::uint64_t splitmix64(std::uint64_t & state) {
+	std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+
+// Four independent xoshiro256+ generators updated in lock step
+class xoshiro256_x4 {
+public:
+
+	static const std::size_t lanes = 4;
+
+	xoshiro256_x4(std::uint64_t seed, std::uint64_t stream) {
+		std::uint64_t state = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+		for (std::size_t i = 0; i < lanes; ++i) {
+			s0[i] = splitmix64(state);
+			s1[i] = splitmix64(state);
+			s2[i] = splitmix64(state);
+			s3[i] = splitmix64(state);
+		}
+	}
+
+	// Write the next output of every lane
+	void next(std::uint64_t out[lanes]) {
+		for (std::size_t i = 0; i < lanes; ++i) {
+			out[i] = s0[i] + s3[i];
+			const std::uint64_t t = s1[i] << 17;
+			s2[i] ^= s0[i];
+			s3[i] ^= s1[i];
+			s1[i] ^= s2[i];
+			s0[i] ^= s3[i];
+			s2[i] ^= t;
+			s3[i] = (s3[i] << 45) | (s3[i] >> 19);
+		}
+	}
+
+private:
+	std::uint64_t s0[lanes], s1[lanes], s2[lanes], s3[lanes];
+};
+
+
+namespace random_fill_detail {
+
+	// Elements per independent stream
+	const std::size_t block_size = std::size_t(1) << 16;
+
+	// High 64 bits of the 128-bit product a b
+	inline std::uint64_t multiply_high(std::uint64_t a, std::uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+		__extension__ typedef unsigned __int128 uint128;	// not ISO C++: keeps -Wpedantic quiet
+		return std::uint64_t(uint128(a) * b >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		return __umulh(a, b);
+#else
+		const std::uint64_t a_low = a & 0xFFFFFFFFULL, a_high = a >> 32, b_low = b & 0xFFFFFFFFULL, b_high = b >> 32;
+		const std::uint64_t middle = (a_low * b_low >> 32) + (a_high * b_low & 0xFFFFFFFFULL) + a_low * b_high;
+		return a_high * b_high + (a_high * b_low >> 32) + (middle >> 32);
+#endif
+	}
+
+	// Integers in [low, high]
+	// The engine is passed by value: a local copy cannot alias the output,
+	// so its state stays in registers while writing through char pointers
+	// Multiply-shift maps 32 random bits to ranges up to 2^32 wide, with a bias below
+	// width / 2^32, and 64 bits to wider ones
+	template <class Type>
+	void fill_block(Type * first, Type * last, Type low, Type high, xoshiro256_x4 engine, std::true_type) {
+		// Modulo 2^64, so 0 stands for the full 64-bit range
+		const std::uint64_t width = std::uint64_t(high) - std::uint64_t(low) + 1;
+		std::uint64_t bits[xoshiro256_x4::lanes];
+
+		if (width == 0 || width > (std::uint64_t(1) << 32)) {
+			auto map = [=](std::uint64_t bits64) { return Type(std::uint64_t(low) + (width ? multiply_high(bits64, width) : bits64)); };
+			for (; std::size_t(last - first) >= xoshiro256_x4::lanes; first += xoshiro256_x4::lanes) {
+				engine.next(bits);
+				for (std::size_t i = 0; i < xoshiro256_x4::lanes; ++i)
+					first[i] = map(bits[i]);
+			}
+			engine.next(bits);
+			for (std::size_t i = 0; first != last; ++i)
+				*first++ = map(bits[i]);
+			return;
+		}
+
+		const std::size_t step = 2 * xoshiro256_x4::lanes;
+		auto map = [=](std::uint64_t bits32) { return Type(std::uint64_t(low) + ((bits32 * width) >> 32)); };
+
+		// Two values per 64-bit output, no per-element branches in the main loop
+		for (; std::size_t(last - first) >= step; first += step) {
+			engine.next(bits);
+			for (std::size_t i = 0; i < xoshiro256_x4::lanes; ++i) {
+				first[2 * i] = map(bits[i] >> 32);
+				first[2 * i + 1] = map(bits[i] & 0xFFFFFFFFULL);
+			}
+		}
+
+		engine.next(bits);
+		for (std::size_t i = 0; first != last; ++i)
+			*first++ = map((i % 2 == 0) ? (bits[i / 2] >> 32) : (bits[i / 2] & 0xFFFFFFFFULL));
+	}
+
+	// Reals in [low, high), from as many top bits as the mantissa holds
+	// low + x (high - low) may still round up to high: such values become the largest below it
+	template <class Type>
+	void fill_block(Type * first, Type * last, Type low, Type high, xoshiro256_x4 engine, std::false_type) {
+		const int digits = std::numeric_limits<Type>::digits < 64 ? std::numeric_limits<Type>::digits : 64;
+		const Type scale = (high - low) * std::ldexp(Type(1), -digits);
+		const Type below_high = std::nextafter(high, low);
+		std::uint64_t bits[xoshiro256_x4::lanes];
+
+		auto map = [=](std::uint64_t bits64) {
+			const Type value = low + Type(bits64 >> (64 - digits)) * scale;
+			return value < high ? value : below_high;
+		};
+
+		for (; std::size_t(last - first) >= xoshiro256_x4::lanes; first += xoshiro256_x4::lanes) {
+			engine.next(bits);
+			for (std::size_t i = 0; i < xoshiro256_x4::lanes; ++i)
+				first[i] = map(bits[i]);
+		}
+
+		engine.next(bits);
+		for (std::size_t i = 0; first != last; ++i)
+			*first++ = map(bits[i]);
+	}
+}
+
+
+// Fill [first, last) with values uniformly distributed in [low, high] (integral Type)
+// or [low, high) (floating-point Type), reproducible from 'seed'
+// O(n / threads); threads == 0 uses std::thread::hardware_concurrency()
+template <class Type>
+void random_fill(Type * first, Type * last, Type low, Type high, std::uint64_t seed, unsigned threads = 0) {
+
+	static_assert(std::is_arithmetic<Type>::value, "random_fill needs an arithmetic type");
+
+	const std::size_t n = std::size_t(last - first);
+	const std::size_t blocks = (n + random_fill_detail::block_size - 1) / random_fill_detail::block_size;
+
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	threads = (unsigned)std::min<std::size_t>(threads, std::max<std::size_t>(1, blocks));
+
+	// Every thread takes a contiguous run of blocks
+	auto fill_blocks = [=](std::size_t block_first, std::size_t block_last) {
+		for (std::size_t b = block_first; b < block_last; ++b) {
+			xoshiro256_x4 engine(seed, b);
+			Type * block_begin = first + b * random_fill_detail::block_size;
+			Type * block_end = first + std::min(n, (b + 1) * random_fill_detail::block_size);
+			random_fill_detail::fill_block(block_begin, block_end, low, high, engine,
+						       std::integral_constant<bool, std::is_integral<Type>::value>());
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned t = 1; t < threads; ++t)
+		workers.emplace_back(fill_blocks, blocks * t / threads, blocks * (t + 1) / threads);
+	fill_blocks(0, blocks / threads);
+
+	for (auto & worker : workers)
+		worker.join();
+}
+
+// Convenience overload for vectors
+template <class Type>
+void random_fill(std::vector<Type> & values, Type low, Type high, std::uint64_t seed, unsigned threads = 0) {
+	random_fill(values.data(), values.data() + values.size(), low, high, seed, threads);
+}
@@ -0,0 +1,818 @@
+/*
+ *	Roaring Bitmap
+ *
+ *	A compressed set of 32-bit integers for dense set algebra: the values
+ *	are grouped by their high 16 bits, and every group of up to 65536 values
+ *	is stored in whichever container is smallest:
+ *
+ *	  array    the low 16 bits, sorted: 2 bytes per value, up to 4096 values
+ *	  bitmap   1024 64-bit words, one bit per possible value: 8 KB, used
+ *	           above 4096 values, where the array would be larger
+ *	  runs     start and length of every run of consecutive values: 4 bytes
+ *	           per run, chosen by run_optimize() when smaller than both
+ *
+ *	A sorted std::vector<int> spends 4 bytes per value; a bitmap container
+ *	full to 50% spends 2 bits. Intersection, union and difference go
+ *	container by container: two bitmaps combine with word-wide AND, OR and
+ *	AND NOT (64 values per instruction, popcount for the size), an array
+ *	against a bitmap tests one bit per value, and two arrays merge. Two
+ *	run containers merge their runs, into runs if those are still the
+ *	smallest form; against the other kinds, runs are expanded to an array
+ *	or a bitmap, and the result is one of those, to be run_optimize()d.
+ *
+ *	The sizes of the results are computed without building them, and the
+ *	set converts to and from sorted vectors, as used by the std:: set
+ *	algorithms.
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "Bit_Ops.h"
+
+
+namespace roaring_detail {
+
+	// Above this many values an array container is larger than a bitmap (8 KB)
+	const std::uint32_t array_limit = 4096;
+	const std::size_t bitmap_words = 1024;
+
+	enum class kind : unsigned char { array, bitmap, runs };
+
+	// The low 16 bits of the values that share their high 16 bits
+	struct container {
+		kind type;
+		std::uint32_t cardinality;
+		std::vector<std::uint16_t> values;	// array: the values, increasing; runs: start and length - 1 of every run
+		std::vector<std::uint64_t> words;	// bitmap: bit v % 64 of word v / 64 for every value v
+
+		container() : type(kind::array), cardinality(0) {}
+
+		bool contains(std::uint16_t value) const {
+			if (type == kind::array)
+				return std::binary_search(values.begin(), values.end(), value);
+			if (type == kind::bitmap)
+				return (words[value / 64] >> (value % 64)) & 1;
+
+			// The last run starting at or before 'value'
+			std::size_t low = 0, high = values.size() / 2;
+			while (low < high) {
+				const std::size_t middle = (low + high) / 2;
+				if (values[2 * middle] <= value)
+					low = middle + 1;
+				else
+					high = middle;
+			}
+			return low > 0 && value - values[2 * (low - 1)] <= values[2 * (low - 1) + 1];
+		}
+
+		std::size_t memory_bytes() const {
+			return sizeof(container) + values.capacity() * sizeof(std::uint16_t) + words.capacity() * sizeof(std::uint64_t);
+		}
+	};
+
+	// Sets the bits of [first, last], inclusive
+	inline void set_range(std::uint64_t * words, std::uint32_t first, std::uint32_t last) {
+		const std::uint32_t first_word = first / 64, last_word = last / 64;
+		const std::uint64_t first_mask = ~std::uint64_t(0) << (first % 64);
+		const std::uint64_t last_mask = ~std::uint64_t(0) >> (63 - last % 64);
+		if (first_word == last_word) {
+			words[first_word] |= first_mask & last_mask;
+			return;
+		}
+		words[first_word] |= first_mask;
+		for (std::uint32_t w = first_word + 1; w < last_word; ++w)
+			words[w] = ~std::uint64_t(0);
+		words[last_word] |= last_mask;
+	}
+
+	inline void array_to_bitmap(container & c) {
+		c.words.assign(bitmap_words, 0);
+		for (std::uint16_t value : c.values)
+			c.words[value / 64] |= std::uint64_t(1) << (value % 64);
+		std::vector<std::uint16_t>().swap(c.values);
+		c.type = kind::bitmap;
+	}
+
+	inline void bitmap_to_array(container & c) {
+		c.values.clear();
+		c.values.reserve(c.cardinality);
+		for (std::size_t w = 0; w < bitmap_words; ++w)
+			for (std::uint64_t word = c.words[w]; word; word &= word - 1)
+				c.values.push_back(std::uint16_t(64 * w + bit_ops::lowest_bit(word)));
+		std::vector<std::uint64_t>().swap(c.words);
+		c.type = kind::array;
+	}
+
+	// An array or a bitmap, whichever the cardinality calls for
+	inline void normalize(container & c) {
+		if (c.type == kind::bitmap && c.cardinality <= array_limit)
+			bitmap_to_array(c);
+		else if (c.type == kind::array && c.cardinality > array_limit)
+			array_to_bitmap(c);
+	}
+
+	inline void runs_to_values(container & c) {
+		std::vector<std::uint16_t> runs;
+		runs.swap(c.values);
+		if (c.cardinality <= array_limit) {
+			c.values.reserve(c.cardinality);
+			for (std::size_t r = 0; r < runs.size(); r += 2)
+				for (std::uint32_t value = runs[r]; value <= std::uint32_t(runs[r]) + runs[r + 1]; ++value)
+					c.values.push_back(std::uint16_t(value));
+			c.type = kind::array;
+			return;
+		}
+		c.words.assign(bitmap_words, 0);
+		for (std::size_t r = 0; r < runs.size(); r += 2)
+			set_range(c.words.data(), runs[r], std::uint32_t(runs[r]) + runs[r + 1]);
+		c.type = kind::bitmap;
+	}
+
+	// The container itself, or its runs expanded into 'scratch'
+	inline const container & expanded(const container & c, container & scratch) {
+		if (c.type != kind::runs)
+			return c;
+		scratch = c;
+		runs_to_values(scratch);
+		return scratch;
+	}
+
+	// Number of runs of consecutive values
+	inline std::size_t count_runs(const container & c) {
+		if (c.type == kind::runs)
+			return c.values.size() / 2;
+		std::size_t runs = 0;
+		if (c.type == kind::array) {
+			for (std::size_t i = 0; i < c.values.size(); ++i)
+				runs += i == 0 || c.values[i] != c.values[i - 1] + 1;
+			return runs;
+		}
+		// A run starts at every 1 bit whose lower neighbour is 0
+		std::uint64_t carry = 0;
+		for (std::size_t w = 0; w < bitmap_words; ++w) {
+			const std::uint64_t word = c.words[w];
+			runs += bit_ops::popcount(word & ~((word << 1) | carry));
+			carry = word >> 63;
+		}
+		return runs;
+	}
+
+	// First bit at or after 'from' equal to 'set', or 65536
+	inline std::uint32_t find_bit(const std::vector<std::uint64_t> & words, std::uint32_t from, bool set) {
+		if (from >= 65536)
+			return 65536;
+		const std::uint64_t flip = set ? 0 : ~std::uint64_t(0);
+		std::size_t w = from / 64;
+		std::uint64_t word = (words[w] ^ flip) & (~std::uint64_t(0) << (from % 64));
+		while (!word) {
+			if (++w == bitmap_words)
+				return 65536;
+			word = words[w] ^ flip;
+		}
+		return std::uint32_t(64 * w + bit_ops::lowest_bit(word));
+	}
+
+	inline void to_runs(container & c) {
+		std::vector<std::uint16_t> runs;
+		if (c.type == kind::array) {
+			for (std::size_t i = 0; i < c.values.size(); ++i)
+				if (i > 0 && c.values[i] == c.values[i - 1] + 1)
+					++runs.back();
+				else {
+					runs.push_back(c.values[i]);
+					runs.push_back(0);
+				}
+		}
+		else {
+			// From every first 1 bit to the next 0 bit
+			for (std::uint32_t start = find_bit(c.words, 0, true); start < 65536;) {
+				const std::uint32_t end = find_bit(c.words, start, false);
+				runs.push_back(std::uint16_t(start));
+				runs.push_back(std::uint16_t(end - 1 - start));
+				start = find_bit(c.words, end, true);
+			}
+			std::vector<std::uint64_t>().swap(c.words);
+		}
+		runs.shrink_to_fit();
+		c.values.swap(runs);
+		c.type = kind::runs;
+	}
+
+
+	// Two arrays: branchless merges, writing every candidate and advancing by 0 or 1
+
+	inline std::uint32_t intersect_arrays(const std::vector<std::uint16_t> & a, const std::vector<std::uint16_t> & b, std::uint16_t * out) {
+		std::size_t i = 0, j = 0;
+		std::uint32_t written = 0;
+		while (i < a.size() && j < b.size()) {
+			const std::uint16_t x = a[i], y = b[j];
+			if (out)
+				out[written] = x;
+			written += x == y;
+			i += x <= y;
+			j += y <= x;
+		}
+		return written;
+	}
+
+	inline std::uint32_t unite_arrays(const std::vector<std::uint16_t> & a, const std::vector<std::uint16_t> & b, std::uint16_t * out) {
+		std::size_t i = 0, j = 0;
+		std::uint32_t written = 0;
+		for (; i < a.size() && j < b.size(); ++written) {
+			const std::uint16_t x = a[i], y = b[j];
+			out[written] = x < y ? x : y;
+			i += x <= y;
+			j += y <= x;
+		}
+		for (; i < a.size(); ++i)
+			out[written++] = a[i];
+		for (; j < b.size(); ++j)
+			out[written++] = b[j];
+		return written;
+	}
+
+	inline std::uint32_t subtract_arrays(const std::vector<std::uint16_t> & a, const std::vector<std::uint16_t> & b, std::uint16_t * out) {
+		std::size_t i = 0, j = 0;
+		std::uint32_t written = 0;
+		while (i < a.size() && j < b.size()) {
+			const std::uint16_t x = a[i], y = b[j];
+			out[written] = x;
+			written += x < y;
+			i += x <= y;
+			j += y <= x;
+		}
+		for (; i < a.size(); ++i)
+			out[written++] = a[i];
+		return written;
+	}
+
+	// The values of an array whose bit in a bitmap is 'set'
+	inline std::uint32_t filter_array(const std::vector<std::uint16_t> & values, const std::vector<std::uint64_t> & words, bool set,
+					  std::uint16_t * out) {
+		std::uint32_t written = 0;
+		for (std::uint16_t value : values) {
+			if (out)
+				out[written] = value;
+			written += bool((words[value / 64] >> (value % 64)) & 1) == set;
+		}
+		return written;
+	}
+
+
+	// Two run containers: interval merges, O(runs), never expanded
+
+	// Appends [first, last] to runs sorted by start, merged with the last run if they touch
+	inline void add_run(std::vector<std::uint16_t> & runs, std::uint32_t first, std::uint32_t last) {
+		const std::size_t size = runs.size();
+		if (size && first <= std::uint32_t(runs[size - 2]) + runs[size - 1] + 1) {
+			const std::uint32_t end = std::max(std::uint32_t(runs[size - 2]) + runs[size - 1], last);
+			runs[size - 1] = std::uint16_t(end - runs[size - 2]);
+			return;
+		}
+		runs.push_back(std::uint16_t(first));
+		runs.push_back(std::uint16_t(last - first));
+	}
+
+	// Runs if they are the smallest form, else an array or a bitmap
+	inline container from_runs(std::vector<std::uint16_t> & runs) {
+		container c;
+		c.type = kind::runs;
+		for (std::size_t r = 0; r < runs.size(); r += 2)
+			c.cardinality += std::uint32_t(runs[r + 1]) + 1;
+		c.values.swap(runs);
+		if (2 * c.values.size() >= std::min<std::size_t>(2 * std::size_t(c.cardinality), 8 * bitmap_words))
+			runs_to_values(c);
+		return c;
+	}
+
+	// Intersection of two runs: from the later start to the earlier end
+	inline std::uint32_t intersect_runs(const std::vector<std::uint16_t> & a, const std::vector<std::uint16_t> & b,
+					    std::vector<std::uint16_t> * out) {
+		std::size_t i = 0, j = 0;
+		std::uint32_t count = 0;
+		while (i < a.size() && j < b.size()) {
+			const std::uint32_t a_last = std::uint32_t(a[i]) + a[i + 1], b_last = std::uint32_t(b[j]) + b[j + 1];
+			const std::uint32_t first = std::max(a[i], b[j]), last = std::min(a_last, b_last);
+			if (first <= last) {
+				count += last - first + 1;
+				if (out)
+					add_run(*out, first, last);
+			}
+			(a_last < b_last ? i : j) += 2;
+		}
+		return count;
+	}
+
+	inline void unite_runs(const std::vector<std::uint16_t> & a, const std::vector<std::uint16_t> & b, std::vector<std::uint16_t> & out) {
+		std::size_t i = 0, j = 0;
+		while (i < a.size() || j < b.size()) {
+			const bool from_a = j == b.size() || (i < a.size() && a[i] < b[j]);
+			const std::vector<std::uint16_t> & next = from_a ? a : b;
+			std::size_t & k = from_a ? i : j;
+			add_run(out, next[k], std::uint32_t(next[k]) + next[k + 1]);
+			k += 2;
+		}
+	}
+
+	// Every run of 'a', cut by the runs of 'b' that overlap it
+	inline void subtract_runs(const std::vector<std::uint16_t> & a, const std::vector<std::uint16_t> & b, std::vector<std::uint16_t> & out) {
+		std::size_t j = 0;
+		for (std::size_t i = 0; i < a.size(); i += 2) {
+			std::uint32_t first = a[i];
+			const std::uint32_t last = std::uint32_t(a[i]) + a[i + 1];
+			for (; j < b.size() && b[j] <= last; j += 2) {
+				const std::uint32_t b_last = std::uint32_t(b[j]) + b[j + 1];
+				if (b[j] > first)
+					add_run(out, first, b[j] - 1u);
+				first = std::max(first, b_last + 1);
+				// A run of 'b' reaching past this run of 'a' may cut the next one too
+				if (b_last > last)
+					break;
+			}
+			if (first <= last)
+				add_run(out, first, last);
+		}
+	}
+
+
+	// Container algebra; the result is normalized, possibly empty
+
+	inline container intersect(const container & a0, const container & b0) {
+		if (a0.type == kind::runs && b0.type == kind::runs) {
+			std::vector<std::uint16_t> runs;
+			intersect_runs(a0.values, b0.values, &runs);
+			return from_runs(runs);
+		}
+		container sa, sb, result;
+		const container & a = expanded(a0, sa), & b = expanded(b0, sb);
+		if (a.type == kind::bitmap && b.type == kind::bitmap) {
+			result.type = kind::bitmap;
+			result.words.resize(bitmap_words);
+			std::uint32_t count = 0;
+			for (std::size_t w = 0; w < bitmap_words; ++w)
+				count += bit_ops::popcount(result.words[w] = a.words[w] & b.words[w]);
+			result.cardinality = count;
+			normalize(result);
+			return result;
+		}
+		result.values.resize(std::min(a.cardinality, b.cardinality));
+		if (a.type == kind::array && b.type == kind::array)
+			result.cardinality = intersect_arrays(a.values, b.values, result.values.data());
+		else if (a.type == kind::array)
+			result.cardinality = filter_array(a.values, b.words, true, result.values.data());
+		else
+			result.cardinality = filter_array(b.values, a.words, true, result.values.data());
+		result.values.resize(result.cardinality);
+		return result;
+	}
+
+	inline container unite(const container & a0, const container & b0) {
+		if (a0.type == kind::runs && b0.type == kind::runs) {
+			std::vector<std::uint16_t> runs;
+			unite_runs(a0.values, b0.values, runs);
+			return from_runs(runs);
+		}
+		container sa, sb, result;
+		const container & a = expanded(a0, sa), & b = expanded(b0, sb);
+		if (a.type == kind::array && b.type == kind::array) {
+			result.values.resize(a.cardinality + b.cardinality);
+			result.cardinality = unite_arrays(a.values, b.values, result.values.data());
+			result.values.resize(result.cardinality);
+			normalize(result);
+			return result;
+		}
+		result.type = kind::bitmap;
+		if (a.type == kind::bitmap && b.type == kind::bitmap) {
+			result.words.resize(bitmap_words);
+			std::uint32_t count = 0;
+			for (std::size_t w = 0; w < bitmap_words; ++w)
+				count += bit_ops::popcount(result.words[w] = a.words[w] | b.words[w]);
+			result.cardinality = count;
+			return result;
+		}
+		const container & bits = a.type == kind::bitmap ? a : b, & array = a.type == kind::bitmap ? b : a;
+		result.words = bits.words;
+		std::uint32_t count = bits.cardinality;
+		for (std::uint16_t value : array.values) {
+			std::uint64_t & word = result.words[value / 64];
+			count += unsigned(~word >> (value % 64)) & 1;
+			word |= std::uint64_t(1) << (value % 64);
+		}
+		result.cardinality = count;
+		return result;
+	}
+
+	inline container subtract(const container & a0, const container & b0) {
+		if (a0.type == kind::runs && b0.type == kind::runs) {
+			std::vector<std::uint16_t> runs;
+			subtract_runs(a0.values, b0.values, runs);
+			return from_runs(runs);
+		}
+		container sa, sb, result;
+		const container & a = expanded(a0, sa), & b = expanded(b0, sb);
+		if (a.type == kind::array) {
+			result.values.resize(a.cardinality);
+			result.cardinality = b.type == kind::array ? subtract_arrays(a.values, b.values, result.values.data())
+								   : filter_array(a.values, b.words, false, result.values.data());
+			result.values.resize(result.cardinality);
+			return result;
+		}
+		result.type = kind::bitmap;
+		result.words = a.words;
+		std::uint32_t count = 0;
+		if (b.type == kind::bitmap)
+			for (std::size_t w = 0; w < bitmap_words; ++w)
+				count += bit_ops::popcount(result.words[w] &= ~b.words[w]);
+		else {
+			count = a.cardinality;
+			for (std::uint16_t value : b.values) {
+				std::uint64_t & word = result.words[value / 64];
+				count -= unsigned(word >> (value % 64)) & 1;
+				word &= ~(std::uint64_t(1) << (value % 64));
+			}
+		}
+		result.cardinality = count;
+		normalize(result);
+		return result;
+	}
+
+	inline std::uint32_t intersection_size(const container & a0, const container & b0) {
+		if (a0.type == kind::runs && b0.type == kind::runs)
+			return intersect_runs(a0.values, b0.values, nullptr);
+		container sa, sb;
+		const container & a = expanded(a0, sa), & b = expanded(b0, sb);
+		if (a.type == kind::bitmap && b.type == kind::bitmap) {
+			std::uint32_t count = 0;
+			for (std::size_t w = 0; w < bitmap_words; ++w)
+				count += bit_ops::popcount(a.words[w] & b.words[w]);
+			return count;
+		}
+		if (a.type == kind::array && b.type == kind::array)
+			return intersect_arrays(a.values, b.values, nullptr);
+		return a.type == kind::array ? filter_array(a.values, b.words, true, nullptr) : filter_array(b.values, a.words, true, nullptr);
+	}
+
+} // namespace roaring_detail
+
+
+class roaring_bitmap {
+public:
+
+	typedef std::uint32_t value_type;
+
+	// Forward iterator over the values in increasing order
+	class const_iterator {
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef std::uint32_t value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const std::uint32_t * pointer;
+		typedef std::uint32_t reference;
+
+		const_iterator() : set(nullptr), c(0), i(0), low(0) {}
+
+		std::uint32_t operator*() const { return (std::uint32_t(set->keys[c]) << 16) | low; }
+
+		// O(1), except bitmaps: O(distance to the next value / 64)
+		const_iterator & operator++() {
+			using namespace roaring_detail;
+			const container & k = set->containers[c];
+			if (k.type == kind::array) {
+				if (++i < k.values.size()) {
+					low = k.values[i];
+					return *this;
+				}
+			}
+			else if (k.type == kind::runs) {
+				if (low < std::uint32_t(k.values[2 * i]) + k.values[2 * i + 1]) {
+					++low;
+					return *this;
+				}
+				if (2 * ++i < k.values.size()) {
+					low = k.values[2 * i];
+					return *this;
+				}
+			}
+			else if (low < 65535 && next_bit(k, low + 1))
+				return *this;
+			++c;
+			enter();
+			return *this;
+		}
+
+		const_iterator operator++(int) {
+			const_iterator old = *this;
+			++*this;
+			return old;
+		}
+
+		bool operator==(const const_iterator & other) const { return c == other.c && low == other.low; }
+		bool operator!=(const const_iterator & other) const { return !(*this == other); }
+
+	private:
+		friend class roaring_bitmap;
+
+		const_iterator(const roaring_bitmap * set, std::size_t c) : set(set), c(c), i(0), low(0) { enter(); }
+
+		// First value of container c, or the end
+		void enter() {
+			using namespace roaring_detail;
+			i = 0;
+			low = 0;
+			if (c == set->containers.size())
+				return;
+			const container & k = set->containers[c];
+			if (k.type == kind::bitmap)
+				next_bit(k, 0);
+			else
+				low = k.values[0];
+		}
+
+		// Moves to the first 1 bit at or after 'from'; false if there is none
+		bool next_bit(const roaring_detail::container & k, std::uint32_t from) {
+			std::size_t w = from / 64;
+			std::uint64_t word = k.words[w] & (~std::uint64_t(0) << (from % 64));
+			while (!word) {
+				if (++w == roaring_detail::bitmap_words)
+					return false;
+				word = k.words[w];
+			}
+			low = std::uint32_t(64 * w + bit_ops::lowest_bit(word));
+			return true;
+		}
+
+		const roaring_bitmap * set;
+		std::size_t c;		// container
+		std::size_t i;		// array: index of the value; runs: index of the run
+		std::uint32_t low;	// low 16 bits of the value
+	};
+
+	typedef const_iterator iterator;
+
+
+	roaring_bitmap() {}
+
+	// From any integers in [0, 2^32), in any order
+	// O(n) when increasing, as a sorted vector is
+	template <class InputIterator>
+	roaring_bitmap(InputIterator first, InputIterator last) {
+		for (; first != last; ++first)
+			add(std::uint32_t(*first));
+	}
+
+	roaring_bitmap(std::initializer_list<std::uint32_t> values) : roaring_bitmap(values.begin(), values.end()) {}
+
+	// O(1) appending the largest value, O(lg containers + 4096) otherwise
+	void add(std::uint32_t value) {
+		using namespace roaring_detail;
+		container & c = find_or_insert(std::uint16_t(value >> 16));
+		const std::uint16_t low = std::uint16_t(value);
+		if (c.type == kind::runs)
+			runs_to_values(c);
+		if (c.type == kind::bitmap) {
+			std::uint64_t & word = c.words[low / 64];
+			c.cardinality += unsigned(~word >> (low % 64)) & 1;
+			word |= std::uint64_t(1) << (low % 64);
+			return;
+		}
+		if (c.values.empty() || c.values.back() < low)
+			c.values.push_back(low);
+		else {
+			std::vector<std::uint16_t>::iterator at = std::lower_bound(c.values.begin(), c.values.end(), low);
+			if (*at == low)
+				return;
+			c.values.insert(at, low);
+		}
+		++c.cardinality;
+		normalize(c);
+	}
+
+	// Returns whether the value was there
+	bool remove(std::uint32_t value) {
+		using namespace roaring_detail;
+		const std::vector<std::uint16_t>::iterator key = std::lower_bound(keys.begin(), keys.end(), std::uint16_t(value >> 16));
+		if (key == keys.end() || *key != std::uint16_t(value >> 16))
+			return false;
+		container & c = containers[std::size_t(key - keys.begin())];
+		const std::uint16_t low = std::uint16_t(value);
+		if (!c.contains(low))
+			return false;
+		if (c.type == kind::runs)
+			runs_to_values(c);
+		if (c.type == kind::bitmap)
+			c.words[low / 64] &= ~(std::uint64_t(1) << (low % 64));
+		else
+			c.values.erase(std::lower_bound(c.values.begin(), c.values.end(), low));
+		if (--c.cardinality == 0) {
+			containers.erase(containers.begin() + (key - keys.begin()));
+			keys.erase(key);
+		}
+		else
+			normalize(c);
+		return true;
+	}
+
+	// O(lg containers + lg 4096)
+	bool contains(std::uint32_t value) const {
+		const std::vector<std::uint16_t>::const_iterator key = std::lower_bound(keys.begin(), keys.end(), std::uint16_t(value >> 16));
+		return key != keys.end() && *key == std::uint16_t(value >> 16)
+			&& containers[std::size_t(key - keys.begin())].contains(std::uint16_t(value));
+	}
+
+	// O(containers)
+	std::uint64_t cardinality() const {
+		std::uint64_t count = 0;
+		for (const roaring_detail::container & c : containers)
+			count += c.cardinality;
+		return count;
+	}
+
+	bool empty() const { return keys.empty(); }
+
+	void clear() {
+		keys.clear();
+		containers.clear();
+	}
+
+	// Stores every container as runs where that is smaller; returns how many changed
+	std::size_t run_optimize() {
+		using namespace roaring_detail;
+		std::size_t changed = 0;
+		for (container & c : containers) {
+			if (c.type == kind::runs)
+				continue;
+			const std::size_t run_bytes = 4 * count_runs(c);
+			const std::size_t bytes = c.type == kind::array ? 2 * std::size_t(c.cardinality) : 8 * bitmap_words;
+			if (run_bytes < bytes) {
+				to_runs(c);
+				++changed;
+			}
+		}
+		return changed;
+	}
+
+	// Heap and object memory, for comparison with 4 bytes per value in a vector
+	std::size_t memory_bytes() const {
+		std::size_t bytes = sizeof(*this) + keys.capacity() * sizeof(std::uint16_t);
+		for (const roaring_detail::container & c : containers)
+			bytes += c.memory_bytes();
+		return bytes + (containers.capacity() - containers.size()) * sizeof(roaring_detail::container);
+	}
+
+	const_iterator begin() const { return const_iterator(this, 0); }
+	const_iterator end() const { return const_iterator(this, containers.size()); }
+
+	// The values in increasing order, in a vector sized exactly
+	std::vector<std::uint32_t> to_vector() const {
+		using namespace roaring_detail;
+		std::vector<std::uint32_t> out;
+		out.reserve(std::size_t(cardinality()));
+		for (std::size_t k = 0; k < keys.size(); ++k) {
+			const std::uint32_t high = std::uint32_t(keys[k]) << 16;
+			const container & c = containers[k];
+			if (c.type == kind::array)
+				for (std::uint16_t low : c.values)
+					out.push_back(high | low);
+			else if (c.type == kind::runs)
+				for (std::size_t r = 0; r < c.values.size(); r += 2)
+					for (std::uint32_t low = c.values[r]; low <= std::uint32_t(c.values[r]) + c.values[r + 1]; ++low)
+						out.push_back(high | low);
+			else
+				for (std::size_t w = 0; w < bitmap_words; ++w)
+					for (std::uint64_t word = c.words[w]; word; word &= word - 1)
+						out.push_back(high | std::uint32_t(64 * w + bit_ops::lowest_bit(word)));
+		}
+		return out;
+	}
+
+	roaring_bitmap & operator&=(const roaring_bitmap & other) { return *this = *this & other; }
+	roaring_bitmap & operator|=(const roaring_bitmap & other) { return *this = *this | other; }
+	roaring_bitmap & operator-=(const roaring_bitmap & other) { return *this = *this - other; }
+
+
+	// Set algebra, container by container: O(containers + the work inside the shared ones)
+
+	friend roaring_bitmap operator&(const roaring_bitmap & a, const roaring_bitmap & b) {
+		roaring_bitmap result;
+		for (std::size_t i = 0, j = 0; i < a.keys.size() && j < b.keys.size();) {
+			if (a.keys[i] < b.keys[j])
+				++i;
+			else if (b.keys[j] < a.keys[i])
+				++j;
+			else {
+				result.append(a.keys[i], roaring_detail::intersect(a.containers[i], b.containers[j]));
+				++i;
+				++j;
+			}
+		}
+		return result;
+	}
+
+	friend roaring_bitmap operator|(const roaring_bitmap & a, const roaring_bitmap & b) {
+		roaring_bitmap result;
+		std::size_t i = 0, j = 0;
+		while (i < a.keys.size() && j < b.keys.size()) {
+			if (a.keys[i] < b.keys[j]) {
+				result.append(a.keys[i], a.containers[i]);
+				++i;
+			}
+			else if (b.keys[j] < a.keys[i]) {
+				result.append(b.keys[j], b.containers[j]);
+				++j;
+			}
+			else {
+				result.append(a.keys[i], roaring_detail::unite(a.containers[i], b.containers[j]));
+				++i;
+				++j;
+			}
+		}
+		for (; i < a.keys.size(); ++i)
+			result.append(a.keys[i], a.containers[i]);
+		for (; j < b.keys.size(); ++j)
+			result.append(b.keys[j], b.containers[j]);
+		return result;
+	}
+
+	friend roaring_bitmap operator-(const roaring_bitmap & a, const roaring_bitmap & b) {
+		roaring_bitmap result;
+		std::size_t i = 0, j = 0;
+		while (i < a.keys.size()) {
+			while (j < b.keys.size() && b.keys[j] < a.keys[i])
+				++j;
+			if (j < b.keys.size() && b.keys[j] == a.keys[i])
+				result.append(a.keys[i], roaring_detail::subtract(a.containers[i], b.containers[j]));
+			else
+				result.append(a.keys[i], a.containers[i]);
+			++i;
+		}
+		return result;
+	}
+
+	// Sizes of the results, without building them
+	friend std::uint64_t intersection_size(const roaring_bitmap & a, const roaring_bitmap & b) {
+		std::uint64_t count = 0;
+		for (std::size_t i = 0, j = 0; i < a.keys.size() && j < b.keys.size();) {
+			if (a.keys[i] < b.keys[j])
+				++i;
+			else if (b.keys[j] < a.keys[i])
+				++j;
+			else
+				count += roaring_detail::intersection_size(a.containers[i++], b.containers[j++]);
+		}
+		return count;
+	}
+
+	friend std::uint64_t union_size(const roaring_bitmap & a, const roaring_bitmap & b) {
+		return a.cardinality() + b.cardinality() - intersection_size(a, b);
+	}
+
+	friend std::uint64_t difference_size(const roaring_bitmap & a, const roaring_bitmap & b) {
+		return a.cardinality() - intersection_size(a, b);
+	}
+
+	friend bool operator==(const roaring_bitmap & a, const roaring_bitmap & b) {
+		return a.keys == b.keys && a.cardinality() == b.cardinality() && intersection_size(a, b) == a.cardinality();
+	}
+
+	friend bool operator!=(const roaring_bitmap & a, const roaring_bitmap & b) { return !(a == b); }
+
+private:
+
+	roaring_detail::container & find_or_insert(std::uint16_t key) {
+		if (!keys.empty() && keys.back() == key)
+			return containers.back();
+		if (keys.empty() || keys.back() < key) {
+			keys.push_back(key);
+			containers.push_back(roaring_detail::container());
+			return containers.back();
+		}
+		const std::vector<std::uint16_t>::iterator at = std::lower_bound(keys.begin(), keys.end(), key);
+		const std::size_t index = std::size_t(at - keys.begin());
+		if (*at != key) {
+			keys.insert(at, key);
+			containers.insert(containers.begin() + std::ptrdiff_t(index), roaring_detail::container());
+		}
+		return containers[index];
+	}
+
+	// Appends a container with a larger key than the others; empty ones are dropped
+	void append(std::uint16_t key, roaring_detail::container c) {
+		if (c.cardinality == 0)
+			return;
+		keys.push_back(key);
+		containers.push_back(std::move(c));
+	}
+
+	std::vector<std::uint16_t> keys;			// high 16 bits of the values of every container, increasing
+	std::vector<roaring_detail::container> containers;
+};
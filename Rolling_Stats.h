@@ -0,0 +1,213 @@
+/*
+ *	Rolling Statistics
+ *
+ *	Mean, variance, min, max and median of the most recent prices,
+ *	updated incrementally as each new tick arrives
+ *
+ *	The window holds either the last N ticks (count window) or the ticks
+ *	of the last T time units (time window, e.g. 120 minutes or 5e9 ns).
+ *	A new tick enters the window and the expired ones leave it; nothing
+ *	is recomputed over the whole window:
+ *
+ *	  mean, variance   Welford's update, and its inverse for a removal   O(1)
+ *	  min, max         monotonic deques of candidates                    O(1) amortized
+ *	  median           two balanced multisets, lower and upper half      O(lg n)
+ *
+ *	Removals make the running mean and variance drift by a rounding error
+ *	each; after as many removals as the window holds, both are recomputed
+ *	from the window, which keeps the amortized cost O(1).
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <set>
+#include <stdexcept>
+
+
+// Time is a price series timestamp (clock_minutes, epoch_nanos, ...):
+// ordered, with count() giving its value in its own units
+template <class Time, class Real = double>
+class rolling_stats {
+public:
+
+	// The last 'ticks' values
+	static rolling_stats count_window(std::size_t ticks) {
+		if (ticks == 0)
+			throw std::invalid_argument("rolling_stats: the window needs at least one tick");
+		return rolling_stats(ticks, 0);
+	}
+
+	// The values stamped within 'span' Time units of the newest one: (newest - span, newest]
+	static rolling_stats time_window(std::int64_t span) {
+		if (span <= 0)
+			throw std::invalid_argument("rolling_stats: the time span must be positive");
+		return rolling_stats(0, span);
+	}
+
+	// Add the newest tick and drop the expired ones
+	// Time windows need non-decreasing times, otherwise std::invalid_argument
+	void push(const Time & time, Real price) {
+		if (span != 0 && !window.empty() && time < window.back().time)
+			throw std::invalid_argument("rolling_stats: ticks must arrive in time order");
+
+		// Enter the window
+		window.push_back(tick{ time, price, next_sequence });
+
+		++n;
+		const Real delta = price - average;
+		average += delta / Real(n);
+		m2 += delta * (price - average);
+
+		// A value can never be the minimum again once a newer value is at most as large
+		while (!lows.empty() && lows.back().price >= price)
+			lows.pop_back();
+		lows.push_back(window.back());
+		while (!highs.empty() && highs.back().price <= price)
+			highs.pop_back();
+		highs.push_back(window.back());
+
+		if (lower.empty() || price <= *lower.rbegin())
+			lower.insert(price);
+		else
+			upper.insert(price);
+		balance();
+
+		++next_sequence;
+
+		// Leave the window
+		if (span != 0) {
+			while (window.front().time.count() <= time.count() - span)
+				pop_front();
+		}
+		else if (window.size() > capacity)
+			pop_front();
+	}
+
+	void operator()(const Time & time, Real price) { push(time, price); }
+
+	void clear() {
+		window.clear();
+		lows.clear();
+		highs.clear();
+		lower.clear();
+		upper.clear();
+		n = 0;
+		removals = 0;
+		average = 0;
+		m2 = 0;
+	}
+
+	// Values in the window
+	std::size_t size() const { return window.size(); }
+	bool empty() const { return window.empty(); }
+
+	// All of the following are 0 for an empty window
+	Real mean() const { return average; }
+	Real min() const { return lows.empty() ? Real(0) : lows.front().price; }
+	Real max() const { return highs.empty() ? Real(0) : highs.front().price; }
+	Real range() const { return max() - min(); }
+
+	// Oldest and newest value in the window
+	Real open() const { return window.empty() ? Real(0) : window.front().price; }
+	Real close() const { return window.empty() ? Real(0) : window.back().price; }
+
+	// Unbiased (sample) variance, 0 with fewer than two values
+	Real variance() const { return n > 1 ? std::max(Real(0), m2) / Real(n - 1) : Real(0); }
+	Real stddev() const { return std::sqrt(variance()); }
+
+	// The middle value; the mean of the two middle values for an even count
+	Real median() const {
+		if (lower.empty())
+			return Real(0);
+		if (lower.size() > upper.size())
+			return *lower.rbegin();
+		return (*lower.rbegin() + *upper.begin()) / Real(2);
+	}
+
+private:
+
+	struct tick {
+		Time time;
+		Real price;
+		std::uint64_t sequence;
+	};
+
+	rolling_stats(std::size_t capacity, std::int64_t span)
+		: capacity(capacity), span(span), next_sequence(0), n(0), removals(0), average(0), m2(0) {}
+
+	// Remove the oldest value
+	void pop_front() {
+		const tick oldest = window.front();
+		window.pop_front();
+
+		// Welford's update run backwards
+		--n;
+		if (++removals >= n)
+			refresh();
+		else {
+			const Real delta = oldest.price - average;
+			average -= delta / Real(n);
+			m2 -= delta * (oldest.price - average);
+		}
+
+		if (lows.front().sequence == oldest.sequence)
+			lows.pop_front();
+		if (highs.front().sequence == oldest.sequence)
+			highs.pop_front();
+
+		// Every value of 'lower' is at most every value of 'upper'
+		if (oldest.price <= *lower.rbegin())
+			lower.erase(lower.find(oldest.price));
+		else
+			upper.erase(upper.find(oldest.price));
+		balance();
+	}
+
+	// Exact mean and variance of the window, two passes, O(n)
+	void refresh() {
+		removals = 0;
+		average = 0;
+		m2 = 0;
+		if (n == 0)
+			return;
+		for (const tick & elem : window)
+			average += elem.price;
+		average /= Real(n);
+		for (const tick & elem : window)
+			m2 += (elem.price - average) * (elem.price - average);
+	}
+
+	// 'lower' holds the same number of values as 'upper', or one more
+	void balance() {
+		if (lower.size() > upper.size() + 1) {
+			upper.insert(*lower.rbegin());
+			lower.erase(std::prev(lower.end()));
+		}
+		else if (upper.size() > lower.size()) {
+			lower.insert(*upper.begin());
+			upper.erase(upper.begin());
+		}
+	}
+
+	std::size_t capacity;		// count window, or 0
+	std::int64_t span;		// time window, or 0
+	std::uint64_t next_sequence;
+
+	std::deque<tick> window;	// in arrival order
+	std::deque<tick> lows;		// increasing prices: the front is the minimum
+	std::deque<tick> highs;		// decreasing prices: the front is the maximum
+	std::multiset<Real> lower, upper;
+
+	std::size_t n;
+	std::size_t removals;	// since the last refresh
+	Real average;
+	Real m2;	// sum of squared deviations from the mean
+};
@@ -0,0 +1,178 @@
+/*
+ *	Running Statistics
+ *
+ *	Single-pass accumulator for count, mean, unbiased variance, min, max,
+ *	open (first value) and close (last value)
+ *
+ *	The variance uses Welford's update, which stays accurate where the
+ *	textbook sum-of-squares formula cancels catastrophically. Accumulators
+ *	of consecutive chunks merge (Chan et al.), so one type serves streaming
+ *	updates, bulk arrays and chunked-parallel reductions. The results agree
+ *	up to rounding: in floating point, the order of the operations, and so
+ *	the chunking, can change the last bits.
+ *
+ *	Welford, "Note on a method for calculating corrected sums of squares", 1962
+ *	Chan, Golub and LeVeque, "Updating formulae and a pairwise algorithm
+ *	for computing sample variances", 1979
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+
+#include "Simd_Reductions.h"
+
+
+namespace running_stats_detail {
+
+	// Chunk kernels for the bulk push: plain loops for any Real,
+	// the dispatched SIMD reductions for double
+
+	template <class Real>
+	Real sum(const Real * first, const Real * last) {
+		Real sum = 0;
+		for (; first != last; ++first)
+			sum += *first;
+		return sum;
+	}
+
+	template <class Real>
+	void min_max(const Real * first, const Real * last, Real & minimum, Real & maximum) {
+		for (; first != last; ++first) {
+			minimum = std::min(minimum, *first);
+			maximum = std::max(maximum, *first);
+		}
+	}
+
+	template <class Real>
+	Real squared_deviations(const Real * first, const Real * last, Real mean) {
+		Real m2 = 0;
+		for (; first != last; ++first)
+			m2 += (*first - mean) * (*first - mean);
+		return m2;
+	}
+
+	inline double sum(const double * first, const double * last) { return simd_sum(first, last); }
+
+	inline void min_max(const double * first, const double * last, double & minimum, double & maximum) {
+		const min_max_result result = simd_min_max(first, last);
+		minimum = std::min(minimum, result.min);
+		maximum = std::max(maximum, result.max);
+	}
+
+	inline double squared_deviations(const double * first, const double * last, double mean) { return simd_squared_deviations(first, last, mean); }
+
+} // namespace running_stats_detail
+
+
+template <class Real = double>
+class running_stats {
+public:
+
+	running_stats()
+		: n(0), average(0), m2(0),
+		  minimum(std::numeric_limits<Real>::infinity()), maximum(-std::numeric_limits<Real>::infinity()),
+		  first_value(0), last_value(0) {}
+
+	// Add one value, O(1)
+	void push(Real value) {
+		if (n == 0)
+			first_value = value;
+		last_value = value;
+
+		++n;
+		const Real delta = value - average;
+		average += delta / Real(n);
+		m2 += delta * (value - average);
+
+		minimum = std::min(minimum, value);
+		maximum = std::max(maximum, value);
+	}
+
+	// Add a contiguous block of values, O(n)
+	// Works chunk by chunk: sum, min and max first, then the squared deviations
+	// from the chunk mean while the chunk is still in L1, then one merge.
+	// Equivalent to push() per value up to rounding, without a division per element;
+	// for double the chunk passes run on the SIMD kernels of this CPU (Simd_Reductions.h)
+	void push(const Real * first, const Real * last) {
+		const std::ptrdiff_t chunk = 1024;
+
+		while (first != last) {
+			const Real * chunk_last = first + std::min<std::ptrdiff_t>(chunk, last - first);
+
+			running_stats block;
+			block.n = std::size_t(chunk_last - first);
+			block.average = running_stats_detail::sum(first, chunk_last) / Real(block.n);
+			running_stats_detail::min_max(first, chunk_last, block.minimum, block.maximum);
+			block.m2 = running_stats_detail::squared_deviations(first, chunk_last, block.average);
+			block.first_value = *first;
+			block.last_value = *(chunk_last - 1);
+
+			merge(block);
+			first = chunk_last;
+		}
+	}
+
+	// Functor form, so the accumulator can be passed to std::for_each
+	void operator()(Real value) { push(value); }
+
+	// Append the statistics of the values that came right after ours, O(1)
+	// Equivalent up to rounding to accumulating the whole sequence in one accumulator
+	void merge(const running_stats & later) {
+		if (later.n == 0)
+			return;
+		if (n == 0) {
+			*this = later;
+			return;
+		}
+
+		const Real total = Real(n + later.n);
+		const Real delta = later.average - average;
+
+		average += delta * (Real(later.n) / total);
+		m2 += later.m2 + delta * delta * (Real(n) * Real(later.n) / total);
+		n += later.n;
+
+		minimum = std::min(minimum, later.minimum);
+		maximum = std::max(maximum, later.maximum);
+		last_value = later.last_value;
+	}
+
+	std::size_t count() const { return n; }
+	bool empty() const { return n == 0; }
+
+	// All of the following are 0 for an empty accumulator
+	Real mean() const { return average; }
+	Real min() const { return n ? minimum : Real(0); }
+	Real max() const { return n ? maximum : Real(0); }
+	Real range() const { return max() - min(); }
+	Real open() const { return first_value; }
+	Real close() const { return last_value; }
+
+	// Unbiased (sample) variance, 0 with fewer than two values
+	Real variance() const { return n > 1 ? m2 / Real(n - 1) : Real(0); }
+	Real stddev() const { return std::sqrt(variance()); }
+
+private:
+	std::size_t n;
+	Real average;
+	Real m2;	// sum of squared deviations from the mean
+	Real minimum, maximum;
+	Real first_value, last_value;
+};
+
+
+// Statistics of a whole range in one pass
+template <class InputIt>
+running_stats<typename std::iterator_traits<InputIt>::value_type> accumulate_stats(InputIt first, InputIt last) {
+	running_stats<typename std::iterator_traits<InputIt>::value_type> stats;
+	for (; first != last; ++first)
+		stats.push(*first);
+	return stats;
+}
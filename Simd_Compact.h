@@ -0,0 +1,481 @@
+/*
+ *	SIMD Stream Compaction
+ *
+ *	copy_if and count_if for float and double arrays whose predicate is a
+ *	comparison with a constant (less_than(0.0) selects the negatives),
+ *	vectorized for AVX2 and AVX-512F and chosen at run time like the
+ *	reductions, with a branchless scalar fallback
+ *
+ *	A vector of elements is compared at once into a bit mask. AVX-512
+ *	packs the selected lanes with a compress instruction; AVX2 looks the
+ *	mask up in a table of lane permutations (16 entries for double, 256
+ *	for float) and packs them with one shuffle. Either way the packed
+ *	vector is stored at the output position, which then advances by the
+ *	number of selected lanes: no branch depends on the data, so the cost
+ *	does not depend on how many elements are selected or in which order.
+ *	The scalar kernel stores every element and advances by 0 or 1. (SSE2
+ *	has no variable shuffle; it runs the scalar kernel.)
+ *
+ *	Full-width stores write past the last selected element, so they are
+ *	only used while the output has room for a whole vector; near the end
+ *	of the output the kernels switch to masked stores, and nothing past
+ *	the selected elements is ever written.
+ *
+ *	Output sizing for std::vector:
+ *	  counted       a count_if pass first, then one exact allocation
+ *	  upper_bound   one pass into room for every element, then shrink
+ *	The parallel version is in Parallel_Compact.h, so this header does not
+ *	depend on the thread pool.
+ *
+ *	The predicates follow the C++ operators: no comparison except
+ *	not_equal_to selects NaN.
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Simd_Reductions.h"
+
+
+// The comparisons the kernels evaluate
+enum class compare_op { less, less_equal, greater, greater_equal, equal_to, not_equal_to };
+
+// x <op> threshold, usable as an ordinary predicate too (std::copy_if, parallel::copy_if)
+template <class Value>
+struct threshold_predicate {
+	compare_op op;
+	Value threshold;
+
+	bool operator()(const Value & x) const {
+		switch (op) {
+		case compare_op::less: return x < threshold;
+		case compare_op::less_equal: return x <= threshold;
+		case compare_op::greater: return x > threshold;
+		case compare_op::greater_equal: return x >= threshold;
+		case compare_op::equal_to: return x == threshold;
+		default: return x != threshold;
+		}
+	}
+};
+
+template <class Value> threshold_predicate<Value> less_than(Value threshold) { return { compare_op::less, threshold }; }
+template <class Value> threshold_predicate<Value> less_equal(Value threshold) { return { compare_op::less_equal, threshold }; }
+template <class Value> threshold_predicate<Value> greater_than(Value threshold) { return { compare_op::greater, threshold }; }
+template <class Value> threshold_predicate<Value> greater_equal(Value threshold) { return { compare_op::greater_equal, threshold }; }
+template <class Value> threshold_predicate<Value> equal_to_value(Value threshold) { return { compare_op::equal_to, threshold }; }
+template <class Value> threshold_predicate<Value> not_equal_to_value(Value threshold) { return { compare_op::not_equal_to, threshold }; }
+
+
+namespace simd_compact_detail {
+
+	template <compare_op Op, class Value>
+	inline bool compare(Value x, Value threshold) {
+		return threshold_predicate<Value>{ Op, threshold }(x);
+	}
+
+
+	// Scalar kernels
+
+	template <compare_op Op, class Value>
+	std::size_t count_scalar(const Value * in, std::size_t n, Value threshold) {
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < n; ++i)
+			count += compare<Op>(in[i], threshold);
+		return count;
+	}
+
+	// Writes the selected elements of in[0, n) to out, returns how many
+	// out[0, capacity) may be overwritten; nothing past the selected elements is written beyond it
+	template <compare_op Op, class Value>
+	std::size_t compact_scalar(const Value * in, std::size_t n, Value * out, std::size_t capacity, Value threshold) {
+		const std::size_t block = 64;
+		Value buffer[block];
+		std::size_t written = 0;
+		for (std::size_t i = 0; i < n; i += block) {
+			const std::size_t size = std::min(block, n - i);
+
+			// Every element is stored and the position advances by 0 or 1: no data-dependent branch.
+			// Straight to the output while it has room for the whole block, through the buffer otherwise
+			Value * target = written + size <= capacity ? out + written : buffer;
+			std::size_t count = 0;
+			for (std::size_t j = 0; j < size; ++j) {
+				const Value x = in[i + j];
+				target[count] = x;
+				count += compare<Op>(x, threshold);
+			}
+			if (target == buffer)
+				std::copy(buffer, buffer + count, out + written);
+			written += count;
+		}
+		return written;
+	}
+
+
+#if SIMD_REDUCTIONS_X86
+
+	// Lane permutations that move the selected lanes to the front, in order,
+	// as eight 4-bit 32-bit-lane indices per mask, and the popcount of every mask
+	struct compress_tables {
+		std::uint32_t double_lanes[16];
+		std::uint32_t float_lanes[256];
+		unsigned char popcount[256];
+
+		// -1 x8 then 0 x8: 8 - k onwards is the store mask of the first k 32-bit lanes
+		std::int32_t prefix[16];
+
+		compress_tables() {
+			for (unsigned mask = 0; mask < 256; ++mask) {
+				unsigned count = 0;
+				std::uint32_t lanes = 0;
+				for (unsigned lane = 0; lane < 8; ++lane)
+					if (mask & (1u << lane))
+						lanes |= std::uint32_t(lane) << (4 * count++);
+				float_lanes[mask] = lanes;
+				popcount[mask] = (unsigned char)count;
+			}
+			// A double is two 32-bit lanes, 2d and 2d + 1
+			for (unsigned mask = 0; mask < 16; ++mask) {
+				unsigned count = 0;
+				std::uint32_t lanes = 0;
+				for (unsigned lane = 0; lane < 4; ++lane)
+					if (mask & (1u << lane)) {
+						lanes |= std::uint32_t(2 * lane) << (8 * count);
+						lanes |= std::uint32_t(2 * lane + 1) << (8 * count + 4);
+						++count;
+					}
+				double_lanes[mask] = lanes;
+			}
+			for (int i = 0; i < 16; ++i)
+				prefix[i] = i < 8 ? -1 : 0;
+		}
+
+		static const compress_tables & get() {
+			static const compress_tables tables;
+			return tables;
+		}
+	};
+
+	// The _CMP_ predicate of each comparison: ordered, except != (NaN != x)
+	template <compare_op Op>
+	struct compare_imm {
+		static const int value = Op == compare_op::less ? _CMP_LT_OQ : Op == compare_op::less_equal ? _CMP_LE_OQ
+			: Op == compare_op::greater ? _CMP_GT_OQ : Op == compare_op::greater_equal ? _CMP_GE_OQ
+			: Op == compare_op::equal_to ? _CMP_EQ_OQ : _CMP_NEQ_UQ;
+	};
+
+
+	// AVX2: 4 doubles or 8 floats per vector, permutation table and vpermd
+
+	template <compare_op Op>
+	SIMD_REDUCTIONS_TARGET("avx2")
+	std::size_t count_double_avx2(const double * in, std::size_t n, double threshold) {
+		const compress_tables & tables = compress_tables::get();
+		const __m256d t = _mm256_set1_pd(threshold);
+		std::size_t count = 0, i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const unsigned low = (unsigned)_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(in + i), t, compare_imm<Op>::value));
+			const unsigned high = (unsigned)_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(in + i + 4), t, compare_imm<Op>::value));
+			count += tables.popcount[low | (high << 4)];
+		}
+		return count + count_scalar<Op>(in + i, n - i, threshold);
+	}
+
+	template <compare_op Op>
+	SIMD_REDUCTIONS_TARGET("avx2")
+	std::size_t count_float_avx2(const float * in, std::size_t n, float threshold) {
+		const compress_tables & tables = compress_tables::get();
+		const __m256 t = _mm256_set1_ps(threshold);
+		std::size_t count = 0, i = 0;
+		for (; i + 8 <= n; i += 8)
+			count += tables.popcount[(unsigned)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(in + i), t, compare_imm<Op>::value))];
+		return count + count_scalar<Op>(in + i, n - i, threshold);
+	}
+
+	template <compare_op Op>
+	SIMD_REDUCTIONS_TARGET("avx2")
+	std::size_t compact_double_avx2(const double * in, std::size_t n, double * out, std::size_t capacity, double threshold) {
+		const compress_tables & tables = compress_tables::get();
+		const __m256d t = _mm256_set1_pd(threshold);
+		const __m256i shifts = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+		const __m256i nibble = _mm256_set1_epi32(15);
+
+		std::size_t written = 0, i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m256d x = _mm256_loadu_pd(in + i);
+			const unsigned mask = (unsigned)_mm256_movemask_pd(_mm256_cmp_pd(x, t, compare_imm<Op>::value));
+			const __m256i lanes = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32((int)tables.double_lanes[mask]), shifts), nibble);
+			const __m256d packed = _mm256_castps_pd(_mm256_permutevar8x32_ps(_mm256_castpd_ps(x), lanes));
+			const unsigned count = tables.popcount[mask];
+
+			if (written + 4 <= capacity)
+				_mm256_storeu_pd(out + written, packed);
+			else
+				_mm256_maskstore_pd(out + written, _mm256_loadu_si256((const __m256i *)(tables.prefix + 8 - 2 * count)), packed);
+			written += count;
+		}
+		return written + compact_scalar<Op>(in + i, n - i, out + written, capacity > written ? capacity - written : 0, threshold);
+	}
+
+	template <compare_op Op>
+	SIMD_REDUCTIONS_TARGET("avx2")
+	std::size_t compact_float_avx2(const float * in, std::size_t n, float * out, std::size_t capacity, float threshold) {
+		const compress_tables & tables = compress_tables::get();
+		const __m256 t = _mm256_set1_ps(threshold);
+		const __m256i shifts = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+		const __m256i nibble = _mm256_set1_epi32(15);
+
+		std::size_t written = 0, i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256 x = _mm256_loadu_ps(in + i);
+			const unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_cmp_ps(x, t, compare_imm<Op>::value));
+			const __m256i lanes = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32((int)tables.float_lanes[mask]), shifts), nibble);
+			const __m256 packed = _mm256_permutevar8x32_ps(x, lanes);
+			const unsigned count = tables.popcount[mask];
+
+			if (written + 8 <= capacity)
+				_mm256_storeu_ps(out + written, packed);
+			else
+				_mm256_maskstore_ps(out + written, _mm256_loadu_si256((const __m256i *)(tables.prefix + 8 - count)), packed);
+			written += count;
+		}
+		return written + compact_scalar<Op>(in + i, n - i, out + written, capacity > written ? capacity - written : 0, threshold);
+	}
+
+
+	// AVX-512F: 8 doubles or 16 floats per vector, compress instruction
+
+	template <compare_op Op>
+	SIMD_REDUCTIONS_TARGET("avx512f")
+	std::size_t count_double_avx512(const double * in, std::size_t n, double threshold) {
+		const compress_tables & tables = compress_tables::get();
+		const __m512d t = _mm512_set1_pd(threshold);
+		std::size_t count = 0, i = 0;
+		for (; i + 8 <= n; i += 8)
+			count += tables.popcount[(unsigned)_mm512_cmp_pd_mask(_mm512_loadu_pd(in + i), t, compare_imm<Op>::value)];
+		return count + count_scalar<Op>(in + i, n - i, threshold);
+	}
+
+	template <compare_op Op>
+	SIMD_REDUCTIONS_TARGET("avx512f")
+	std::size_t count_float_avx512(const float * in, std::size_t n, float threshold) {
+		const compress_tables & tables = compress_tables::get();
+		const __m512 t = _mm512_set1_ps(threshold);
+		std::size_t count = 0, i = 0;
+		for (; i + 16 <= n; i += 16) {
+			const unsigned mask = (unsigned)_mm512_cmp_ps_mask(_mm512_loadu_ps(in + i), t, compare_imm<Op>::value);
+			count += tables.popcount[mask & 255] + tables.popcount[mask >> 8];
+		}
+		return count + count_scalar<Op>(in + i, n - i, threshold);
+	}
+
+	template <compare_op Op>
+	SIMD_REDUCTIONS_TARGET("avx512f")
+	std::size_t compact_double_avx512(const double * in, std::size_t n, double * out, std::size_t capacity, double threshold) {
+		const compress_tables & tables = compress_tables::get();
+		const __m512d t = _mm512_set1_pd(threshold);
+		std::size_t written = 0, i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m512d x = _mm512_loadu_pd(in + i);
+			const __mmask8 mask = _mm512_cmp_pd_mask(x, t, compare_imm<Op>::value);
+			const unsigned count = tables.popcount[(unsigned)mask];
+
+			// Compress to a register and store it whole: compressing straight to memory is slow on several cores
+			const __m512d packed = _mm512_maskz_compress_pd(mask, x);
+			if (written + 8 <= capacity)
+				_mm512_storeu_pd(out + written, packed);
+			else
+				_mm512_mask_storeu_pd(out + written, __mmask8((1u << count) - 1), packed);
+			written += count;
+		}
+		return written + compact_scalar<Op>(in + i, n - i, out + written, capacity > written ? capacity - written : 0, threshold);
+	}
+
+	template <compare_op Op>
+	SIMD_REDUCTIONS_TARGET("avx512f")
+	std::size_t compact_float_avx512(const float * in, std::size_t n, float * out, std::size_t capacity, float threshold) {
+		const compress_tables & tables = compress_tables::get();
+		const __m512 t = _mm512_set1_ps(threshold);
+		std::size_t written = 0, i = 0;
+		for (; i + 16 <= n; i += 16) {
+			const __m512 x = _mm512_loadu_ps(in + i);
+			const __mmask16 mask = _mm512_cmp_ps_mask(x, t, compare_imm<Op>::value);
+			const unsigned count = tables.popcount[(unsigned)mask & 255] + tables.popcount[(unsigned)mask >> 8];
+
+			const __m512 packed = _mm512_maskz_compress_ps(mask, x);
+			if (written + 16 <= capacity)
+				_mm512_storeu_ps(out + written, packed);
+			else
+				_mm512_mask_storeu_ps(out + written, __mmask16((1u << count) - 1), packed);
+			written += count;
+		}
+		return written + compact_scalar<Op>(in + i, n - i, out + written, capacity > written ? capacity - written : 0, threshold);
+	}
+
+#endif
+
+
+	// One entry point per kernel family: the comparison is picked once, outside the loop
+
+#define SIMD_COMPACT_DISPATCH(kernel, ...)						\
+	switch (pred.op) {								\
+	case compare_op::less: return kernel<compare_op::less>(__VA_ARGS__);		\
+	case compare_op::less_equal: return kernel<compare_op::less_equal>(__VA_ARGS__);	\
+	case compare_op::greater: return kernel<compare_op::greater>(__VA_ARGS__);	\
+	case compare_op::greater_equal: return kernel<compare_op::greater_equal>(__VA_ARGS__); \
+	case compare_op::equal_to: return kernel<compare_op::equal_to>(__VA_ARGS__);	\
+	default: return kernel<compare_op::not_equal_to>(__VA_ARGS__);			\
+	}
+
+	template <class Value>
+	std::size_t count_scalar_any(const Value * in, std::size_t n, threshold_predicate<Value> pred) {
+		SIMD_COMPACT_DISPATCH(count_scalar, in, n, pred.threshold)
+	}
+
+	template <class Value>
+	std::size_t compact_scalar_any(const Value * in, std::size_t n, Value * out, std::size_t capacity, threshold_predicate<Value> pred) {
+		SIMD_COMPACT_DISPATCH(compact_scalar, in, n, out, capacity, pred.threshold)
+	}
+
+#if SIMD_REDUCTIONS_X86
+
+	inline std::size_t count_double_avx2_any(const double * in, std::size_t n, threshold_predicate<double> pred) {
+		SIMD_COMPACT_DISPATCH(count_double_avx2, in, n, pred.threshold)
+	}
+	inline std::size_t count_float_avx2_any(const float * in, std::size_t n, threshold_predicate<float> pred) {
+		SIMD_COMPACT_DISPATCH(count_float_avx2, in, n, pred.threshold)
+	}
+	inline std::size_t compact_double_avx2_any(const double * in, std::size_t n, double * out, std::size_t capacity, threshold_predicate<double> pred) {
+		SIMD_COMPACT_DISPATCH(compact_double_avx2, in, n, out, capacity, pred.threshold)
+	}
+	inline std::size_t compact_float_avx2_any(const float * in, std::size_t n, float * out, std::size_t capacity, threshold_predicate<float> pred) {
+		SIMD_COMPACT_DISPATCH(compact_float_avx2, in, n, out, capacity, pred.threshold)
+	}
+
+	inline std::size_t count_double_avx512_any(const double * in, std::size_t n, threshold_predicate<double> pred) {
+		SIMD_COMPACT_DISPATCH(count_double_avx512, in, n, pred.threshold)
+	}
+	inline std::size_t count_float_avx512_any(const float * in, std::size_t n, threshold_predicate<float> pred) {
+		SIMD_COMPACT_DISPATCH(count_float_avx512, in, n, pred.threshold)
+	}
+	inline std::size_t compact_double_avx512_any(const double * in, std::size_t n, double * out, std::size_t capacity, threshold_predicate<double> pred) {
+		SIMD_COMPACT_DISPATCH(compact_double_avx512, in, n, out, capacity, pred.threshold)
+	}
+	inline std::size_t compact_float_avx512_any(const float * in, std::size_t n, float * out, std::size_t capacity, threshold_predicate<float> pred) {
+		SIMD_COMPACT_DISPATCH(compact_float_avx512, in, n, out, capacity, pred.threshold)
+	}
+
+#endif
+
+#undef SIMD_COMPACT_DISPATCH
+
+} // namespace simd_compact_detail
+
+
+// One set of kernels, all for the same instruction set
+// compact_*(in, n, out, capacity, pred) writes the selected elements of in[0, n) to out and
+// returns how many; out[0, max(capacity, returned count)) is all it writes
+struct simd_compact_kernels {
+
+	simd_level level;
+	std::size_t (*count_double)(const double *, std::size_t, threshold_predicate<double>);
+	std::size_t (*count_float)(const float *, std::size_t, threshold_predicate<float>);
+	std::size_t (*compact_double)(const double *, std::size_t, double *, std::size_t, threshold_predicate<double>);
+	std::size_t (*compact_float)(const float *, std::size_t, float *, std::size_t, threshold_predicate<float>);
+
+	// Kernels for 'level', or the best one supported below it (SSE2 runs the scalar kernels)
+	static simd_compact_kernels for_level(simd_level level) {
+		level = std::min(level, simd_reductions::best_level());
+#if SIMD_REDUCTIONS_X86
+		switch (level) {
+		case simd_level::avx512:
+			return { level, simd_compact_detail::count_double_avx512_any, simd_compact_detail::count_float_avx512_any,
+				 simd_compact_detail::compact_double_avx512_any, simd_compact_detail::compact_float_avx512_any };
+		case simd_level::avx2:
+			return { level, simd_compact_detail::count_double_avx2_any, simd_compact_detail::count_float_avx2_any,
+				 simd_compact_detail::compact_double_avx2_any, simd_compact_detail::compact_float_avx2_any };
+		default:
+			break;
+		}
+#endif
+		return { simd_level::scalar, simd_compact_detail::count_scalar_any<double>, simd_compact_detail::count_scalar_any<float>,
+			 simd_compact_detail::compact_scalar_any<double>, simd_compact_detail::compact_scalar_any<float> };
+	}
+
+	static const simd_compact_kernels & best() {
+		static const simd_compact_kernels kernels = for_level(simd_reductions::best_level());
+		return kernels;
+	}
+};
+
+
+namespace simd_compact_detail {
+
+	inline std::size_t count(const double * in, std::size_t n, threshold_predicate<double> pred) {
+		return simd_compact_kernels::best().count_double(in, n, pred);
+	}
+	inline std::size_t count(const float * in, std::size_t n, threshold_predicate<float> pred) {
+		return simd_compact_kernels::best().count_float(in, n, pred);
+	}
+	inline std::size_t compact(const double * in, std::size_t n, double * out, std::size_t capacity, threshold_predicate<double> pred) {
+		return simd_compact_kernels::best().compact_double(in, n, out, capacity, pred);
+	}
+	inline std::size_t compact(const float * in, std::size_t n, float * out, std::size_t capacity, threshold_predicate<float> pred) {
+		return simd_compact_kernels::best().compact_float(in, n, out, capacity, pred);
+	}
+
+}
+
+
+// How a std::vector output is sized
+enum class output_sizing {
+	counted,	// count first, then allocate exactly: two reads of the input, no spare memory
+	upper_bound	// room for every element, then shrink: one read, n elements allocated at the peak
+};
+
+
+// Dispatching entry points for float and double
+
+// Number of elements satisfying 'pred', O(n)
+template <class Value>
+std::size_t simd_count_if(const Value * first, const Value * last, threshold_predicate<Value> pred) {
+	return simd_compact_detail::count(first, std::size_t(last - first), pred);
+}
+
+// std::copy_if into a buffer with room for the result (see simd_count_if), returns the end of the output; O(n)
+// 'capacity' is the room at d_first, if known: the kernels store whole vectors while the
+// output has room for one, and masked stores (scalar: a branch per element) only beyond it.
+// The default 0 writes only the selected elements, but takes that slower path throughout
+template <class Value>
+Value * simd_copy_if(const Value * first, const Value * last, Value * d_first, threshold_predicate<Value> pred,
+		     std::size_t capacity = 0) {
+	return d_first + simd_compact_detail::compact(first, std::size_t(last - first), d_first, capacity, pred);
+}
+
+// Appends the selected elements to 'out', returns how many
+// O(n), one allocation at most
+template <class Value>
+std::size_t simd_copy_if(const Value * first, const Value * last, std::vector<Value> & out, threshold_predicate<Value> pred,
+			 output_sizing sizing = output_sizing::counted) {
+	const std::size_t n = std::size_t(last - first), start = out.size();
+	if (n == 0)
+		return 0;
+
+	if (sizing == output_sizing::counted) {
+		const std::size_t count = simd_compact_detail::count(first, n, pred);
+		out.resize(start + count);
+		if (count != 0)
+			simd_compact_detail::compact(first, n, &out[start], count, pred);
+		return count;
+	}
+
+	out.resize(start + n);
+	const std::size_t count = simd_compact_detail::compact(first, n, &out[start], n, pred);
+	out.resize(start + count);
+	return count;
+}
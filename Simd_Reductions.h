@@ -0,0 +1,413 @@
+/*
+ *	SIMD Reductions
+ *
+ *	Sum, min, max and sum of squared deviations over double arrays,
+ *	vectorized for SSE2, AVX2 (+FMA) and AVX-512F and chosen at run time
+ *	from cpuid, with a portable scalar fallback
+ *
+ *	Every kernel keeps four independent vector accumulators, so the loop
+ *	is bound by loads instead of by the latency of one serial chain of
+ *	additions. The lanes are combined in a fixed order at the end, so a
+ *	given instruction set always returns the same result for the same input.
+ *
+ *	Tolerances against a sequential scalar loop:
+ *	  min, max             exact (the same element is found)
+ *	  sum                  reassociated: |difference| <= (n - 1) * eps * sum |x_i|
+ *	  squared deviations   same bound over the terms (x_i - mean)^2; the AVX2 and
+ *	                       AVX-512 kernels use fused multiply-add, one rounding fewer
+ *	where eps = 2^-53. The lane-wise split usually makes the sum more accurate
+ *	than the sequential loop, not less. NaN inputs give an unspecified result,
+ *	as with std::min_element and std::max_element.
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_REDUCTIONS_X86 1
+#define SIMD_REDUCTIONS_TARGET(isa) __attribute__((target(isa)))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define SIMD_REDUCTIONS_X86 1
+#define SIMD_REDUCTIONS_TARGET(isa)
+#include <immintrin.h>
+#include <intrin.h>
+#else
+#define SIMD_REDUCTIONS_X86 0
+#endif
+
+
+// Instruction sets, from the slowest to the fastest
+enum class simd_level { scalar, sse2, avx2, avx512 };
+
+inline const char * simd_level_name(simd_level level) {
+	switch (level) {
+	case simd_level::sse2: return "SSE2";
+	case simd_level::avx2: return "AVX2";
+	case simd_level::avx512: return "AVX-512";
+	default: return "scalar";
+	}
+}
+
+
+// Minimum and maximum of a range, found in one pass
+struct min_max_result {
+	double min;
+	double max;
+};
+
+
+namespace simd_detail {
+
+	// Scalar: four accumulators, portable
+
+	inline double sum_scalar(const double * p, std::size_t n) {
+		double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+		std::size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			s0 += p[i];
+			s1 += p[i + 1];
+			s2 += p[i + 2];
+			s3 += p[i + 3];
+		}
+		for (; i < n; ++i)
+			s0 += p[i];
+		return (s0 + s1) + (s2 + s3);
+	}
+
+	inline min_max_result min_max_scalar(const double * p, std::size_t n) {
+		min_max_result result = { std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity() };
+		for (std::size_t i = 0; i < n; ++i) {
+			result.min = std::min(result.min, p[i]);
+			result.max = std::max(result.max, p[i]);
+		}
+		return result;
+	}
+
+	inline double squared_deviations_scalar(const double * p, std::size_t n, double mean) {
+		double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+		std::size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const double d0 = p[i] - mean, d1 = p[i + 1] - mean, d2 = p[i + 2] - mean, d3 = p[i + 3] - mean;
+			s0 += d0 * d0;
+			s1 += d1 * d1;
+			s2 += d2 * d2;
+			s3 += d3 * d3;
+		}
+		for (; i < n; ++i)
+			s0 += (p[i] - mean) * (p[i] - mean);
+		return (s0 + s1) + (s2 + s3);
+	}
+
+	// Add up the lanes of a vector stored to memory, in a fixed order
+	inline double add_lanes(const double * lanes, std::size_t count) {
+		double sum = 0;
+		for (std::size_t i = 0; i < count; ++i)
+			sum += lanes[i];
+		return sum;
+	}
+
+
+#if SIMD_REDUCTIONS_X86
+
+	// SSE2: 2 doubles per vector, 8 per iteration
+
+	SIMD_REDUCTIONS_TARGET("sse2")
+	inline double sum_sse2(const double * p, std::size_t n) {
+		__m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd(), s2 = _mm_setzero_pd(), s3 = _mm_setzero_pd();
+		std::size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			s0 = _mm_add_pd(s0, _mm_loadu_pd(p + i));
+			s1 = _mm_add_pd(s1, _mm_loadu_pd(p + i + 2));
+			s2 = _mm_add_pd(s2, _mm_loadu_pd(p + i + 4));
+			s3 = _mm_add_pd(s3, _mm_loadu_pd(p + i + 6));
+		}
+		alignas(16) double lanes[2];
+		_mm_store_pd(lanes, _mm_add_pd(_mm_add_pd(s0, s1), _mm_add_pd(s2, s3)));
+		return add_lanes(lanes, 2) + sum_scalar(p + i, n - i);
+	}
+
+	SIMD_REDUCTIONS_TARGET("sse2")
+	inline min_max_result min_max_sse2(const double * p, std::size_t n) {
+		__m128d lo0 = _mm_set1_pd(std::numeric_limits<double>::infinity()), lo1 = lo0;
+		__m128d hi0 = _mm_set1_pd(-std::numeric_limits<double>::infinity()), hi1 = hi0;
+		std::size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m128d a = _mm_loadu_pd(p + i), b = _mm_loadu_pd(p + i + 2);
+			lo0 = _mm_min_pd(lo0, a);
+			lo1 = _mm_min_pd(lo1, b);
+			hi0 = _mm_max_pd(hi0, a);
+			hi1 = _mm_max_pd(hi1, b);
+		}
+		alignas(16) double lo[2], hi[2];
+		_mm_store_pd(lo, _mm_min_pd(lo0, lo1));
+		_mm_store_pd(hi, _mm_max_pd(hi0, hi1));
+
+		min_max_result result = min_max_scalar(p + i, n - i);
+		result.min = std::min(result.min, std::min(lo[0], lo[1]));
+		result.max = std::max(result.max, std::max(hi[0], hi[1]));
+		return result;
+	}
+
+	SIMD_REDUCTIONS_TARGET("sse2")
+	inline double squared_deviations_sse2(const double * p, std::size_t n, double mean) {
+		const __m128d m = _mm_set1_pd(mean);
+		__m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd(), s2 = _mm_setzero_pd(), s3 = _mm_setzero_pd();
+		std::size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m128d d0 = _mm_sub_pd(_mm_loadu_pd(p + i), m);
+			const __m128d d1 = _mm_sub_pd(_mm_loadu_pd(p + i + 2), m);
+			const __m128d d2 = _mm_sub_pd(_mm_loadu_pd(p + i + 4), m);
+			const __m128d d3 = _mm_sub_pd(_mm_loadu_pd(p + i + 6), m);
+			s0 = _mm_add_pd(s0, _mm_mul_pd(d0, d0));
+			s1 = _mm_add_pd(s1, _mm_mul_pd(d1, d1));
+			s2 = _mm_add_pd(s2, _mm_mul_pd(d2, d2));
+			s3 = _mm_add_pd(s3, _mm_mul_pd(d3, d3));
+		}
+		alignas(16) double lanes[2];
+		_mm_store_pd(lanes, _mm_add_pd(_mm_add_pd(s0, s1), _mm_add_pd(s2, s3)));
+		return add_lanes(lanes, 2) + squared_deviations_scalar(p + i, n - i, mean);
+	}
+
+
+	// AVX2 + FMA: 4 doubles per vector, 16 per iteration
+
+	SIMD_REDUCTIONS_TARGET("avx2,fma")
+	inline double sum_avx2(const double * p, std::size_t n) {
+		__m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+		std::size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			s0 = _mm256_add_pd(s0, _mm256_loadu_pd(p + i));
+			s1 = _mm256_add_pd(s1, _mm256_loadu_pd(p + i + 4));
+			s2 = _mm256_add_pd(s2, _mm256_loadu_pd(p + i + 8));
+			s3 = _mm256_add_pd(s3, _mm256_loadu_pd(p + i + 12));
+		}
+		alignas(32) double lanes[4];
+		_mm256_store_pd(lanes, _mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+		return add_lanes(lanes, 4) + sum_scalar(p + i, n - i);
+	}
+
+	SIMD_REDUCTIONS_TARGET("avx2,fma")
+	inline min_max_result min_max_avx2(const double * p, std::size_t n) {
+		__m256d lo0 = _mm256_set1_pd(std::numeric_limits<double>::infinity()), lo1 = lo0;
+		__m256d hi0 = _mm256_set1_pd(-std::numeric_limits<double>::infinity()), hi1 = hi0;
+		std::size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256d a = _mm256_loadu_pd(p + i), b = _mm256_loadu_pd(p + i + 4);
+			lo0 = _mm256_min_pd(lo0, a);
+			lo1 = _mm256_min_pd(lo1, b);
+			hi0 = _mm256_max_pd(hi0, a);
+			hi1 = _mm256_max_pd(hi1, b);
+		}
+		alignas(32) double lo[4], hi[4];
+		_mm256_store_pd(lo, _mm256_min_pd(lo0, lo1));
+		_mm256_store_pd(hi, _mm256_max_pd(hi0, hi1));
+
+		min_max_result result = min_max_scalar(p + i, n - i);
+		for (int lane = 0; lane < 4; ++lane) {
+			result.min = std::min(result.min, lo[lane]);
+			result.max = std::max(result.max, hi[lane]);
+		}
+		return result;
+	}
+
+	SIMD_REDUCTIONS_TARGET("avx2,fma")
+	inline double squared_deviations_avx2(const double * p, std::size_t n, double mean) {
+		const __m256d m = _mm256_set1_pd(mean);
+		__m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+		std::size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			const __m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(p + i), m);
+			const __m256d d1 = _mm256_sub_pd(_mm256_loadu_pd(p + i + 4), m);
+			const __m256d d2 = _mm256_sub_pd(_mm256_loadu_pd(p + i + 8), m);
+			const __m256d d3 = _mm256_sub_pd(_mm256_loadu_pd(p + i + 12), m);
+			s0 = _mm256_fmadd_pd(d0, d0, s0);
+			s1 = _mm256_fmadd_pd(d1, d1, s1);
+			s2 = _mm256_fmadd_pd(d2, d2, s2);
+			s3 = _mm256_fmadd_pd(d3, d3, s3);
+		}
+		alignas(32) double lanes[4];
+		_mm256_store_pd(lanes, _mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+		return add_lanes(lanes, 4) + squared_deviations_scalar(p + i, n - i, mean);
+	}
+
+
+	// AVX-512F: 8 doubles per vector, 32 per iteration
+
+	// GCC flags its own _mm512_undefined_pd() in the min and max intrinsics
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+	SIMD_REDUCTIONS_TARGET("avx512f")
+	inline double sum_avx512(const double * p, std::size_t n) {
+		__m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd(), s2 = _mm512_setzero_pd(), s3 = _mm512_setzero_pd();
+		std::size_t i = 0;
+		for (; i + 32 <= n; i += 32) {
+			s0 = _mm512_add_pd(s0, _mm512_loadu_pd(p + i));
+			s1 = _mm512_add_pd(s1, _mm512_loadu_pd(p + i + 8));
+			s2 = _mm512_add_pd(s2, _mm512_loadu_pd(p + i + 16));
+			s3 = _mm512_add_pd(s3, _mm512_loadu_pd(p + i + 24));
+		}
+		alignas(64) double lanes[8];
+		_mm512_store_pd(lanes, _mm512_add_pd(_mm512_add_pd(s0, s1), _mm512_add_pd(s2, s3)));
+		return add_lanes(lanes, 8) + sum_scalar(p + i, n - i);
+	}
+
+	SIMD_REDUCTIONS_TARGET("avx512f")
+	inline min_max_result min_max_avx512(const double * p, std::size_t n) {
+		__m512d lo0 = _mm512_set1_pd(std::numeric_limits<double>::infinity()), lo1 = lo0;
+		__m512d hi0 = _mm512_set1_pd(-std::numeric_limits<double>::infinity()), hi1 = hi0;
+		std::size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			const __m512d a = _mm512_loadu_pd(p + i), b = _mm512_loadu_pd(p + i + 8);
+			lo0 = _mm512_min_pd(lo0, a);
+			lo1 = _mm512_min_pd(lo1, b);
+			hi0 = _mm512_max_pd(hi0, a);
+			hi1 = _mm512_max_pd(hi1, b);
+		}
+		alignas(64) double lo[8], hi[8];
+		_mm512_store_pd(lo, _mm512_min_pd(lo0, lo1));
+		_mm512_store_pd(hi, _mm512_max_pd(hi0, hi1));
+
+		min_max_result result = min_max_scalar(p + i, n - i);
+		for (int lane = 0; lane < 8; ++lane) {
+			result.min = std::min(result.min, lo[lane]);
+			result.max = std::max(result.max, hi[lane]);
+		}
+		return result;
+	}
+
+	SIMD_REDUCTIONS_TARGET("avx512f")
+	inline double squared_deviations_avx512(const double * p, std::size_t n, double mean) {
+		const __m512d m = _mm512_set1_pd(mean);
+		__m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd(), s2 = _mm512_setzero_pd(), s3 = _mm512_setzero_pd();
+		std::size_t i = 0;
+		for (; i + 32 <= n; i += 32) {
+			const __m512d d0 = _mm512_sub_pd(_mm512_loadu_pd(p + i), m);
+			const __m512d d1 = _mm512_sub_pd(_mm512_loadu_pd(p + i + 8), m);
+			const __m512d d2 = _mm512_sub_pd(_mm512_loadu_pd(p + i + 16), m);
+			const __m512d d3 = _mm512_sub_pd(_mm512_loadu_pd(p + i + 24), m);
+			s0 = _mm512_fmadd_pd(d0, d0, s0);
+			s1 = _mm512_fmadd_pd(d1, d1, s1);
+			s2 = _mm512_fmadd_pd(d2, d2, s2);
+			s3 = _mm512_fmadd_pd(d3, d3, s3);
+		}
+		alignas(64) double lanes[8];
+		_mm512_store_pd(lanes, _mm512_add_pd(_mm512_add_pd(s0, s1), _mm512_add_pd(s2, s3)));
+		return add_lanes(lanes, 8) + squared_deviations_scalar(p + i, n - i, mean);
+	}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+
+	// The best instruction set both the CPU and the operating system support
+	// (the OS must save the wider registers on a context switch)
+	inline simd_level detect_simd_level() {
+#if defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 0);
+		const int max_leaf = info[0];
+
+		__cpuid(info, 1);
+		const bool sse2 = (info[3] & (1 << 26)) != 0;
+		const bool fma = (info[2] & (1 << 12)) != 0;
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+
+		bool avx2 = false, avx512 = false;
+		if (max_leaf >= 7) {
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0 && fma && (xcr0 & 0x6) == 0x6;
+			avx512 = (info[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6;
+		}
+#else
+		__builtin_cpu_init();
+		const bool sse2 = __builtin_cpu_supports("sse2");
+		const bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+		const bool avx512 = __builtin_cpu_supports("avx512f");
+#endif
+		if (avx512)
+			return simd_level::avx512;
+		if (avx2)
+			return simd_level::avx2;
+		if (sse2)
+			return simd_level::sse2;
+		return simd_level::scalar;
+	}
+
+#else
+
+	inline simd_level detect_simd_level() { return simd_level::scalar; }
+
+#endif
+
+} // namespace simd_detail
+
+
+// One set of kernels, all for the same instruction set
+struct simd_reductions {
+
+	simd_level level;
+	double (*sum)(const double *, std::size_t);
+	min_max_result (*min_max)(const double *, std::size_t);
+	double (*squared_deviations)(const double *, std::size_t, double);
+
+	// Kernels for 'level', or the best one supported below it
+	static simd_reductions for_level(simd_level level) {
+		level = std::min(level, best_level());
+#if SIMD_REDUCTIONS_X86
+		switch (level) {
+		case simd_level::avx512:
+			return { level, simd_detail::sum_avx512, simd_detail::min_max_avx512, simd_detail::squared_deviations_avx512 };
+		case simd_level::avx2:
+			return { level, simd_detail::sum_avx2, simd_detail::min_max_avx2, simd_detail::squared_deviations_avx2 };
+		case simd_level::sse2:
+			return { level, simd_detail::sum_sse2, simd_detail::min_max_sse2, simd_detail::squared_deviations_sse2 };
+		default:
+			break;
+		}
+#endif
+		return { simd_level::scalar, simd_detail::sum_scalar, simd_detail::min_max_scalar, simd_detail::squared_deviations_scalar };
+	}
+
+	// Detected once, on first use
+	static simd_level best_level() {
+		static const simd_level level = simd_detail::detect_simd_level();
+		return level;
+	}
+
+	static const simd_reductions & best() {
+		static const simd_reductions kernels = for_level(best_level());
+		return kernels;
+	}
+};
+
+
+// Dispatching entry points, O(n)
+
+inline double simd_sum(const double * first, const double * last) {
+	return simd_reductions::best().sum(first, std::size_t(last - first));
+}
+
+// +infinity and -infinity for an empty range
+inline min_max_result simd_min_max(const double * first, const double * last) {
+	return simd_reductions::best().min_max(first, std::size_t(last - first));
+}
+
+inline double simd_min(const double * first, const double * last) { return simd_min_max(first, last).min; }
+inline double simd_max(const double * first, const double * last) { return simd_min_max(first, last).max; }
+
+// Sum of (x - mean)^2, the numerator of the variance
+inline double simd_squared_deviations(const double * first, const double * last, double mean) {
+	return simd_reductions::best().squared_deviations(first, std::size_t(last - first), mean);
+}
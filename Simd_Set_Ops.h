@@ -0,0 +1,588 @@
+/*
+ *	SIMD Set Operations
+ *
+ *	Intersection, union and difference of sorted sets of 32- and 64-bit
+ *	integers (strictly increasing arrays, such as posting lists), and the
+ *	intersection of many sets at once, with the sizes of the results
+ *	computed without writing them
+ *
+ *	std::set_intersection branches on every comparison, and with random
+ *	data half of those branches are mispredicted. The kernels here pick
+ *	their method from the sizes of the inputs:
+ *
+ *	  similar sizes   block compare: a vector of each input is compared
+ *	                  all against all (the second vector is rotated one
+ *	                  lane at a time), which gives a mask of the elements
+ *	                  of the first block found in the second; the block
+ *	                  with the smaller last element is then replaced.
+ *	                  The matched (intersection) or unmatched (difference)
+ *	                  lanes are packed and stored as in Simd_Compact.h.
+ *	                  AVX2 and AVX-512F, picked at run time, with a
+ *	                  branchless scalar merge below them
+ *	  skewed sizes    galloping: every element of the smaller input is
+ *	                  looked up in the larger one with an exponential
+ *	                  search from the previous match, O(m lg(n / m))
+ *	                  instead of O(n + m); runs of the larger input
+ *	                  between the lookups are copied whole
+ *
+ *	The union is a branchless scalar merge, or galloping when skewed: it
+ *	selects every element, so there is nothing to pack.
+ *
+ *	Outputs are sized as for simd_copy_if: a std::vector output is sized
+ *	exactly after a counting pass (the union and the difference follow
+ *	from the size of the intersection), or by an upper bound in one pass.
+ *	The intersection of k sets starts from the two smallest and narrows
+ *	the result with each larger one, by then usually galloping.
+ *
+ *	The inputs must be strictly increasing; with duplicates the results
+ *	differ from the std:: algorithms, which keep multiplicities.
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Simd_Compact.h"
+#include "Simd_Reductions.h"
+#include "Sorted_View.h"
+
+
+namespace simd_set_detail {
+
+	// Galloping replaces the merge when one input is this many times larger than the other:
+	// the vector merge keeps up with it for longer than the scalar one, and so does the
+	// union, which copies every element either way
+	const std::size_t gallop_ratio_scalar = 8;
+	const std::size_t gallop_ratio_simd = 64;
+
+	inline bool skewed(std::size_t na, std::size_t nb, std::size_t ratio) {
+		return na / ratio > nb || nb / ratio > na;
+	}
+
+	// Width tags for the 4- and 8-byte kernels
+	template <std::size_t Bytes>
+	struct width {};
+
+
+	// Scalar kernels
+
+	// Merge of a and b writing the elements of a that are in b (Matched) or not in b (!Matched)
+	// Stores every element while out has room and advances by 0 or 1; no data-dependent branch
+	template <bool Matched, bool Store, class Int>
+	std::size_t merge_scalar(const Int * a, std::size_t na, const Int * b, std::size_t nb, Int * out, std::size_t capacity) {
+		std::size_t i = 0, j = 0, written = 0;
+		if (Store)
+			for (; i < na && j < nb && written < capacity;) {
+				const Int x = a[i], y = b[j];
+				out[written] = x;
+				written += Matched ? x == y : x < y;
+				i += x <= y;
+				j += y <= x;
+			}
+		for (; i < na && j < nb;) {
+			const Int x = a[i], y = b[j];
+			const bool selected = Matched ? x == y : x < y;
+			if (Store && selected)
+				out[written] = x;
+			written += selected;
+			i += x <= y;
+			j += y <= x;
+		}
+		if (!Matched) {
+			if (Store && i < na)
+				std::copy(a + i, a + na, out + written);
+			written += na - i;
+		}
+		return written;
+	}
+
+	template <class Int>
+	std::size_t union_scalar(const Int * a, std::size_t na, const Int * b, std::size_t nb, Int * out) {
+		std::size_t i = 0, j = 0, written = 0;
+		for (; i < na && j < nb; ++written) {
+			const Int x = a[i], y = b[j];
+			out[written] = x < y ? x : y;
+			i += x <= y;
+			j += y <= x;
+		}
+		std::copy(a + i, a + na, out + written);
+		written += na - i;
+		std::copy(b + j, b + nb, out + written);
+		return written + nb - j;
+	}
+
+	// First element of [first, last) not less than 'value': steps of 1, 2, 4, ... then a binary search
+	template <class Int>
+	const Int * gallop(const Int * first, const Int * last, Int value) {
+		const std::size_t n = std::size_t(last - first);
+		std::size_t low = 0, step = 1;
+		while (step <= n && first[step - 1] < value) {
+			low = step;
+			step *= 2;
+		}
+		return std::lower_bound(first + low, first + std::min(step, n), value);
+	}
+
+	// Elements of the small set found in the large one
+	template <bool Store, class Int>
+	std::size_t intersection_gallop(const Int * small, std::size_t ns, const Int * large, std::size_t nl, Int * out) {
+		const Int * at = large, * end = large + nl;
+		std::size_t written = 0;
+		for (std::size_t i = 0; i < ns && at != end; ++i) {
+			at = gallop(at, end, small[i]);
+			const bool found = at != end && *at == small[i];
+			if (Store && found)
+				out[written] = small[i];
+			written += found;
+		}
+		return written;
+	}
+
+	// a - b, a much smaller than b
+	template <class Int>
+	std::size_t difference_gallop_small(const Int * a, std::size_t na, const Int * b, std::size_t nb, Int * out) {
+		const Int * at = b, * end = b + nb;
+		std::size_t written = 0;
+		for (std::size_t i = 0; i < na; ++i) {
+			at = gallop(at, end, a[i]);
+			if (at == end || *at != a[i])
+				out[written++] = a[i];
+		}
+		return written;
+	}
+
+	// a - b, a much larger than b: the runs of a between the elements of b are copied whole
+	template <class Int>
+	std::size_t difference_gallop_large(const Int * a, std::size_t na, const Int * b, std::size_t nb, Int * out) {
+		const Int * at = a, * end = a + na;
+		std::size_t written = 0;
+		for (std::size_t j = 0; j < nb && at != end; ++j) {
+			const Int * next = gallop(at, end, b[j]);
+			std::copy(at, next, out + written);
+			written += std::size_t(next - at);
+			at = next + (next != end && *next == b[j]);
+		}
+		std::copy(at, end, out + written);
+		return written + std::size_t(end - at);
+	}
+
+	// small + large: runs of the large set copied whole, the elements of the small one in between
+	template <class Int>
+	std::size_t union_gallop(const Int * small, std::size_t ns, const Int * large, std::size_t nl, Int * out) {
+		const Int * at = large, * end = large + nl;
+		std::size_t written = 0;
+		for (std::size_t i = 0; i < ns; ++i) {
+			const Int * next = gallop(at, end, small[i]);
+			std::copy(at, next, out + written);
+			written += std::size_t(next - at);
+			at = next;
+			if (at == end || *at != small[i])
+				out[written++] = small[i];
+		}
+		std::copy(at, end, out + written);
+		return written + std::size_t(end - at);
+	}
+
+	// After the block loop: the elements of the block of a in progress that are not greater than
+	// b[j - 1] were compared with everything before b[j], and 'pending' has their matches.
+	// They are settled first; what is left of both inputs goes through the scalar merge
+	template <bool Matched, bool Store, class Int>
+	std::size_t finish_blocks(const Int * a, std::size_t na, const Int * b, std::size_t nb, std::size_t i, std::size_t j,
+				  unsigned pending, Int * out, std::size_t capacity) {
+		std::size_t written = 0;
+		if (j > 0)
+			for (unsigned lane = 0; i < na && a[i] <= b[j - 1]; ++i, ++lane)
+				if (((pending >> lane) & 1) == unsigned(Matched)) {
+					if (Store)
+						out[written] = a[i];
+					++written;
+				}
+		return written + merge_scalar<Matched, Store>(a + i, na - i, b + j, nb - j, Store ? out + written : out,
+							      capacity > written ? capacity - written : 0);
+	}
+
+
+#if SIMD_REDUCTIONS_X86
+
+	// AVX2: 8 lanes of 32 bits or 4 of 64 bits
+
+	// Bit l set if lane l of a equals any lane of b
+	SIMD_REDUCTIONS_TARGET("avx2")
+	inline unsigned match_avx2(__m256i a, __m256i b, width<4>) {
+		const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+		__m256i equal = _mm256_cmpeq_epi32(a, b);
+		for (int r = 1; r < 8; ++r) {
+			b = _mm256_permutevar8x32_epi32(b, rotate);
+			equal = _mm256_or_si256(equal, _mm256_cmpeq_epi32(a, b));
+		}
+		return (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(equal));
+	}
+
+	SIMD_REDUCTIONS_TARGET("avx2")
+	inline unsigned match_avx2(__m256i a, __m256i b, width<8>) {
+		__m256i equal = _mm256_cmpeq_epi64(a, b);
+		for (int r = 1; r < 4; ++r) {
+			b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(0, 3, 2, 1));
+			equal = _mm256_or_si256(equal, _mm256_cmpeq_epi64(a, b));
+		}
+		return (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(equal));
+	}
+
+	// Packs the lanes of 'mask' to the front and stores them at out, whole if 'room', masked otherwise
+	SIMD_REDUCTIONS_TARGET("avx2")
+	inline unsigned emit_avx2(void * out, __m256i x, unsigned mask, bool room, width<4>) {
+		const simd_compact_detail::compress_tables & tables = simd_compact_detail::compress_tables::get();
+		const __m256i shifts = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+		const __m256i lanes = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32((int)tables.float_lanes[mask]), shifts),
+						       _mm256_set1_epi32(15));
+		const __m256i packed = _mm256_permutevar8x32_epi32(x, lanes);
+		const unsigned count = tables.popcount[mask];
+		if (room)
+			_mm256_storeu_si256((__m256i *)out, packed);
+		else
+			_mm256_maskstore_epi32((int *)out, _mm256_loadu_si256((const __m256i *)(tables.prefix + 8 - count)), packed);
+		return count;
+	}
+
+	SIMD_REDUCTIONS_TARGET("avx2")
+	inline unsigned emit_avx2(void * out, __m256i x, unsigned mask, bool room, width<8>) {
+		const simd_compact_detail::compress_tables & tables = simd_compact_detail::compress_tables::get();
+		const __m256i shifts = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+		const __m256i lanes = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32((int)tables.double_lanes[mask]), shifts),
+						       _mm256_set1_epi32(15));
+		const __m256i packed = _mm256_permutevar8x32_epi32(x, lanes);
+		const unsigned count = tables.popcount[mask];
+		if (room)
+			_mm256_storeu_si256((__m256i *)out, packed);
+		else
+			_mm256_maskstore_epi64((long long *)out, _mm256_loadu_si256((const __m256i *)(tables.prefix + 8 - 2 * count)), packed);
+		return count;
+	}
+
+	// Both blocks advance when their last elements are equal; only the block of a that
+	// advances is settled. Branchless: a block that stays emits nothing
+	template <bool Matched, bool Store, class Int>
+	SIMD_REDUCTIONS_TARGET("avx2")
+	std::size_t merge_avx2(const Int * a, std::size_t na, const Int * b, std::size_t nb, Int * out, std::size_t capacity) {
+		const std::size_t lanes = 32 / sizeof(Int);
+		const unsigned all = (1u << lanes) - 1;
+		const simd_compact_detail::compress_tables & tables = simd_compact_detail::compress_tables::get();
+
+		std::size_t i = 0, j = 0, written = 0;
+		unsigned pending = 0;
+		while (i + lanes <= na && j + lanes <= nb) {
+			const __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+			pending |= match_avx2(x, _mm256_loadu_si256((const __m256i *)(b + j)), width<sizeof(Int)>());
+			const Int last_a = a[i + lanes - 1], last_b = b[j + lanes - 1];
+			const bool advance_a = last_a <= last_b, advance_b = last_b <= last_a;
+
+			const unsigned selected = advance_a ? (Matched ? pending : ~pending & all) : 0;
+			if (Store)
+				written += emit_avx2(out + written, x, selected, written + lanes <= capacity, width<sizeof(Int)>());
+			else
+				written += tables.popcount[selected];
+			pending = advance_a ? 0 : pending;
+			i += advance_a ? lanes : 0;
+			j += advance_b ? lanes : 0;
+		}
+		return written + finish_blocks<Matched, Store>(a, na, b, nb, i, j, pending, Store ? out + written : out,
+							       capacity > written ? capacity - written : 0);
+	}
+
+
+	// AVX-512F: 16 lanes of 32 bits or 8 of 64 bits, compress instruction
+
+	// GCC flags its own _mm512_undefined_epi32() in the alignr intrinsics
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+	SIMD_REDUCTIONS_TARGET("avx512f")
+	inline unsigned match_avx512(__m512i a, __m512i b, width<4>) {
+		__mmask16 equal = _mm512_cmpeq_epi32_mask(a, b);
+		for (int r = 1; r < 16; ++r) {
+			b = _mm512_alignr_epi32(b, b, 1);
+			equal = __mmask16(equal | _mm512_cmpeq_epi32_mask(a, b));
+		}
+		return equal;
+	}
+
+	SIMD_REDUCTIONS_TARGET("avx512f")
+	inline unsigned match_avx512(__m512i a, __m512i b, width<8>) {
+		__mmask8 equal = _mm512_cmpeq_epi64_mask(a, b);
+		for (int r = 1; r < 8; ++r) {
+			b = _mm512_alignr_epi64(b, b, 1);
+			equal = __mmask8(equal | _mm512_cmpeq_epi64_mask(a, b));
+		}
+		return equal;
+	}
+
+	// Packed and stored as in simd_compact_detail::compact_double_avx512
+	SIMD_REDUCTIONS_TARGET("avx512f")
+	inline void store_avx512(void * out, __m512i x, unsigned mask, unsigned count, bool room, width<4>) {
+		const __m512i packed = _mm512_maskz_compress_epi32(__mmask16(mask), x);
+		if (room)
+			_mm512_storeu_si512(out, packed);
+		else
+			_mm512_mask_storeu_epi32(out, __mmask16((1u << count) - 1), packed);
+	}
+
+	SIMD_REDUCTIONS_TARGET("avx512f")
+	inline void store_avx512(void * out, __m512i x, unsigned mask, unsigned count, bool room, width<8>) {
+		const __m512i packed = _mm512_maskz_compress_epi64(__mmask8(mask), x);
+		if (room)
+			_mm512_storeu_si512(out, packed);
+		else
+			_mm512_mask_storeu_epi64(out, __mmask8((1u << count) - 1), packed);
+	}
+
+	template <bool Matched, bool Store, class Int>
+	SIMD_REDUCTIONS_TARGET("avx512f")
+	std::size_t merge_avx512(const Int * a, std::size_t na, const Int * b, std::size_t nb, Int * out, std::size_t capacity) {
+		const std::size_t lanes = 64 / sizeof(Int);
+		const unsigned all = (1u << lanes) - 1;
+		const simd_compact_detail::compress_tables & tables = simd_compact_detail::compress_tables::get();
+
+		std::size_t i = 0, j = 0, written = 0;
+		unsigned pending = 0;
+		while (i + lanes <= na && j + lanes <= nb) {
+			const __m512i x = _mm512_loadu_si512(a + i);
+			pending |= match_avx512(x, _mm512_loadu_si512(b + j), width<sizeof(Int)>());
+			const Int last_a = a[i + lanes - 1], last_b = b[j + lanes - 1];
+			const bool advance_a = last_a <= last_b, advance_b = last_b <= last_a;
+
+			const unsigned selected = advance_a ? (Matched ? pending : ~pending & all) : 0;
+			const unsigned count = tables.popcount[selected & 255] + tables.popcount[selected >> 8];
+			if (Store)
+				store_avx512(out + written, x, selected, count, written + lanes <= capacity, width<sizeof(Int)>());
+			written += count;
+			pending = advance_a ? 0 : pending;
+			i += advance_a ? lanes : 0;
+			j += advance_b ? lanes : 0;
+		}
+		return written + finish_blocks<Matched, Store>(a, na, b, nb, i, j, pending, Store ? out + written : out,
+							       capacity > written ? capacity - written : 0);
+	}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif
+
+
+	// The entry points of the kernel table: galloping first when the sizes are skewed
+
+	template <class Int, std::size_t (*Merge)(const Int *, std::size_t, const Int *, std::size_t, Int *, std::size_t), std::size_t Ratio>
+	std::size_t intersection_size(const Int * a, std::size_t na, const Int * b, std::size_t nb) {
+		if (skewed(na, nb, Ratio))
+			return na < nb ? intersection_gallop<false>(a, na, b, nb, (Int *)nullptr)
+				       : intersection_gallop<false>(b, nb, a, na, (Int *)nullptr);
+		return Merge(a, na, b, nb, nullptr, 0);
+	}
+
+	template <class Int, std::size_t (*Merge)(const Int *, std::size_t, const Int *, std::size_t, Int *, std::size_t), std::size_t Ratio>
+	std::size_t intersection(const Int * a, std::size_t na, const Int * b, std::size_t nb, Int * out, std::size_t capacity) {
+		if (skewed(na, nb, Ratio))
+			return na < nb ? intersection_gallop<true>(a, na, b, nb, out) : intersection_gallop<true>(b, nb, a, na, out);
+		return Merge(a, na, b, nb, out, capacity);
+	}
+
+	template <class Int, std::size_t (*Merge)(const Int *, std::size_t, const Int *, std::size_t, Int *, std::size_t), std::size_t Ratio>
+	std::size_t difference(const Int * a, std::size_t na, const Int * b, std::size_t nb, Int * out, std::size_t capacity) {
+		if (skewed(na, nb, Ratio))
+			return na < nb ? difference_gallop_small(a, na, b, nb, out) : difference_gallop_large(a, na, b, nb, out);
+		return Merge(a, na, b, nb, out, capacity);
+	}
+
+	template <class Int>
+	std::size_t set_union(const Int * a, std::size_t na, const Int * b, std::size_t nb, Int * out) {
+		if (skewed(na, nb, gallop_ratio_simd))
+			return na < nb ? union_gallop(a, na, b, nb, out) : union_gallop(b, nb, a, na, out);
+		return union_scalar(a, na, b, nb, out);
+	}
+
+} // namespace simd_set_detail
+
+
+// One set of kernels, all for the same instruction set, for one integer type
+// intersection and difference write to out and return how many; out[0, max(capacity, returned count))
+// is all they write, with full-width stores only inside out[0, capacity)
+template <class Int>
+struct simd_set_kernels {
+
+	static_assert(std::is_integral<Int>::value && (sizeof(Int) == 4 || sizeof(Int) == 8),
+		      "simd_set_kernels needs 32- or 64-bit integers");
+
+	typedef std::size_t (*output_kernel)(const Int *, std::size_t, const Int *, std::size_t, Int *, std::size_t);
+
+	simd_level level;
+	std::size_t (*intersection_size)(const Int *, std::size_t, const Int *, std::size_t);
+	output_kernel intersection;
+	output_kernel difference;
+
+	// Kernels for 'level', or the best one supported below it (SSE2 runs the scalar kernels)
+	static simd_set_kernels for_level(simd_level level) {
+		using namespace simd_set_detail;
+		level = std::min(level, simd_reductions::best_level());
+#if SIMD_REDUCTIONS_X86
+		switch (level) {
+		case simd_level::avx512:
+			return { level, simd_set_detail::intersection_size<Int, merge_avx512<true, false, Int>, gallop_ratio_simd>,
+				 simd_set_detail::intersection<Int, merge_avx512<true, true, Int>, gallop_ratio_simd>,
+				 simd_set_detail::difference<Int, merge_avx512<false, true, Int>, gallop_ratio_simd> };
+		case simd_level::avx2:
+			return { level, simd_set_detail::intersection_size<Int, merge_avx2<true, false, Int>, gallop_ratio_simd>,
+				 simd_set_detail::intersection<Int, merge_avx2<true, true, Int>, gallop_ratio_simd>,
+				 simd_set_detail::difference<Int, merge_avx2<false, true, Int>, gallop_ratio_simd> };
+		default:
+			break;
+		}
+#endif
+		return { simd_level::scalar, simd_set_detail::intersection_size<Int, merge_scalar<true, false, Int>, gallop_ratio_scalar>,
+			 simd_set_detail::intersection<Int, merge_scalar<true, true, Int>, gallop_ratio_scalar>,
+			 simd_set_detail::difference<Int, merge_scalar<false, true, Int>, gallop_ratio_scalar> };
+	}
+
+	static const simd_set_kernels & best() {
+		static const simd_set_kernels kernels = for_level(simd_reductions::best_level());
+		return kernels;
+	}
+};
+
+
+// Dispatching entry points for strictly increasing ranges of 32- and 64-bit integers
+
+// Sizes of the results, O(n + m), or O(m lg(n / m)) when m is much smaller than n
+template <class Int>
+std::size_t simd_set_intersection_size(const Int * first1, const Int * last1, const Int * first2, const Int * last2) {
+	return simd_set_kernels<Int>::best().intersection_size(first1, std::size_t(last1 - first1), first2, std::size_t(last2 - first2));
+}
+
+template <class Int>
+std::size_t simd_set_union_size(const Int * first1, const Int * last1, const Int * first2, const Int * last2) {
+	return std::size_t(last1 - first1) + std::size_t(last2 - first2) - simd_set_intersection_size(first1, last1, first2, last2);
+}
+
+template <class Int>
+std::size_t simd_set_difference_size(const Int * first1, const Int * last1, const Int * first2, const Int * last2) {
+	return std::size_t(last1 - first1) - simd_set_intersection_size(first1, last1, first2, last2);
+}
+
+
+// std::set_intersection / set_union / set_difference into a buffer with room for the result
+// (see the _size functions), returns the end of the output
+// For intersection and difference, 'capacity' is the room at d_first, if known: the kernels
+// store whole blocks inside it, as simd_copy_if does. The default 0 writes only the result,
+// but every block then takes a masked store, and the scalar merge a branch per element
+template <class Int>
+Int * simd_set_intersection(const Int * first1, const Int * last1, const Int * first2, const Int * last2, Int * d_first,
+			    std::size_t capacity = 0) {
+	return d_first + simd_set_kernels<Int>::best().intersection(first1, std::size_t(last1 - first1),
+								       first2, std::size_t(last2 - first2), d_first, capacity);
+}
+
+template <class Int>
+Int * simd_set_union(const Int * first1, const Int * last1, const Int * first2, const Int * last2, Int * d_first) {
+	return d_first + simd_set_detail::set_union(first1, std::size_t(last1 - first1), first2, std::size_t(last2 - first2), d_first);
+}
+
+template <class Int>
+Int * simd_set_difference(const Int * first1, const Int * last1, const Int * first2, const Int * last2, Int * d_first,
+			  std::size_t capacity = 0) {
+	return d_first + simd_set_kernels<Int>::best().difference(first1, std::size_t(last1 - first1),
+								     first2, std::size_t(last2 - first2), d_first, capacity);
+}
+
+
+// Append the result to 'out', returns its size
+// counted: the size first, one exact allocation; upper_bound: room for the largest possible result, then shrink
+template <class Int>
+std::size_t simd_set_intersection(const Int * first1, const Int * last1, const Int * first2, const Int * last2, std::vector<Int> & out,
+				  output_sizing sizing = output_sizing::counted) {
+	const std::size_t na = std::size_t(last1 - first1), nb = std::size_t(last2 - first2), start = out.size();
+	const simd_set_kernels<Int> & kernels = simd_set_kernels<Int>::best();
+	const std::size_t room = sizing == output_sizing::counted ? kernels.intersection_size(first1, na, first2, nb) : std::min(na, nb);
+	if (room == 0)
+		return 0;
+	out.resize(start + room);
+	const std::size_t size = kernels.intersection(first1, na, first2, nb, &out[start], room);
+	out.resize(start + size);
+	return size;
+}
+
+template <class Int>
+std::size_t simd_set_union(const Int * first1, const Int * last1, const Int * first2, const Int * last2, std::vector<Int> & out,
+			   output_sizing sizing = output_sizing::counted) {
+	const std::size_t na = std::size_t(last1 - first1), nb = std::size_t(last2 - first2), start = out.size();
+	const std::size_t room = sizing == output_sizing::counted ? simd_set_union_size(first1, last1, first2, last2) : na + nb;
+	if (room == 0)
+		return 0;
+	out.resize(start + room);
+	const std::size_t size = simd_set_detail::set_union(first1, na, first2, nb, &out[start]);
+	out.resize(start + size);
+	return size;
+}
+
+template <class Int>
+std::size_t simd_set_difference(const Int * first1, const Int * last1, const Int * first2, const Int * last2, std::vector<Int> & out,
+				output_sizing sizing = output_sizing::counted) {
+	const std::size_t na = std::size_t(last1 - first1), nb = std::size_t(last2 - first2), start = out.size();
+	const simd_set_kernels<Int> & kernels = simd_set_kernels<Int>::best();
+	const std::size_t room = sizing == output_sizing::counted ? na - kernels.intersection_size(first1, na, first2, nb) : na;
+	if (room == 0)
+		return 0;
+	out.resize(start + room);
+	const std::size_t size = kernels.difference(first1, na, first2, nb, &out[start], room);
+	out.resize(start + size);
+	return size;
+}
+
+
+// Intersection of any number of sets, appended to 'out' (sized exactly), returns its size
+// Smallest first: every step narrows a result no larger than the smallest set, so the later
+// steps against large sets gallop; stops as soon as the result is empty
+template <class Int>
+std::size_t simd_set_intersection(std::vector<sorted_view<Int>> sets, std::vector<Int> & out) {
+	if (sets.empty())
+		return 0;
+	std::sort(sets.begin(), sets.end(), [](const sorted_view<Int> & x, const sorted_view<Int> & y) { return x.size() < y.size(); });
+	if (sets.size() == 1) {
+		out.insert(out.end(), sets[0].begin(), sets[0].end());
+		return sets[0].size();
+	}
+
+	// Every step but the last writes to one of two buffers, each as large as the smallest set
+	const simd_set_kernels<Int> & kernels = simd_set_kernels<Int>::best();
+	const std::size_t room = sets[0].size();
+	std::vector<Int> current, next;
+	const Int * first = sets[0].begin(), * last = sets[0].end();
+	for (std::size_t s = 1; s + 1 < sets.size() && first != last; ++s) {
+		next.resize(room);
+		const std::size_t size = kernels.intersection(first, std::size_t(last - first), sets[s].begin(), sets[s].size(), next.data(), room);
+		current.swap(next);
+		first = current.data();
+		last = first + size;
+	}
+	if (first == last)
+		return 0;
+	return simd_set_intersection(first, last, sets.back().begin(), sets.back().end(), out);
+}
+
+template <class Int>
+std::size_t simd_set_intersection(const std::vector<std::vector<Int>> & sets, std::vector<Int> & out) {
+	std::vector<sorted_view<Int>> views;
+	views.reserve(sets.size());
+	for (const std::vector<Int> & set : sets)
+		views.push_back(sorted_view<Int>(set));
+	return simd_set_intersection(std::move(views), out);
+}
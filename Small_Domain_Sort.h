@@ -0,0 +1,171 @@
+/*
+ *	Small-domain Sort
+ *
+ *	Histogram (counting) sort for integral data drawn from a small contiguous
+ *	domain [low, high], e.g. the 26 letters 'A'..'Z' of Problem 1
+ *
+ *	Sorting costs one counting pass plus one writing pass: O(n + k) time,
+ *	O(k) extra space per thread, where k = high - low + 1, and no comparisons.
+ *	Both increasing and decreasing outputs are written from the same histogram.
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <algorithm>
+#include <cstddef>
+#include <functional> // std::ref
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+template <class Integral>
+class small_domain_histogram {
+
+	static_assert(std::is_integral<Integral>::value, "small_domain_histogram needs an integral type");
+
+public:
+
+	// Inputs smaller than this per thread are counted on the calling thread only
+	static const std::size_t grain_size = std::size_t(1) << 16;
+
+	small_domain_histogram(Integral low, Integral high)
+		: low(low), counts(domain_size(low, high), 0) {}
+
+	// O(n / threads + threads * k)
+	// threads == 0 uses std::thread::hardware_concurrency()
+	// Throws std::out_of_range if any value lies outside [low, high], leaving the counts unchanged
+	void count(const Integral * first, const Integral * last, unsigned threads = 0) {
+
+		const std::size_t n = std::size_t(last - first);
+
+		if (threads == 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		threads = (unsigned)std::min<std::size_t>(threads, std::max<std::size_t>(1, n / grain_size));
+
+		// Every thread fills a private histogram, so no synchronization is needed
+		std::vector<std::vector<std::size_t>> partial(threads, std::vector<std::size_t>(counts.size() + 1, 0));
+		std::vector<std::thread> workers;
+
+		const std::size_t chunk = n / threads;
+		for (unsigned t = 1; t < threads; ++t) {
+			const Integral * chunk_first = first + t * chunk;
+			const Integral * chunk_last = (t + 1 == threads) ? last : chunk_first + chunk;
+			workers.emplace_back(&small_domain_histogram::count_chunk, this, chunk_first, chunk_last, std::ref(partial[t]));
+		}
+		count_chunk(first, threads == 1 ? last : first + chunk, partial[0]);
+
+		for (auto & worker : workers)
+			worker.join();
+
+		// The extra last bucket collects out-of-domain values; a rejected input leaves the counts unchanged
+		std::size_t rejected = 0;
+		for (const auto & local : partial)
+			rejected += local[counts.size()];
+		if (rejected != 0)
+			throw std::out_of_range("small_domain_histogram: value outside of the domain");
+
+		for (const auto & local : partial)
+			for (std::size_t b = 0; b < counts.size(); ++b)
+				counts[b] += local[b];
+	}
+
+	// Write all counted values in increasing order, O(n)
+	template <class OutputIt>
+	OutputIt write_increasing(OutputIt out) const {
+		for (std::size_t b = 0; b < counts.size(); ++b)
+			out = std::fill_n(out, counts[b], value_of(b));
+		return out;
+	}
+
+	// Write all counted values in decreasing order, O(n)
+	template <class OutputIt>
+	OutputIt write_decreasing(OutputIt out) const {
+		for (std::size_t b = counts.size(); b-- > 0; )
+			out = std::fill_n(out, counts[b], value_of(b));
+		return out;
+	}
+
+	// Number of occurrences of 'value'
+	std::size_t operator[](Integral value) const { return counts[bucket_of(value, low)]; }
+
+	// Total number of values counted
+	std::size_t size() const {
+		std::size_t total = 0;
+		for (std::size_t c : counts)
+			total += c;
+		return total;
+	}
+
+	void clear() { std::fill(counts.begin(), counts.end(), 0); }
+
+private:
+
+	static std::size_t domain_size(Integral low, Integral high) {
+		if (high < low)
+			throw std::invalid_argument("small_domain_histogram: empty domain");
+		return bucket_of(high, low) + 1;
+	}
+
+	static std::size_t bucket_of(Integral value, Integral low) {
+		typedef typename std::make_unsigned<Integral>::type Unsigned;
+		return std::size_t(Unsigned(Unsigned(value) - Unsigned(low)));
+	}
+
+	Integral value_of(std::size_t bucket) const { return Integral(low + Integral(bucket)); }
+
+	// Four interleaved sub-histograms break the store-to-load dependency
+	// between consecutive equal values, which are common in small domains
+	void count_chunk(const Integral * first, const Integral * last, std::vector<std::size_t> & local) const {
+
+		const std::size_t k = counts.size();
+		std::vector<std::size_t> sub(4 * (k + 1), 0);
+
+		// Values outside of the domain land in bucket k
+		auto bucket = [&](Integral value) { return std::min(bucket_of(value, low), k); };
+
+		for (; last - first >= 4; first += 4) {
+			++sub[0 * (k + 1) + bucket(first[0])];
+			++sub[1 * (k + 1) + bucket(first[1])];
+			++sub[2 * (k + 1) + bucket(first[2])];
+			++sub[3 * (k + 1) + bucket(first[3])];
+		}
+		for (; first != last; ++first)
+			++sub[bucket(*first)];
+
+		for (std::size_t b = 0; b <= k; ++b)
+			local[b] = sub[b] + sub[(k + 1) + b] + sub[2 * (k + 1) + b] + sub[3 * (k + 1) + b];
+	}
+
+	Integral low;
+	std::vector<std::size_t> counts;
+};
+
+
+// Sort a contiguous range in place in increasing order
+// O(n + k)
+template <class Integral>
+void counting_sort(std::vector<Integral> & values, Integral low, Integral high, unsigned threads = 0) {
+	small_domain_histogram<Integral> histogram(low, high);
+	histogram.count(values.data(), values.data() + values.size(), threads);
+	histogram.write_increasing(values.begin());
+}
+
+
+// Produce both increasing and decreasing copies of 'values' from a single counting pass
+// O(n + k)
+template <class Integral>
+void counting_sort_both(const std::vector<Integral> & values, Integral low, Integral high,
+			std::vector<Integral> & increasing, std::vector<Integral> & decreasing, unsigned threads = 0) {
+	small_domain_histogram<Integral> histogram(low, high);
+	histogram.count(values.data(), values.data() + values.size(), threads);
+
+	increasing.resize(values.size());
+	decreasing.resize(values.size());
+	histogram.write_increasing(increasing.begin());
+	histogram.write_decreasing(decreasing.begin());
+}
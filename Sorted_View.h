@@ -0,0 +1,75 @@
+/*
+ *	Sorted View
+ *
+ *	Non-owning, read-only view over a sorted contiguous buffer
+ *
+ *	Reading the data in increasing or decreasing order needs no copies:
+ *	ascending() walks the buffer forwards, descending() walks it backwards
+ *	with std::reverse_iterator. A vector is only built on request.
+ *
+ *	The view does not own the buffer: it must not outlive it, and it is
+ *	invalidated by anything that reallocates the underlying vector.
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+
+// A pair of iterators usable in range-based for loops and STL algorithms
+template <class Iterator>
+class iterator_range {
+public:
+	iterator_range(Iterator first, Iterator last) : first(first), last(last) {}
+
+	Iterator begin() const { return first; }
+	Iterator end() const { return last; }
+	std::size_t size() const { return std::size_t(std::distance(first, last)); }
+	bool empty() const { return first == last; }
+
+private:
+	Iterator first, last;
+};
+
+
+template <class Type>
+class sorted_view {
+public:
+
+	typedef Type value_type;
+	typedef const Type * iterator;
+	typedef std::reverse_iterator<iterator> reverse_iterator;
+
+	sorted_view() : first(nullptr), last(nullptr) {}
+	sorted_view(const Type * first, const Type * last) : first(first), last(last) {}
+	explicit sorted_view(const std::vector<Type> & sorted) : first(sorted.data()), last(sorted.data() + sorted.size()) {}
+
+	// O(1) access
+	iterator begin() const { return first; }
+	iterator end() const { return last; }
+	reverse_iterator rbegin() const { return reverse_iterator(last); }
+	reverse_iterator rend() const { return reverse_iterator(first); }
+
+	std::size_t size() const { return std::size_t(last - first); }
+	bool empty() const { return first == last; }
+
+	const Type & operator[](std::size_t i) const { return first[i]; }
+	const Type & front() const { return *first; }		// smallest
+	const Type & back() const { return *(last - 1); }	// largest
+
+	// Increasing and decreasing order, O(1), no copies
+	iterator_range<iterator> ascending() const { return iterator_range<iterator>(begin(), end()); }
+	iterator_range<reverse_iterator> descending() const { return iterator_range<reverse_iterator>(rbegin(), rend()); }
+
+	// Materialize only when an owning copy is really needed, O(n)
+	std::vector<Type> increasing_copy() const { return std::vector<Type>(begin(), end()); }
+	std::vector<Type> decreasing_copy() const { return std::vector<Type>(rbegin(), rend()); }
+
+private:
+	const Type * first;
+	const Type * last;
+};
@@ -0,0 +1,230 @@
+/*
+ *	Work-stealing Thread Pool
+ *
+ *	Every worker owns a deque of tasks. A worker pushes and pops its own
+ *	tasks at the back (most recent first, good cache locality) and, when
+ *	it runs dry, steals the oldest task from the front of another deque
+ *	(usually the largest piece of work left).
+ *
+ *	task_group tracks a set of tasks and lets the waiting thread execute
+ *	pending tasks instead of blocking, so nested parallelism (a task that
+ *	spawns and waits on more tasks) cannot deadlock the pool.
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+class work_stealing_pool {
+public:
+
+	// threads == 0 uses std::thread::hardware_concurrency()
+	explicit work_stealing_pool(unsigned threads = 0) : stopping(false), pending(0) {
+		if (threads == 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+
+		// One extra queue takes submissions from threads outside of the pool
+		for (unsigned i = 0; i <= threads; ++i)
+			queues.emplace_back(new task_queue);
+
+		for (unsigned i = 0; i < threads; ++i)
+			workers.emplace_back(&work_stealing_pool::worker_loop, this, i);
+	}
+
+	~work_stealing_pool() {
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (auto & worker : workers)
+			worker.join();
+	}
+
+	work_stealing_pool(const work_stealing_pool &) = delete;
+	work_stealing_pool & operator=(const work_stealing_pool &) = delete;
+
+	// Number of worker threads
+	unsigned size() const { return (unsigned)workers.size(); }
+
+	// Queue a task: on the calling worker's own deque, or on the shared one
+	void submit(std::function<void()> task) {
+		task_queue & queue = *queues[own_queue()];
+
+		// Counted before it becomes visible, so 'pending' never underflows
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+			++pending;
+		}
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.tasks.push_back(std::move(task));
+		}
+		wake.notify_one();
+	}
+
+	// Run one pending task on the calling thread, if there is any
+	// Returns false when every queue was empty
+	bool run_one() {
+		std::function<void()> task;
+		if (!pop_task(task))
+			return false;
+		task();
+		return true;
+	}
+
+	// Process-wide pool with one worker per hardware thread
+	static work_stealing_pool & shared() {
+		static work_stealing_pool pool;
+		return pool;
+	}
+
+private:
+
+	struct task_queue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	// Which pool and worker, if any, the current thread belongs to
+	struct worker_identity {
+		const work_stealing_pool * pool = nullptr;
+		std::size_t index = 0;
+	};
+
+	static worker_identity & this_worker() {
+		static thread_local worker_identity identity;
+		return identity;
+	}
+
+	std::size_t own_queue() const {
+		const worker_identity & identity = this_worker();
+		return identity.pool == this ? identity.index : workers.size();
+	}
+
+	bool pop_task(std::function<void()> & task) {
+		const std::size_t own = own_queue();
+
+		// Newest task from our own deque first
+		{
+			task_queue & queue = *queues[own];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.tasks.empty()) {
+				task = std::move(queue.tasks.back());
+				queue.tasks.pop_back();
+				--pending;
+				return true;
+			}
+		}
+
+		// Otherwise steal the oldest task of another deque
+		for (std::size_t offset = 1; offset < queues.size(); ++offset) {
+			task_queue & queue = *queues[(own + offset) % queues.size()];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.tasks.empty()) {
+				task = std::move(queue.tasks.front());
+				queue.tasks.pop_front();
+				--pending;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void worker_loop(std::size_t index) {
+		this_worker().pool = this;
+		this_worker().index = index;
+
+		for (;;) {
+			if (run_one())
+				continue;
+
+			std::unique_lock<std::mutex> lock(sleep_mutex);
+			wake.wait(lock, [this] { return stopping || pending > 0; });
+			if (stopping && pending == 0)
+				return;
+		}
+	}
+
+	std::vector<std::unique_ptr<task_queue>> queues;
+	std::vector<std::thread> workers;
+
+	std::mutex sleep_mutex;
+	std::condition_variable wake;
+	bool stopping;
+	std::atomic<std::size_t> pending;
+};
+
+
+// A set of tasks on a pool that can be waited on together
+// The first exception thrown by a task is rethrown by wait()
+class task_group {
+public:
+
+	explicit task_group(work_stealing_pool & pool) : pool(pool), state(std::make_shared<shared_state>()) {}
+
+	~task_group() {
+		// Never leave tasks referring to the caller's stack behind
+		try { wait(); }
+		catch (...) {}
+	}
+
+	task_group(const task_group &) = delete;
+	task_group & operator=(const task_group &) = delete;
+
+	void run(std::function<void()> task) {
+		++state->active;
+		std::shared_ptr<shared_state> tracked = state;
+
+		pool.submit([tracked, task] {
+			try {
+				task();
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(tracked->error_mutex);
+				if (!tracked->error)
+					tracked->error = std::current_exception();
+			}
+			--tracked->active;
+		});
+	}
+
+	// Help run pending tasks until every task of the group has finished
+	void wait() {
+		while (state->active > 0)
+			if (!pool.run_one())
+				std::this_thread::yield();
+
+		std::exception_ptr error;
+		{
+			std::lock_guard<std::mutex> lock(state->error_mutex);
+			std::swap(error, state->error);
+		}
+		if (error)
+			std::rethrow_exception(error);
+	}
+
+private:
+
+	struct shared_state {
+		std::atomic<std::size_t> active{ 0 };
+		std::mutex error_mutex;
+		std::exception_ptr error;
+	};
+
+	work_stealing_pool & pool;
+	std::shared_ptr<shared_state> state;
+};
@@ -0,0 +1,382 @@
+/*
+ *	Tick Loader
+ *
+ *	Memory-mapped loaders for daily price files
+ *
+ *	- CSV, one "time,price" record per line, e.g. "09:30AM,23.29" or
+ *	  "1514903400000000000,23.29". An optional header line is skipped.
+ *	  Chunks of the mapped file are parsed in parallel, straight into the
+ *	  columns of the series: one pass counts the records of every chunk,
+ *	  a prefix sum gives every chunk its output slot, a second pass parses.
+ *	  Numbers are parsed without allocation; only unusual forms
+ *	  (exponents, more than 19 digits) go through std::strtod.
+ *
+ *	- Packed binary tick file, columnar so it can be used in place:
+ *
+ *		offset 0		char[8]		magic "TICKS01"
+ *		offset 8		uint64		record count n
+ *		offset 16		int64[n]	timestamps, nanoseconds since the epoch
+ *		offset 16 + 8n		double[n]	prices
+ *
+ *	  tick_file maps it and exposes a tick_series_view over the mapping:
+ *	  no parsing and no copies. Native byte order.
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Price_Series.h"
+
+
+// Read-only memory mapping of a whole file
+class mapped_file {
+public:
+
+	// Throws std::runtime_error if the file cannot be opened or mapped
+	explicit mapped_file(const std::string & path) : bytes(nullptr), length(0) {
+#if defined(_WIN32)
+		file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			throw std::runtime_error("mapped_file: cannot open " + path);
+
+		LARGE_INTEGER file_size;
+		GetFileSizeEx(file, &file_size);
+		length = std::size_t(file_size.QuadPart);
+
+		mapping = nullptr;
+		if (length != 0) {
+			mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping != nullptr)
+				bytes = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			if (bytes == nullptr) {
+				if (mapping != nullptr)
+					CloseHandle(mapping);
+				CloseHandle(file);
+				throw std::runtime_error("mapped_file: cannot map " + path);
+			}
+		}
+#else
+		descriptor = ::open(path.c_str(), O_RDONLY);
+		if (descriptor < 0)
+			throw std::runtime_error("mapped_file: cannot open " + path);
+
+		struct stat status;
+		if (::fstat(descriptor, &status) != 0) {
+			::close(descriptor);
+			throw std::runtime_error("mapped_file: cannot stat " + path);
+		}
+		length = std::size_t(status.st_size);
+
+		if (length != 0) {
+			void * address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+			if (address == MAP_FAILED) {
+				::close(descriptor);
+				throw std::runtime_error("mapped_file: cannot map " + path);
+			}
+			bytes = static_cast<const char *>(address);
+
+			// The whole file is read front to back
+			::madvise(address, length, MADV_SEQUENTIAL);
+		}
+#endif
+	}
+
+	~mapped_file() {
+#if defined(_WIN32)
+		if (bytes != nullptr) {
+			UnmapViewOfFile(bytes);
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+#else
+		if (bytes != nullptr)
+			::munmap(const_cast<char *>(bytes), length);
+		::close(descriptor);
+#endif
+	}
+
+	mapped_file(const mapped_file &) = delete;
+	mapped_file & operator=(const mapped_file &) = delete;
+
+	const char * data() const { return bytes; }
+	std::size_t size() const { return length; }
+
+private:
+	const char * bytes;
+	std::size_t length;
+#if defined(_WIN32)
+	HANDLE file;
+	HANDLE mapping;
+#else
+	int descriptor;
+#endif
+};
+
+
+// Parse a decimal number in [first, last) without allocating
+// Up to 19 digits and |exponent| <= 22 take the exact fast path:
+// one integer mantissa and one multiplication or division by an exact power of ten,
+// which rounds correctly whenever the mantissa fits 53 bits (Clinger's fast path)
+// Leading blanks are skipped, so "time, price" records parse too
+// Returns false if the text is not a number
+inline bool parse_decimal(const char * first, const char * last, double & value) {
+
+	static const double powers_of_ten[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	while (first != last && (*first == ' ' || *first == '\t'))
+		++first;
+
+	const char * p = first;
+	const bool negative = (p != last && *p == '-');
+	if (p != last && (*p == '-' || *p == '+'))
+		++p;
+
+	// Integer and fraction digits go into one mantissa; more than 19 digits take the slow path
+	std::uint64_t mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+
+	p = parse_digits(p, last, mantissa, digits);
+	const int integer_digits = digits;
+
+	if (p != last && *p == '.') {
+		const char * fraction = p + 1;
+		p = parse_digits(fraction, last, mantissa, digits);
+		exponent = -(digits - integer_digits);
+	}
+
+	const bool any_digit = digits > 0;
+	const bool overflow = (digits == 19 && p != last && *p >= '0' && *p <= '9');
+
+	if (!any_digit)
+		return false;
+
+	if (p == last && !overflow && mantissa < (std::uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+		const double magnitude = (exponent < 0) ? double(mantissa) / powers_of_ten[-exponent]
+							: double(mantissa) * powers_of_ten[exponent];
+		value = negative ? -magnitude : magnitude;
+		return true;
+	}
+
+	// Slow path: exponents, long mantissas
+	// strtod alone would also take hex floats, "inf", "nan" and blanks: plain decimals only
+	for (const char * c = first; c != last; ++c)
+		if (!((*c >= '0' && *c <= '9') || *c == '.' || *c == 'e' || *c == 'E' || *c == '+' || *c == '-'))
+			return false;
+
+	char buffer[64];
+	const std::size_t length = std::size_t(last - first);
+	if (length >= sizeof(buffer))
+		return false;
+	std::memcpy(buffer, first, length);
+	buffer[length] = '\0';
+
+	char * end = nullptr;
+	value = std::strtod(buffer, &end);
+	return end == buffer + length;
+}
+
+
+namespace tick_loader_detail {
+
+	// Calls record(line_first, line_last) for every non-empty line of [first, last)
+	// Trailing '\r' is stripped, so files with Windows line endings load as well
+	template <class Function>
+	void for_each_line(const char * first, const char * last, Function record) {
+		while (first < last) {
+			const char * newline = static_cast<const char *>(std::memchr(first, '\n', std::size_t(last - first)));
+			const char * line_last = newline ? newline : last;
+			const char * trimmed = line_last;
+			while (trimmed != first && (trimmed[-1] == '\r' || trimmed[-1] == ' '))
+				--trimmed;
+			if (trimmed != first)
+				record(first, trimmed);
+			first = newline ? newline + 1 : last;
+		}
+	}
+
+	// Start of the first line at or after 'position'
+	inline const char * next_line(const char * first, const char * position, const char * last) {
+		if (position == first)
+			return first;
+		const char * newline = static_cast<const char *>(std::memchr(position - 1, '\n', std::size_t(last - (position - 1))));
+		return newline ? newline + 1 : last;
+	}
+}
+
+
+// Load a "time,price" CSV file into a columnar series
+// O(n / threads); threads == 0 uses std::thread::hardware_concurrency()
+// Throws std::runtime_error on I/O errors and malformed records,
+// or whatever Time::parse throws for a malformed time (std::invalid_argument)
+template <class Series>
+Series load_csv(const std::string & path, unsigned threads = 0) {
+
+	typedef typename Series::time_type Time;
+	typedef typename Series::price_type Price;
+
+	mapped_file file(path);
+	const char * first = file.data();
+	const char * last = file.data() + file.size();
+
+	// Skip a header line such as "time,price"
+	if (first != last && !(*first >= '0' && *first <= '9') && *first != '-' && *first != '+')
+		first = tick_loader_detail::next_line(first, first + 1, last);
+
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+
+	// Small files are not worth a thread: about 1 MiB per chunk at least
+	const std::size_t min_chunk = std::size_t(1) << 20;
+	threads = (unsigned)std::min<std::size_t>(threads, std::max<std::size_t>(1, std::size_t(last - first) / min_chunk));
+
+	// Chunk boundaries, moved forward to line starts
+	std::vector<const char *> bounds(threads + 1);
+	for (unsigned t = 0; t <= threads; ++t)
+		bounds[t] = tick_loader_detail::next_line(first, first + std::size_t(last - first) * t / threads, last);
+
+	std::vector<std::size_t> offsets(threads + 1, 0);
+	std::vector<std::exception_ptr> errors(threads);
+
+	auto run_parallel = [&](std::function<void(unsigned)> work) {
+		std::vector<std::thread> workers;
+		for (unsigned t = 1; t < threads; ++t)
+			workers.emplace_back([&, t] {
+				try { work(t); }
+				catch (...) { errors[t] = std::current_exception(); }
+			});
+		try { work(0); }
+		catch (...) { errors[0] = std::current_exception(); }
+
+		for (auto & worker : workers)
+			worker.join();
+		for (auto & error : errors)
+			if (error)
+				std::rethrow_exception(error);
+	};
+
+	// 1. Count the records of every chunk
+	run_parallel([&](unsigned t) {
+		std::size_t count = 0;
+		tick_loader_detail::for_each_line(bounds[t], bounds[t + 1], [&](const char *, const char *) { ++count; });
+		offsets[t + 1] = count;
+	});
+
+	// 2. Prefix sum: every chunk owns the slots [offsets[t], offsets[t + 1])
+	for (unsigned t = 0; t < threads; ++t)
+		offsets[t + 1] += offsets[t];
+
+	Series series;
+	series.resize(offsets[threads]);
+	Time * times = series.time_data();
+	Price * prices = series.price_data();
+
+	// 3. Parse every chunk straight into its slots
+	run_parallel([&](unsigned t) {
+		std::size_t slot = offsets[t];
+		tick_loader_detail::for_each_line(bounds[t], bounds[t + 1], [&](const char * line_first, const char * line_last) {
+			const char * comma = static_cast<const char *>(std::memchr(line_first, ',', std::size_t(line_last - line_first)));
+			double price = 0.0;
+			if (comma == nullptr || !parse_decimal(comma + 1, line_last, price))
+				throw std::runtime_error("load_csv: malformed record '" + std::string(line_first, line_last) + "'");
+
+			times[slot] = Time::parse(line_first, comma);
+			prices[slot] = Price(price);
+			++slot;
+		});
+	});
+
+	return series;
+}
+
+
+// Memory-mapped binary tick file, read in place
+class tick_file {
+public:
+
+	// Throws std::runtime_error if the file is missing, truncated or not a tick file
+	explicit tick_file(const std::string & path) : file(path) {
+		if (file.size() < header_size || std::memcmp(file.data(), magic(), magic_size) != 0)
+			throw std::runtime_error("tick_file: not a tick file: " + path);
+
+		std::uint64_t count = 0;
+		std::memcpy(&count, file.data() + magic_size, sizeof(count));
+		// Divide rather than multiply: a corrupt count must not wrap header_size + count * record_size
+		const std::size_t record_size = sizeof(std::int64_t) + sizeof(double);
+		const std::size_t payload = file.size() - header_size;
+		if (count > payload / record_size || payload != std::size_t(count) * record_size)
+			throw std::runtime_error("tick_file: truncated tick file: " + path);
+
+		n = std::size_t(count);
+	}
+
+	// O(1): both columns point into the mapping
+	tick_series_view view() const {
+		const char * columns = file.data() + header_size;
+		return tick_series_view(reinterpret_cast<const epoch_nanos *>(columns),
+					reinterpret_cast<const double *>(columns + n * sizeof(std::int64_t)), n);
+	}
+
+	std::size_t size() const { return n; }
+
+	// Write a series in the tick file format
+	template <class SeriesView>
+	static void write(const std::string & path, const SeriesView & series) {
+		std::ofstream out(path, std::ios::binary);
+		if (!out)
+			throw std::runtime_error("tick_file: cannot create " + path);
+
+		const std::uint64_t count = series.size();
+		out.write(magic(), magic_size);
+		out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+		for (std::size_t i = 0; i < series.size(); ++i) {
+			const std::int64_t nanos = series.time(i).nanos;
+			out.write(reinterpret_cast<const char *>(&nanos), sizeof(nanos));
+		}
+		out.write(reinterpret_cast<const char *>(series.price_begin()), std::streamsize(series.size() * sizeof(double)));
+
+		if (!out)
+			throw std::runtime_error("tick_file: cannot write " + path);
+	}
+
+private:
+
+	static const std::size_t header_size = 16;
+	static const std::size_t magic_size = 8;
+
+	static const char * magic() { return "TICKS01"; }	// 7 characters and the terminating '\0'
+
+	static_assert(sizeof(epoch_nanos) == sizeof(std::int64_t), "epoch_nanos must map onto int64 timestamps");
+
+	mapped_file file;
+	std::size_t n;
+};
@@ -0,0 +1,177 @@
+/*
+ *	Top-k Selection
+ *
+ *	Streaming selection of the k highest (or, with std::greater, the k
+ *	lowest) prices together with their timestamps
+ *
+ *	The selector keeps the k best entries seen so far in a heap whose root
+ *	is the weakest of them. A new value that does not beat the root costs
+ *	one comparison; on random input only O(k lg(n / k)) of the n values
+ *	ever enter the heap. The input is only read, never reordered or copied.
+ *
+ *	Equal values are ranked by time, earlier first, so the result does not
+ *	depend on how the input was split: selectors of separate shards merge
+ *	into exactly the result of one selector over the whole series.
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "Thread_Pool.h"
+
+
+// A selected value and the time (or index) it was recorded at
+template <class Value, class Time>
+struct top_k_entry {
+	Value value;
+	Time time;
+};
+
+
+// Keeps the k entries ranking first under 'comp': the largest values for std::less
+// Time needs operator<, for the ties
+template <class Value, class Time = std::size_t, class Compare = std::less<Value>>
+class top_k_selector {
+public:
+
+	typedef top_k_entry<Value, Time> entry;
+
+	// k may be chosen at run time; k == 0 selects nothing
+	explicit top_k_selector(std::size_t k, Compare comp = Compare()) : k(k), comp(comp) {
+		heap.reserve(k);
+	}
+
+	// O(1) when 'value' does not make the cut, O(lg k) otherwise
+	void push(const Value & value, const Time & time) {
+		const entry candidate = { value, time };
+		if (heap.size() < k) {
+			heap.push_back(candidate);
+			std::push_heap(heap.begin(), heap.end(), ranks_before());
+			return;
+		}
+
+		// Fast rejection against the weakest entry kept: a worse value, or an equal one recorded later
+		if (k == 0 || comp(value, heap.front().value))
+			return;
+		if (!comp(heap.front().value, value) && !(time < heap.front().time))
+			return;
+
+		std::pop_heap(heap.begin(), heap.end(), ranks_before());
+		heap.back() = candidate;
+		std::push_heap(heap.begin(), heap.end(), ranks_before());
+	}
+
+	void operator()(const Value & value, const Time & time) { push(value, time); }
+
+	// Absorb the selection of another shard
+	// O(k lg k)
+	void merge(const top_k_selector & other) {
+		for (const entry & item : other.heap)
+			push(item.value, item.time);
+	}
+
+	// The selection, best first
+	// O(k lg k), the selector is left unchanged
+	std::vector<entry> sorted() const {
+		std::vector<entry> result(heap);
+		std::sort_heap(result.begin(), result.end(), ranks_before());
+		return result;
+	}
+
+	// Number of entries held, min(k, values pushed)
+	std::size_t size() const { return heap.size(); }
+	bool empty() const { return heap.empty(); }
+	std::size_t capacity() const { return k; }
+
+	void clear() { heap.clear(); }
+
+private:
+
+	// a ranks before b: a better value, or an equal value recorded earlier
+	// Used as the heap order, so the root is the entry ranked last
+	struct ranks_before_t {
+		Compare comp;
+		bool operator()(const entry & a, const entry & b) const {
+			if (comp(b.value, a.value))
+				return true;
+			if (comp(a.value, b.value))
+				return false;
+			return a.time < b.time;
+		}
+	};
+	ranks_before_t ranks_before() const { return ranks_before_t{ comp }; }
+
+	std::size_t k;
+	Compare comp;
+	std::vector<entry> heap;
+};
+
+
+// Shards below this many prices are not worth a task
+const std::size_t top_k_grain = std::size_t(1) << 16;
+
+
+// The k highest prices of a series, highest first, with their times
+// Series is anything with size(), time(i) and price(i): basic_price_series, price_series_view
+// O(n + k lg k lg(n / k)) expected, the series is not modified
+template <class Series, class Compare = std::less<typename Series::price_type>>
+std::vector<top_k_entry<typename Series::price_type, typename Series::time_type>>
+top_k(const Series & series, std::size_t k, Compare comp = Compare()) {
+	top_k_selector<typename Series::price_type, typename Series::time_type, Compare> selector(k, comp);
+	for (std::size_t i = 0; i < series.size(); ++i)
+		selector.push(series.price(i), series.time(i));
+	return selector.sorted();
+}
+
+// The k lowest prices, lowest first
+template <class Series>
+std::vector<top_k_entry<typename Series::price_type, typename Series::time_type>>
+bottom_k(const Series & series, std::size_t k) {
+	return top_k(series, k, std::greater<typename Series::price_type>());
+}
+
+// The k highest values of a plain array, with their indices
+template <class Value, class Compare = std::less<Value>>
+std::vector<top_k_entry<Value, std::size_t>> top_k(const Value * first, const Value * last, std::size_t k, Compare comp = Compare()) {
+	top_k_selector<Value, std::size_t, Compare> selector(k, comp);
+	for (const Value * p = first; p != last; ++p)
+		selector.push(*p, std::size_t(p - first));
+	return selector.sorted();
+}
+
+
+// top_k with one selector per shard on the pool, merged at the end
+// Returns exactly what top_k returns
+template <class Series, class Compare = std::less<typename Series::price_type>>
+std::vector<top_k_entry<typename Series::price_type, typename Series::time_type>>
+parallel_top_k(const Series & series, std::size_t k, Compare comp = Compare(),
+	       work_stealing_pool & pool = work_stealing_pool::shared()) {
+
+	typedef top_k_selector<typename Series::price_type, typename Series::time_type, Compare> selector_type;
+
+	const std::size_t n = series.size();
+	const std::size_t shards = std::min<std::size_t>(pool.size(), n / top_k_grain);
+	if (shards <= 1)
+		return top_k(series, k, comp);
+
+	std::vector<selector_type> selectors(shards, selector_type(k, comp));
+	{
+		task_group group(pool);
+		for (std::size_t s = 0; s < shards; ++s)
+			group.run([&, s] {
+				for (std::size_t i = n * s / shards; i < n * (s + 1) / shards; ++i)
+					selectors[s].push(series.price(i), series.time(i));
+			});
+		group.wait();
+	}
+
+	for (std::size_t s = 1; s < shards; ++s)
+		selectors[0].merge(selectors[s]);
+	return selectors[0].sorted();
+}
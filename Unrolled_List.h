@@ -0,0 +1,606 @@
+/*
+ *	Unrolled List
+ *
+ *	A replacement for std::list that keeps its elements in blocks of 64
+ *	contiguous slots, so walking it reads consecutive memory instead of
+ *	chasing one pointer per element.
+ *
+ *	Elements never move once constructed: iterators, pointers and
+ *	references stay valid until their element is erased, as with std::list.
+ *	The order is kept as runs: a run is a range of consecutive slots of one
+ *	block holding consecutive elements of the list. Bitmasks in the block
+ *	mark the used slots and the first and last slot of every run, and only
+ *	the last slot of a run links to the next run. Stepping to the next
+ *	element is slot + 1 until the run ends.
+ *
+ *	Inserting before an element takes the free slot after the previous run
+ *	or before the run of the element, and only otherwise starts a one-slot
+ *	run in a block with free slots. Erasing shrinks a run at its ends and
+ *	splits it in the middle; an insert into the freed slot joins the two
+ *	again. All of these are O(1), as are push_back, push_front and splicing
+ *	inside one list or a whole list into another.
+ *
+ *	A list built by push_back (or from a range) is one run per block. Many
+ *	inserts at scattered places cut it into short runs, and a walk then
+ *	follows a link every few elements, as with std::list: the link sits
+ *	next to the value, so that costs one cache line per run.
+ *
+ */
+
+#pragma once
+
+// Include Standard Library headers
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Bit_Ops.h"
+
+
+namespace unrolled_list_detail {
+
+	const unsigned block_slots = 64;
+
+	inline std::uint64_t bit(unsigned slot) { return std::uint64_t(1) << slot; }
+
+	// A link names a slot of another run: the address of its block, aligned to 64 bytes,
+	// with the slot in the low bits; 'no_link' is the start or the end of the list
+	const std::uintptr_t no_link = 1;
+	const std::size_t block_alignment = 64;
+
+	template <class T>
+	struct slot {
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type value;
+		std::uintptr_t next;	// at the last slot of a run, the first slot of the next run; 0 elsewhere
+	};
+
+	// The value and the link share a slot, so that following a link reads one cache line,
+	// as a std::list node does, while walking a run reads consecutive slots
+	template <class T>
+	struct block {
+		std::uint64_t live;	// slots holding an element
+		std::uint64_t starts;	// first slot of every run
+		std::uint64_t ends;	// last slot of every run
+		block * older, * newer;	// every block of the list, for clear()
+		void * allocation;	// as returned by operator new, before alignment
+
+		std::uintptr_t prev[block_slots];	// at the first slot of a run, the last slot of the previous run
+		slot<T> slots[block_slots];
+
+		T * value(unsigned at) { return reinterpret_cast<T *>(&slots[at].value); }
+
+		static std::uintptr_t link(block * to, unsigned at) { return to ? reinterpret_cast<std::uintptr_t>(to) | at : no_link; }
+		static block * link_block(std::uintptr_t link) {
+			return link == no_link ? nullptr : reinterpret_cast<block *>(link & ~std::uintptr_t(block_alignment - 1));
+		}
+		static unsigned link_slot(std::uintptr_t link) { return link == no_link ? 0 : unsigned(link & (block_alignment - 1)); }
+	};
+
+}
+
+
+template <class T>
+class unrolled_list {
+
+	typedef unrolled_list_detail::block<T> block;
+
+public:
+
+	typedef T value_type;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef T & reference;
+	typedef const T & const_reference;
+	typedef T * pointer;
+	typedef const T * const_pointer;
+
+	template <bool Const>
+	class basic_iterator {
+	public:
+
+		typedef std::bidirectional_iterator_tag iterator_category;
+		typedef T value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef typename std::conditional<Const, const T *, T *>::type pointer;
+		typedef typename std::conditional<Const, const T &, T &>::type reference;
+
+		basic_iterator() : at(nullptr), slot(0), list(nullptr) {}
+
+		// iterator -> const_iterator
+		template <bool Other, class = typename std::enable_if<Const && !Other>::type>
+		basic_iterator(const basic_iterator<Other> & other) : at(other.at), slot(other.slot), list(other.list) {}
+
+		reference operator*() const { return *at->value(slot); }
+		pointer operator->() const { return at->value(slot); }
+
+		// The next slot of the run, or the first slot of the next run
+		basic_iterator & operator++() {
+			const std::uintptr_t next = at->slots[slot].next;
+			if (!next)
+				++slot;
+			else {
+				at = block::link_block(next);
+				slot = block::link_slot(next);
+			}
+			return *this;
+		}
+
+		// From end(), the last element of the list
+		basic_iterator & operator--() {
+			using namespace unrolled_list_detail;
+			if (!at) {
+				at = list->last_block;
+				slot = list->last_slot;
+				return *this;
+			}
+			if (at->starts & bit(slot)) {
+				const std::uintptr_t previous = at->prev[slot];
+				at = block::link_block(previous);
+				slot = block::link_slot(previous);
+			}
+			else
+				--slot;
+			return *this;
+		}
+
+		basic_iterator operator++(int) { basic_iterator old = *this; ++*this; return old; }
+		basic_iterator operator--(int) { basic_iterator old = *this; --*this; return old; }
+
+		friend bool operator==(const basic_iterator & a, const basic_iterator & b) { return a.at == b.at && a.slot == b.slot; }
+		friend bool operator!=(const basic_iterator & a, const basic_iterator & b) { return !(a == b); }
+
+	private:
+		friend class unrolled_list;
+		template <bool> friend class basic_iterator;
+
+		basic_iterator(block * at, unsigned slot, const unrolled_list * list) : at(at), slot(slot), list(list) {}
+
+		block * at;			// null for end()
+		unsigned slot;
+		const unrolled_list * list;	// only for --end()
+	};
+
+	typedef basic_iterator<false> iterator;
+	typedef basic_iterator<true> const_iterator;
+	typedef std::reverse_iterator<iterator> reverse_iterator;
+	typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+
+	unrolled_list() { reset(); }
+
+	unrolled_list(size_type n, const T & value) {
+		reset();
+		try {
+			for (size_type i = 0; i < n; ++i)
+				push_back(value);
+		}
+		catch (...) {
+			clear();
+			throw;
+		}
+	}
+
+	template <class InputIterator, class = typename std::enable_if<!std::is_integral<InputIterator>::value>::type>
+	unrolled_list(InputIterator first, InputIterator last) {
+		reset();
+		try {
+			for (; first != last; ++first)
+				emplace_back(*first);
+		}
+		catch (...) {
+			clear();
+			throw;
+		}
+	}
+
+	unrolled_list(std::initializer_list<T> values) : unrolled_list(values.begin(), values.end()) {}
+
+	unrolled_list(const unrolled_list & other) : unrolled_list(other.begin(), other.end()) {}
+
+	unrolled_list(unrolled_list && other) {
+		reset();
+		swap(other);
+	}
+
+	~unrolled_list() { clear(); }
+
+	unrolled_list & operator=(const unrolled_list & other) {
+		if (this != &other) {
+			unrolled_list copy(other);
+			swap(copy);
+		}
+		return *this;
+	}
+
+	unrolled_list & operator=(unrolled_list && other) {
+		if (this != &other) {
+			clear();
+			swap(other);
+		}
+		return *this;
+	}
+
+	unrolled_list & operator=(std::initializer_list<T> values) {
+		unrolled_list copy(values);
+		swap(copy);
+		return *this;
+	}
+
+	// end() is not swapped; every other iterator follows its element
+	void swap(unrolled_list & other) {
+		std::swap(first_block, other.first_block);
+		std::swap(first_slot, other.first_slot);
+		std::swap(last_block, other.last_block);
+		std::swap(last_slot, other.last_slot);
+		std::swap(newest, other.newest);
+		std::swap(oldest, other.oldest);
+		std::swap(spare, other.spare);
+		std::swap(count, other.count);
+	}
+
+
+	iterator begin() { return iterator(first_block, first_slot, this); }
+	const_iterator begin() const { return const_iterator(first_block, first_slot, this); }
+	const_iterator cbegin() const { return begin(); }
+	iterator end() { return iterator(nullptr, 0, this); }
+	const_iterator end() const { return const_iterator(nullptr, 0, this); }
+	const_iterator cend() const { return end(); }
+
+	reverse_iterator rbegin() { return reverse_iterator(end()); }
+	const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+	const_reverse_iterator crbegin() const { return rbegin(); }
+	reverse_iterator rend() { return reverse_iterator(begin()); }
+	const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+	const_reverse_iterator crend() const { return rend(); }
+
+	bool empty() const { return count == 0; }
+	size_type size() const { return count; }
+
+	T & front() { return *first_block->value(first_slot); }
+	const T & front() const { return *first_block->value(first_slot); }
+	T & back() { return *last_block->value(last_slot); }
+	const T & back() const { return *last_block->value(last_slot); }
+
+
+	// O(1)
+	template <class... Args>
+	iterator emplace(const_iterator position, Args &&... args) {
+		unsigned slot;
+		block * at = reserve_before(position.at, position.slot, slot);
+		try {
+			::new (static_cast<void *>(at->value(slot))) T(std::forward<Args>(args)...);
+		}
+		catch (...) {
+			release(at, slot);
+			throw;
+		}
+		++count;
+		return iterator(at, slot, this);
+	}
+
+	iterator insert(const_iterator position, const T & value) { return emplace(position, value); }
+	iterator insert(const_iterator position, T && value) { return emplace(position, std::move(value)); }
+
+	template <class... Args>
+	void emplace_back(Args &&... args) { emplace(end(), std::forward<Args>(args)...); }
+	template <class... Args>
+	void emplace_front(Args &&... args) { emplace(begin(), std::forward<Args>(args)...); }
+
+	void push_back(const T & value) { emplace(end(), value); }
+	void push_back(T && value) { emplace(end(), std::move(value)); }
+	void push_front(const T & value) { emplace(begin(), value); }
+	void push_front(T && value) { emplace(begin(), std::move(value)); }
+
+	// O(1); returns the element after the erased one
+	iterator erase(const_iterator position) {
+		const_iterator next = position;
+		++next;
+		position->~T();
+		release(position.at, position.slot);
+		--count;
+		return iterator(next.at, next.slot, this);
+	}
+
+	iterator erase(const_iterator first, const_iterator last) {
+		while (first != last)
+			first = erase(first);
+		return iterator(last.at, last.slot, this);
+	}
+
+	void pop_back() { erase(--end()); }
+	void pop_front() { erase(begin()); }
+
+	// O(number of blocks + size)
+	void clear() {
+		while (newest) {
+			block * older = newest->older;
+			for (std::uint64_t live = newest->live; live; live &= live - 1)
+				newest->value(bit_ops::lowest_bit(live))->~T();
+			::operator delete(newest->allocation);
+			newest = older;
+		}
+		reset();
+	}
+
+
+	// Move [first, last) of this list before 'position', which is not in the range
+	// O(1); every iterator stays valid
+	void splice(const_iterator position, unrolled_list & other, const_iterator first, const_iterator last) {
+		if (&other != this) {
+			for (; first != last; first = other.erase(first))
+				emplace(position, std::move(const_cast<T &>(*first)));
+			return;
+		}
+		if (first == last || position == first || position == last)
+			return;
+
+		// Cut runs so that 'first', 'last' and 'position' each begin one
+		split_before(first.at, first.slot);
+		split_before(last.at, last.slot);
+		split_before(position.at, position.slot);
+
+		// The range runs from the run starting at 'first' to the run before 'last'
+		block * range_end_block;
+		unsigned range_end_slot;
+		previous_run(last.at, last.slot, range_end_block, range_end_slot);
+		block * before;
+		unsigned before_slot;
+		previous_run(first.at, first.slot, before, before_slot);
+
+		connect(before, before_slot, last.at, last.slot);
+
+		block * after;
+		unsigned after_slot;
+		previous_run(position.at, position.slot, after, after_slot);
+		connect(after, after_slot, first.at, first.slot);
+		connect(range_end_block, range_end_slot, position.at, position.slot);
+
+		join(before, before_slot);
+		join(after, after_slot);
+		join(range_end_block, range_end_slot);
+	}
+
+	void splice(const_iterator position, unrolled_list & other, const_iterator element) {
+		const_iterator next = element;
+		splice(position, other, element, ++next);
+	}
+
+	// Move every element of 'other' before 'position'
+	// O(1): the blocks change owner and iterators into 'other' now refer to this list
+	void splice(const_iterator position, unrolled_list & other) {
+		if (&other == this || other.empty())
+			return;
+
+		split_before(position.at, position.slot);
+		block * after;
+		unsigned after_slot;
+		previous_run(position.at, position.slot, after, after_slot);
+		connect(after, after_slot, other.first_block, other.first_slot);
+		connect(other.last_block, other.last_slot, position.at, position.slot);
+
+		other.oldest->older = newest;
+		if (newest)
+			newest->newer = other.oldest;
+		else
+			oldest = other.oldest;
+		newest = other.newest;
+		if (!spare)
+			spare = other.spare;
+		count += other.count;
+		other.reset();
+	}
+
+	// Elements of another list are moved one by one: O(size of the range), and
+	// their iterators are not carried over
+	void splice(const_iterator position, unrolled_list && other, const_iterator first, const_iterator last) {
+		splice(position, other, first, last);
+	}
+	void splice(const_iterator position, unrolled_list && other, const_iterator element) { splice(position, other, element); }
+	void splice(const_iterator position, unrolled_list && other) { splice(position, other); }
+
+private:
+
+	void reset() {
+		first_block = last_block = nullptr;
+		first_slot = last_slot = 0;
+		newest = oldest = spare = nullptr;
+		count = 0;
+	}
+
+	block * allocate() {
+		void * allocation = ::operator new(sizeof(block) + unrolled_list_detail::block_alignment - 1);
+		block * fresh = ::new (reinterpret_cast<void *>((reinterpret_cast<std::uintptr_t>(allocation) + unrolled_list_detail::block_alignment - 1)
+			& ~std::uintptr_t(unrolled_list_detail::block_alignment - 1))) block;
+		fresh->allocation = allocation;
+		for (unsigned slot = 0; slot < unrolled_list_detail::block_slots; ++slot)
+			fresh->slots[slot].next = 0;
+		fresh->live = fresh->starts = fresh->ends = 0;
+		fresh->older = newest;
+		fresh->newer = nullptr;
+		if (newest)
+			newest->newer = fresh;
+		else
+			oldest = fresh;
+		newest = fresh;
+		return fresh;
+	}
+
+	void deallocate(block * empty) {
+		(empty->older ? empty->older->newer : oldest) = empty->newer;
+		(empty->newer ? empty->newer->older : newest) = empty->older;
+		::operator delete(empty->allocation);
+	}
+
+	// The run ending at (at, slot) is followed by the run starting at (next, next_slot)
+	// A null block on either side is the start or the end of the list
+	void connect(block * at, unsigned slot, block * next, unsigned next_slot) {
+		if (at)
+			at->slots[slot].next = block::link(next, next_slot);
+		else {
+			first_block = next;
+			first_slot = next_slot;
+		}
+		if (next)
+			next->prev[next_slot] = block::link(at, slot);
+		else {
+			last_block = at;
+			last_slot = slot;
+		}
+	}
+
+	// The first slot of the run after the one ending at (at, slot)
+	static void next_run(block * at, unsigned slot, block *& next, unsigned & next_slot) {
+		next = block::link_block(at->slots[slot].next);
+		next_slot = block::link_slot(at->slots[slot].next);
+	}
+
+	// The last slot of the run before the one starting at (at, slot); at == null: end()
+	void previous_run(block * at, unsigned slot, block *& previous, unsigned & previous_slot) const {
+		if (at) {
+			previous = block::link_block(at->prev[slot]);
+			previous_slot = block::link_slot(at->prev[slot]);
+		}
+		else {
+			previous = last_block;
+			previous_slot = last_slot;
+		}
+	}
+
+	// Make the element at (at, slot) the first of its run
+	void split_before(block * at, unsigned slot) {
+		using namespace unrolled_list_detail;
+		if (!at || (at->starts & bit(slot)))
+			return;
+		at->starts |= bit(slot);
+		at->ends |= bit(slot - 1);
+		connect(at, slot - 1, at, slot);
+	}
+
+	// Merge the run ending at (at, slot) with the next one when that starts in the next slot
+	void join(block * at, unsigned slot) {
+		using namespace unrolled_list_detail;
+		if (!at || slot + 1 == block_slots || at->slots[slot].next != block::link(at, slot + 1))
+			return;
+		at->ends &= ~bit(slot);
+		at->starts &= ~bit(slot + 1);
+		at->slots[slot].next = 0;
+	}
+
+	// Claim the slot for a new element before (at, slot), at == null: end(), and link it in
+	block * reserve_before(block * at, unsigned slot, unsigned & reserved) {
+		using namespace unrolled_list_detail;
+		split_before(at, slot);
+
+		block * previous;
+		unsigned previous_slot;
+		previous_run(at, slot, previous, previous_slot);
+
+		// The free slot after the previous run, such as the one of an erased element
+		if (previous && previous_slot + 1 < block_slots && !(previous->live & bit(previous_slot + 1))) {
+			reserved = previous_slot + 1;
+			previous->live |= bit(reserved);
+			previous->ends = (previous->ends & ~bit(previous_slot)) | bit(reserved);
+			previous->slots[previous_slot].next = 0;
+			connect(previous, reserved, at, slot);
+			join(previous, reserved);
+			return previous;
+		}
+
+		// The free slot before the run of the element
+		if (at && slot > 0 && !(at->live & bit(slot - 1))) {
+			reserved = slot - 1;
+			at->live |= bit(reserved);
+			at->starts = (at->starts & ~bit(slot)) | bit(reserved);
+			connect(previous, previous_slot, at, reserved);
+			return at;
+		}
+
+		// A run of its own, near its neighbours if they have room
+		block * home = (at && ~at->live) ? at
+			     : (previous && ~previous->live) ? previous
+			     : (spare && ~spare->live) ? spare
+			     : (spare = allocate());
+		// At the front, the highest slot, leaving room for more push_front
+		reserved = (!previous && at) ? bit_ops::highest_bit(~home->live) : bit_ops::lowest_bit(~home->live);
+		const std::uint64_t mask = bit(reserved);
+		home->live |= mask;
+		home->starts |= mask;
+		home->ends |= mask;
+		connect(previous, previous_slot, home, reserved);
+		connect(home, reserved, at, slot);
+		join(previous, previous_slot);
+		join(home, reserved);
+		return home;
+	}
+
+	// Unlink the slot of an element, destroyed or never constructed
+	void release(block * at, unsigned slot) {
+		using namespace unrolled_list_detail;
+		const bool first = (at->starts & bit(slot)) != 0, last = (at->ends & bit(slot)) != 0;
+		at->live &= ~bit(slot);
+
+		block * previous, * next;
+		unsigned previous_slot, next_slot;
+		if (first && last) {
+			previous_run(at, slot, previous, previous_slot);
+			next_run(at, slot, next, next_slot);
+			at->slots[slot].next = 0;
+			at->starts &= ~bit(slot);
+			at->ends &= ~bit(slot);
+			connect(previous, previous_slot, next, next_slot);
+			join(previous, previous_slot);
+		}
+		else if (first) {
+			previous_run(at, slot, previous, previous_slot);
+			at->starts = (at->starts & ~bit(slot)) | bit(slot + 1);
+			connect(previous, previous_slot, at, slot + 1);
+		}
+		else if (last) {
+			next_run(at, slot, next, next_slot);
+			at->slots[slot].next = 0;
+			at->ends = (at->ends & ~bit(slot)) | bit(slot - 1);
+			connect(at, slot - 1, next, next_slot);
+		}
+		else {
+			// Runs have no holes: split around the free slot
+			at->ends |= bit(slot - 1);
+			at->starts |= bit(slot + 1);
+			connect(at, slot - 1, at, slot + 1);
+		}
+
+		// Keep one block with free slots at hand; free the other empty ones
+		if (at == spare)
+			return;
+		if (!spare || !~spare->live)
+			spare = at;
+		else if (!at->live)
+			deallocate(at);
+	}
+
+	block * first_block, * last_block;
+	unsigned first_slot, last_slot;
+	block * newest, * oldest;	// every block, linked through older / newer
+	block * spare;			// a block with free slots for new runs, if any
+	size_type count;
+};
+
+
+template <class T>
+void swap(unrolled_list<T> & a, unrolled_list<T> & b) { a.swap(b); }
+
+template <class T>
+bool operator==(const unrolled_list<T> & a, const unrolled_list<T> & b) {
+	if (a.size() != b.size())
+		return false;
+	for (auto i = a.begin(), j = b.begin(); i != a.end(); ++i, ++j)
+		if (!(*i == *j))
+			return false;
+	return true;
+}
+
+template <class T>
+bool operator!=(const unrolled_list<T> & a, const unrolled_list<T> & b) { return !(a == b); }